@@ -0,0 +1,209 @@
+/** prototls - Portable asynchronous client/server communications C++ library
+
+     See LICENSE for copyright information.
+*/
+#ifndef _prototls_bench_hpp_
+#define _prototls_bench_hpp_
+#include "prototls/Common.hpp"
+#include "prototls/Socket.hpp"
+#include <boost/function.hpp>
+#include <sys/resource.h>
+#include <sys/wait.h>
+#include <unistd.h>
+#include <algorithm>
+#include <cstdio>
+#include <cstdlib>
+#include <string>
+#include <vector>
+namespace prototls {
+    /** Latency samples of a benchmark run. All samples are kept, so
+        the percentiles are exact. */
+    class Latencies {
+        /** samples in microseconds */
+        std::vector<uint64_t> samples;
+
+        /** true if the samples are sorted */
+        bool sorted;
+    public:
+        /** initializes an empty set of samples */
+        Latencies() : sorted(true) {
+        }
+
+        /** adds a sample
+         \param usecs the latency in microseconds */
+        void add(uint64_t usecs) {
+            samples.push_back(usecs);
+            sorted = false;
+        }
+
+        /** adds the samples of another set */
+        void merge(const Latencies& other) {
+            samples.insert(samples.end(), other.samples.begin(),
+                    other.samples.end());
+            sorted = samples.empty();
+        }
+
+        /** removes all samples */
+        void clear() {
+            samples.clear();
+            sorted = true;
+        }
+
+        /** \return the number of samples */
+        size_t size() const {
+            return samples.size();
+        }
+
+        /** \return the latency that 'fraction' of the samples do not
+          exceed, e.g. 0.99 for the 99th percentile, or 0 if there
+          are no samples */
+        uint64_t percentile(double fraction) {
+            if (samples.empty())
+                return 0;
+            if (!sorted) {
+                std::sort(samples.begin(), samples.end());
+                sorted = true;
+            }
+            size_t rank = (size_t) (fraction * samples.size());
+            return samples[std::min(rank, samples.size() - 1)];
+        }
+    };
+
+    /** \return a command line argument as a number, or 'def' if it is
+      not given */
+    inline long argument(int argc, char** argv, int i, long def) {
+        return argc > i ? atol(argv[i]) : def;
+    }
+
+    /** \return a human readable byte count, e.g. "64K" */
+    inline std::string formatSize(size_t bytes) {
+        if (bytes >= 1024 * 1024 && bytes % (1024 * 1024) == 0)
+            return toString(bytes / (1024 * 1024)) + "M";
+        if (bytes >= 1024 && bytes % 1024 == 0)
+            return toString(bytes / 1024) + "K";
+        return toString(bytes);
+    }
+
+    /** \return a comma separated command line argument as a list, or
+      'def' if it is not given */
+    inline std::vector<std::string> listArgument(int argc, char** argv,
+            int i, const std::string& def) {
+        std::string s = argc > i ? argv[i] : def;
+        std::vector<std::string> list;
+        size_t pos = 0;
+        while (pos <= s.size()) {
+            size_t end = std::min(s.find(',', pos), s.size());
+            if (end > pos)
+                list.push_back(s.substr(pos, end - pos));
+            pos = end + 1;
+        }
+        return list;
+    }
+
+    /** \return the resident set size of this process in bytes */
+    inline size_t residentBytes() {
+        unsigned long pages = 0, resident = 0;
+        FILE* f = fopen("/proc/self/statm", "r");
+        if (f) {
+            if (fscanf(f, "%lu %lu", &pages, &resident) != 2)
+                resident = 0;
+            fclose(f);
+        }
+        return resident * sysconf(_SC_PAGESIZE);
+    }
+
+    /** \return the CPU time used by this process in microseconds */
+    inline uint64_t cpuMicros() {
+        struct rusage ru;
+        getrusage(RUSAGE_SELF, &ru);
+        return (uint64_t) (ru.ru_utime.tv_sec + ru.ru_stime.tv_sec) * 1000000
+            + ru.ru_utime.tv_usec + ru.ru_stime.tv_usec;
+    }
+
+    /** A server run in a child process, so that its memory and CPU
+        time are measured apart from the clients. The child answers
+        one-character commands with a line of numbers (see
+        answerCommands). */
+    class ServerProcess {
+        /** the child process */
+        pid_t pid;
+
+        /** pipe the commands are written to */
+        int commands;
+
+        /** pipe the answers are read from */
+        FILE* results;
+
+        /** declared but not defined to prevent copying */
+        ServerProcess(const ServerProcess& s);
+
+        /** declared but not defined to prevent copying */
+        ServerProcess& operator=(const ServerProcess& s);
+    public:
+        /** the function run in the child process, given the pipes to
+          read the commands from and to write the answers to */
+        typedef boost::function2<void, int, int> Body;
+
+        /** forks the child process that runs 'body' and exits */
+        ServerProcess(const Body& body) {
+            int cmd[2], res[2];
+            if (pipe(cmd) || pipe(res))
+                throw SocketExcept("pipe failed");
+            // or the child prints what is buffered again
+            fflush(stdout);
+            pid = fork();
+            if (pid == 0) {
+                ::close(cmd[1]);
+                ::close(res[0]);
+                body(cmd[0], res[1]);
+                exit(0);
+            }
+            ::close(cmd[0]);
+            ::close(res[1]);
+            commands = cmd[1];
+            results = fdopen(res[0], "r");
+        }
+
+        /** tells the child process to quit and waits for it */
+        ~ServerProcess() {
+            ask('q');
+            ::close(commands);
+            fclose(results);
+            waitpid(pid, NULL, 0);
+        }
+
+        /** sends a command to the child process
+         \return the numbers of the answer, empty if the child has
+         quit */
+        std::vector<uint64_t> ask(char c) {
+            std::vector<uint64_t> answer;
+            if (write(commands, &c, 1) != 1 || c == 'q')
+                return answer;
+            char line[256];
+            if (!fgets(line, sizeof(line), results))
+                return answer;
+            char* p = line;
+            char* end;
+            for (uint64_t v = strtoull(p, &end, 10); end != p;
+                    v = strtoull(p, &end, 10)) {
+                answer.push_back(v);
+                p = end;
+            }
+            return answer;
+        }
+    };
+
+    /** answers the commands of ServerProcess::ask in the child process
+      until the command 'q'
+     \param answer returns the answer to a command */
+    inline void answerCommands(int commands, int results,
+            const boost::function1<std::string, char>& answer) {
+        char c;
+        while (read(commands, &c, 1) == 1 && c != 'q') {
+            std::string line = answer(c) + "\n";
+            if (write(results, line.c_str(), line.size()) < 0)
+                break;
+        }
+    }
+}
+#endif
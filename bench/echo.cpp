@@ -0,0 +1,152 @@
+/** prototls - Portable asynchronous client/server communications C++ library
+
+     See LICENSE for copyright information.
+*/
+
+/* Loopback echo benchmark. A Server echoes the messages of N clients,
+   each of which sends its next message when the previous one has come
+   back. Reports round trips per second, echoed payload MB/s and round
+   trip latency percentiles for Socket and TLSSocket over message sizes
+   from 16 bytes to 1 MB.
+
+   Usage: bench_echo [seconds per run] [clients] [certificate directory]
+*/
+#include "prototls.hpp"
+#include "../example/my_protocol.pb.h"
+#include "Bench.hpp"
+#include <boost/thread.hpp>
+#include <boost/bind.hpp>
+
+using namespace prototls;
+
+class EchoServer : public Server<Peer> {
+        my_protocol::ClientMessage request;
+        my_protocol::ServerMessage reply;
+    public:
+        EchoServer() : Server<Peer>(4) {}
+
+        void onPacket(Peer& p) {
+            p.recv(request);
+            reply.mutable_hello()->mutable_greeting()->swap(
+                    *request.mutable_hello()->mutable_greeting());
+            p.send(reply);
+            p.flush();
+        }
+        void onJoin(Peer&) {
+        }
+        void onLeave(Peer&) {
+        }
+};
+
+class EchoPeer : public Peer {
+    public:
+        /** the time the outstanding message was sent */
+        uint64_t sentAt;
+
+        /** true after the first round trip */
+        bool warm;
+
+        EchoPeer() : sentAt(0), warm(false) {}
+};
+
+class EchoClient : public Client<EchoPeer> {
+        my_protocol::ClientMessage request;
+        my_protocol::ServerMessage reply;
+    public:
+        size_t connected;
+        size_t warm;
+        bool measuring;
+        uint64_t messages;
+        Latencies latencies;
+
+        EchoClient(bool tls, size_t size) : Client<EchoPeer>(tls, 10, 1000),
+            connected(0), warm(0), measuring(false), messages(0) {
+            request.mutable_hello()->set_greeting(std::string(size, 'x'));
+        }
+
+        bool onVerify(EchoPeer&, const TLSSocket::VerifyResult&) {
+            return true;
+        }
+        void sendRequest(EchoPeer& p) {
+            p.sentAt = monotonicMicros();
+            p.send(request);
+            p.flush();
+        }
+        void onPacket(EchoPeer& p) {
+            p.recv(reply);
+            if (!p.warm) {
+                p.warm = true;
+                warm++;
+            }
+            if (measuring) {
+                latencies.add(monotonicMicros() - p.sentAt);
+                messages++;
+            }
+            sendRequest(p);
+        }
+        void onJoin(EchoPeer& p) {
+            connected++;
+            sendRequest(p);
+        }
+        void onLeave(EchoPeer&) {
+            connected--;
+        }
+};
+
+void run(bool tls, size_t size, size_t clients, int seconds, int port) {
+    EchoServer server;
+    boost::thread serverThread(boost::bind(&EchoServer::serve, &server,
+                tls, port, 1024));
+
+    {
+        EchoClient client(tls, size);
+        for (size_t i = 0; i < clients; i++)
+            client.connect("127.0.0.1", port);
+        uint64_t deadline = monotonicMillis() + 10000;
+        // the server may join the connections later than the client
+        while (client.warm < clients && monotonicMillis() < deadline)
+            client.poll(10);
+
+        client.measuring = true;
+        uint64_t start = monotonicMicros();
+        uint64_t end = start + (uint64_t) seconds * 1000000;
+        while (monotonicMicros() < end)
+            client.poll(10);
+        double elapsed = (monotonicMicros() - start) / 1e6;
+
+        printf("%-9s %6s %7lu %12.0f %10.1f %9lu %9lu %9lu\n",
+                tls ? "TLSSocket" : "Socket", formatSize(size).c_str(),
+                (unsigned long) client.connected,
+                client.messages / elapsed,
+                client.messages * size / elapsed / 1e6,
+                (unsigned long) client.latencies.percentile(0.5),
+                (unsigned long) client.latencies.percentile(0.99),
+                (unsigned long) client.latencies.percentile(0.999));
+        fflush(stdout);
+    }
+    server.close();
+    serverThread.join();
+}
+
+int main(int argc, char** argv) {
+    GOOGLE_PROTOBUF_VERIFY_VERSION;
+    int seconds = argument(argc, argv, 1, 2);
+    size_t clients = argument(argc, argv, 2, 4);
+    std::string dir = argc > 3 ? argv[3] : "example";
+
+    Socket::init();
+    TLSSocket::init(dir + "/ca-cert.pem", "", dir + "/cert.pem",
+            dir + "/key.pem");
+
+    printf("%-9s %6s %7s %12s %10s %9s %9s %9s\n", "transport", "size",
+            "clients", "msgs/s", "MB/s", "p50 us", "p99 us", "p999 us");
+    size_t sizes[] = { 16, 256, 4096, 65536, 1024 * 1024 };
+    int port = 23450;
+    for (int tls = 0; tls < 2; tls++) {
+        for (size_t i = 0; i < sizeof(sizes) / sizeof(sizes[0]); i++)
+            run(tls, sizes[i], clients, seconds, port++);
+    }
+    TLSSocket::deinit();
+    Socket::deinit();
+    return 0;
+}
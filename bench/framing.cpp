@@ -0,0 +1,218 @@
+/** prototls - Portable asynchronous client/server communications C++ library
+
+     See LICENSE for copyright information.
+*/
+
+/* Peer framing microbenchmarks on an in-memory transport, apart from
+   kernel and TLS costs. For tiny, medium and large messages it reports
+   time and heap allocations per message, once the buffers have grown
+   (and in the first pass, when they grow), of
+
+   - send:  Peer::send and Peer::flush
+   - input: Peer::onInput and the framing of Peer::recv without parsing,
+            with the stream arriving at once, in 1448-byte segments (a
+            TCP segment) or in 7-byte pieces
+   - recv:  the same with parsing into a protobuf message
+
+   Usage: bench_framing [milliseconds per case]
+*/
+#include "prototls.hpp"
+#include "../example/my_protocol.pb.h"
+#include "Bench.hpp"
+#include <cerrno>
+#include <cstring>
+#include <new>
+
+using namespace prototls;
+
+/** heap allocations since the start */
+static uint64_t allocations = 0;
+
+/** heap bytes allocated since the start */
+static uint64_t allocatedBytes = 0;
+
+void* operator new(size_t size) {
+    allocations++;
+    allocatedBytes += size;
+    void* p = malloc(size ? size : 1);
+    if (!p)
+        throw std::bad_alloc();
+    return p;
+}
+
+void operator delete(void* p) throw() {
+    free(p);
+}
+
+void operator delete(void* p, size_t) throw() {
+    free(p);
+}
+
+/** socket that sends into nothing and receives from a buffer in
+  pieces of at most 'piece' bytes */
+class FeedSocket : public Socket {
+        /** the data to receive */
+        const std::string* input;
+
+        /** the position of the next byte to receive */
+        size_t pos;
+
+        /** the maximum number of bytes received at once */
+        size_t piece;
+    public:
+        FeedSocket() : input(NULL), pos(0), piece(0) {}
+
+        /** starts receiving 'data' in pieces of at most 'piece' bytes */
+        void feed(const std::string& data, size_t piece) {
+            input = &data;
+            pos = 0;
+            this->piece = piece;
+        }
+
+        /** \return true if all data has been received */
+        bool drained() const {
+            return !input || pos == input->size();
+        }
+
+        ssize_t send(const void*, size_t len) {
+            return len;
+        }
+        ssize_t recv(void* buf, size_t len) {
+            size_t n = std::min(std::min(len, piece), input->size() - pos);
+            if (!n) {
+                errno = EAGAIN;
+                return -1;
+            }
+            memcpy(buf, input->data() + pos, n);
+            pos += n;
+            return n;
+        }
+};
+
+/** a message type that skips parsing, so that Peer::recv only frames */
+struct SkippedMessage {
+    bool ParseFromArray(const void*, int) {
+        return true;
+    }
+};
+
+/** measures a case until 'msecs' have passed */
+class Measure {
+        const char* op;
+        size_t size;
+        const char* pattern;
+        double firstAllocs;
+        uint64_t start, allocs, bytes, msgs;
+    public:
+        /** \param firstAllocs allocations per message in the first
+          pass */
+        Measure(const char* op, size_t size, const char* pattern,
+                double firstAllocs) :
+            op(op), size(size), pattern(pattern), firstAllocs(firstAllocs),
+            start(monotonicMicros()), allocs(allocations),
+            bytes(allocatedBytes), msgs(0) {}
+
+        /** counts handled messages
+         \return true while the case should go on */
+        bool done(uint64_t n, int msecs) {
+            msgs += n;
+            return monotonicMicros() - start >= (uint64_t) msecs * 1000;
+        }
+
+        ~Measure() {
+            double elapsed = monotonicMicros() - start;
+            printf("%-6s %6s %-8s %12.1f %10.2f %10.2f %12.1f\n", op,
+                    formatSize(size).c_str(), pattern,
+                    elapsed * 1000 / msgs, firstAllocs,
+                    (double) (allocations - allocs) / msgs,
+                    (double) (allocatedBytes - bytes) / msgs);
+            fflush(stdout);
+        }
+};
+
+void benchSend(size_t size, int msecs) {
+    my_protocol::ClientMessage m;
+    m.mutable_hello()->set_greeting(std::string(size, 'x'));
+    Peer p;
+    p.setup(new FeedSocket());
+    // the first message sizes the buffer
+    uint64_t first = allocations;
+    p.send(m);
+    p.flush();
+    Measure measure("send", size, "-", allocations - first);
+    do {
+        for (int i = 0; i < 100; i++) {
+            p.send(m);
+            p.flush();
+        }
+    } while (!measure.done(100, msecs));
+}
+
+/** feeds a stream of framed messages to a peer and takes them out
+  until 'msecs' have passed */
+template <class T>
+void benchInput(const char* op, size_t size, const char* pattern,
+        size_t piece, int msecs) {
+    my_protocol::ClientMessage m;
+    m.mutable_hello()->set_greeting(std::string(size, 'x'));
+    // about 256 KB, at least a few messages
+    size_t count = std::max<size_t>(4, 256 * 1024 / (size + 8));
+    std::string stream;
+    for (size_t i = 0; i < count; i++) {
+        size_t pos = stream.size();
+        stream += "SIZE";
+        m.AppendToString(&stream);
+        *((uint32_t*) (stream.data() + pos)) = htonl(stream.size() - pos - 4);
+    }
+
+    FeedSocket* s = new FeedSocket();
+    Peer p;
+    p.setup(s);
+    T message;
+    // the first pass sizes the buffers
+    uint64_t first = allocations;
+    for (int warm = 1; warm >= 0; warm--) {
+        Measure* measure = warm ? NULL : new Measure(op, size, pattern,
+                (double) (allocations - first) / count);
+        do {
+            s->feed(stream, piece);
+            uint64_t received = 0;
+            while (!s->drained()) {
+                p.onInput();
+                while (p.hasPacket()) {
+                    p.recv(message);
+                    received++;
+                }
+            }
+            if (received != count) {
+                fprintf(stderr, "received %lu of %lu messages\n",
+                        (unsigned long) received, (unsigned long) count);
+                exit(1);
+            }
+            if (warm)
+                break;
+        } while (!measure->done(count, msecs));
+        delete measure;
+    }
+}
+
+int main(int argc, char** argv) {
+    GOOGLE_PROTOBUF_VERIFY_VERSION;
+    int msecs = argument(argc, argv, 1, 300);
+
+    printf("%-6s %6s %-8s %12s %10s %10s %12s\n", "op", "size", "arrival",
+            "ns/msg", "first", "allocs/msg", "bytes/msg");
+    size_t sizes[] = { 16, 1024, 65536 };
+    for (size_t i = 0; i < sizeof(sizes) / sizeof(sizes[0]); i++) {
+        size_t size = sizes[i];
+        benchSend(size, msecs);
+        benchInput<SkippedMessage>("input", size, "at once", 1 << 30, msecs);
+        benchInput<SkippedMessage>("input", size, "1448 B", 1448, msecs);
+        benchInput<SkippedMessage>("input", size, "7 B", 7, msecs);
+        benchInput<my_protocol::ClientMessage>("recv", size, "at once",
+                1 << 30, msecs);
+        benchInput<my_protocol::ClientMessage>("recv", size, "1448 B",
+                1448, msecs);
+    }
+    return 0;
+}
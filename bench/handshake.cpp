@@ -0,0 +1,304 @@
+/** prototls - Portable asynchronous client/server communications C++ library
+
+     See LICENSE for copyright information.
+*/
+
+/* TLS handshake benchmark. A Server runs in a child process while
+   client threads connect to it over loopback as fast as they can, each
+   connection ending when the greeting the server sends on join has
+   arrived. Runs every combination of the server key types and
+   handshake pool sizes, with full handshakes and with resumed ones
+   (session tickets), and reports handshakes per second, server CPU
+   time per handshake, client latency from connect to greeting, and how
+   long handshakes waited for and took in the server's pool.
+
+   A self-signed certificate is generated for each key type: rsa2048,
+   rsa3072, ecdsa256, ecdsa384 or ed25519.
+
+   Usage: bench_handshake [seconds per run] [client threads]
+            [pool sizes, e.g. 1,4] [key types, e.g. rsa2048,ecdsa256]
+            [GnuTLS priority string]
+*/
+#include "prototls.hpp"
+#include "../example/my_protocol.pb.h"
+#include "Bench.hpp"
+#include <boost/thread.hpp>
+#include <boost/bind.hpp>
+#include <gnutls/x509.h>
+
+using namespace prototls;
+
+/** greets every peer that joins */
+class HandshakeServer : public Server<Peer> {
+        my_protocol::ServerMessage greeting;
+    public:
+        /** the number of peers that have joined */
+        volatile uint64_t joined;
+
+        HandshakeServer(int threads) : Server<Peer>(threads), joined(0) {
+            greeting.mutable_hello()->set_greeting("Welcome!");
+        }
+
+        void onPacket(Peer&) {
+        }
+        void onJoin(Peer& p) {
+            joined++;
+            p.send(greeting);
+            p.flush();
+        }
+        void onLeave(Peer&) {
+        }
+};
+
+/** answers a command of the benchmark:
+  'm' restarts the handshake statistics, "cpu-usecs joined-peers"
+  's' "cpu-usecs joined-peers handshakes wait-p99 run-p50 run-p99" */
+std::string answer(HandshakeServer& server, char c) {
+    std::string line = toString(cpuMicros()) + " " + toString(server.joined);
+    if (c == 'm') {
+        server.resetHandshakeStats();
+    } else if (c == 's') {
+        boost::threadpool::pool_stats stats = server.getHandshakeStats();
+        line += " " + toString(stats.executed)
+            + " " + toString(stats.queue_wait.percentile(0.99))
+            + " " + toString(stats.execution.percentile(0.5))
+            + " " + toString(stats.execution.percentile(0.99));
+    }
+    return line;
+}
+
+/** runs the server until told to quit */
+void serveChild(int threads, int port, int commands, int results) {
+    HandshakeServer server(threads);
+    boost::thread serverThread(boost::bind(&HandshakeServer::serve,
+                &server, true, port, 1024));
+    answerCommands(commands, results,
+            boost::bind(&answer, boost::ref(server), _1));
+    server.close();
+    serverThread.join();
+}
+
+/** results of the client threads */
+struct Results {
+    boost::mutex monitor;
+
+    /** latencies from connect to greeting */
+    Latencies latencies;
+
+    /** the number of resumed handshakes */
+    uint64_t resumed;
+
+    /** the number of failed connections */
+    uint64_t failed;
+
+    Results() : resumed(0), failed(0) {}
+};
+
+/** connects until 'end', recording the connections started after
+  'start'. With 'resume', resumes the session of the previous one. */
+void connectLoop(int port, bool resume, uint64_t start, uint64_t end,
+        Results& results) {
+    my_protocol::ServerMessage greeting;
+    Latencies latencies;
+    uint64_t resumed = 0, failed = 0;
+    std::string session;
+    for (uint64_t begin = monotonicMicros(); begin < end;
+            begin = monotonicMicros()) {
+        Peer p;
+        TLSSocket* s = new TLSSocket();
+        p.setup(s);
+        try {
+            s->connect("127.0.0.1", port);
+            s->setNoDelay();
+        } catch (SocketExcept& e) {
+            failed++;
+            continue;
+        }
+        if (resume && !session.empty())
+            s->setSessionData(session);
+        if (s->handshake() < 0) {
+            failed++;
+            continue;
+        }
+        while (p.isActive() && !p.hasPacket())
+            p.onInput();
+        if (!p.hasPacket()) {
+            failed++;
+            continue;
+        }
+        p.recv(greeting);
+        uint64_t done = monotonicMicros();
+        // with TLS 1.3 the ticket has arrived with the greeting
+        if (resume)
+            session = s->getSessionData();
+        if (begin < start)
+            continue;
+        latencies.add(done - begin);
+        if (s->isResumed())
+            resumed++;
+    }
+    boost::mutex::scoped_lock lock(results.monitor);
+    results.latencies.merge(latencies);
+    results.resumed += resumed;
+    results.failed += failed;
+}
+
+/** writes a self-signed certificate and its private key
+ \return false if the key type is not known */
+bool generateCertificate(const std::string& type,
+        const std::string& certPath, const std::string& keyPath) {
+    gnutls_pk_algorithm_t algorithm;
+    unsigned int bits;
+    gnutls_digest_algorithm_t digest = GNUTLS_DIG_SHA256;
+    if (type == "rsa2048" || type == "rsa3072") {
+        algorithm = GNUTLS_PK_RSA;
+        bits = type == "rsa2048" ? 2048 : 3072;
+    } else if (type == "ecdsa256") {
+        algorithm = GNUTLS_PK_ECDSA;
+        bits = GNUTLS_CURVE_TO_BITS(GNUTLS_ECC_CURVE_SECP256R1);
+    } else if (type == "ecdsa384") {
+        algorithm = GNUTLS_PK_ECDSA;
+        bits = GNUTLS_CURVE_TO_BITS(GNUTLS_ECC_CURVE_SECP384R1);
+        digest = GNUTLS_DIG_SHA384;
+    } else if (type == "ed25519") {
+        algorithm = GNUTLS_PK_EDDSA_ED25519;
+        bits = GNUTLS_CURVE_TO_BITS(GNUTLS_ECC_CURVE_ED25519);
+        digest = GNUTLS_DIG_SHA512;
+    } else {
+        return false;
+    }
+
+    gnutls_x509_privkey_t key;
+    gnutls_x509_crt_t crt;
+    gnutls_x509_privkey_init(&key);
+    gnutls_x509_crt_init(&crt);
+    bool ok = !gnutls_x509_privkey_generate(key, algorithm, bits, 0);
+    if (ok) {
+        time_t now = time(NULL);
+        unsigned char serial = 1;
+        gnutls_x509_crt_set_version(crt, 3);
+        gnutls_x509_crt_set_serial(crt, &serial, sizeof(serial));
+        gnutls_x509_crt_set_activation_time(crt, now - 3600);
+        gnutls_x509_crt_set_expiration_time(crt, now + 24 * 3600);
+        gnutls_x509_crt_set_dn_by_oid(crt, GNUTLS_OID_X520_COMMON_NAME, 0,
+                "localhost", 9);
+        gnutls_x509_crt_set_key(crt, key);
+        gnutls_x509_crt_set_key_usage(crt, GNUTLS_KEY_DIGITAL_SIGNATURE
+                | (algorithm == GNUTLS_PK_RSA ? GNUTLS_KEY_KEY_ENCIPHERMENT : 0));
+        ok = !gnutls_x509_crt_sign2(crt, crt, key, digest, 0);
+    }
+    gnutls_datum_t pem;
+    if (ok && !gnutls_x509_crt_export2(crt, GNUTLS_X509_FMT_PEM, &pem)) {
+        FILE* f = fopen(certPath.c_str(), "w");
+        ok = f && fwrite(pem.data, 1, pem.size, f) == pem.size;
+        if (f)
+            fclose(f);
+        gnutls_free(pem.data);
+    }
+    if (ok && !gnutls_x509_privkey_export2_pkcs8(key, GNUTLS_X509_FMT_PEM,
+                NULL, GNUTLS_PKCS_PLAIN, &pem)) {
+        FILE* f = fopen(keyPath.c_str(), "w");
+        ok = f && fwrite(pem.data, 1, pem.size, f) == pem.size;
+        if (f)
+            fclose(f);
+        gnutls_free(pem.data);
+    }
+    gnutls_x509_crt_deinit(crt);
+    gnutls_x509_privkey_deinit(key);
+    return ok;
+}
+
+void run(const std::string& keyType, int threads, bool resume,
+        int clients, int seconds, int port) {
+    ServerProcess child(boost::bind(&serveChild, threads, port, _1, _2));
+
+    // the server process may not be listening yet
+    uint64_t deadline = monotonicMillis() + 5000;
+    while (monotonicMillis() < deadline) {
+        TLSSocket probe;
+        try {
+            probe.connect("127.0.0.1", port);
+            probe.handshake();
+            break;
+        } catch (SocketExcept& e) {
+            boost::this_thread::sleep(boost::posix_time::milliseconds(10));
+        }
+    }
+
+    Results results;
+    uint64_t start = monotonicMicros() + 500000;
+    uint64_t end = start + (uint64_t) seconds * 1000000;
+    boost::thread_group group;
+    for (int i = 0; i < clients; i++)
+        group.create_thread(boost::bind(&connectLoop, port, resume, start,
+                    end, boost::ref(results)));
+    boost::this_thread::sleep(boost::posix_time::microseconds(
+                start - monotonicMicros()));
+    std::vector<uint64_t> before = child.ask('m');
+    group.join_all();
+    std::vector<uint64_t> after = child.ask('s');
+    if (before.size() != 2 || after.size() != 6) {
+        fprintf(stderr, "server process failed\n");
+        return;
+    }
+
+    uint64_t handshakes = results.latencies.size();
+    uint64_t joined = after[1] - before[1];
+    printf("%-8s %4d %-7s %9.0f %7.0f %6.1f %9.2f %9.2f %9.2f %8.2f %8.2f %8.2f %6lu\n",
+            keyType.c_str(), threads, resume ? "resumed" : "full",
+            handshakes / (double) seconds,
+            joined ? (after[0] - before[0]) / (double) joined : 0.0,
+            handshakes ? results.resumed * 100.0 / handshakes : 0.0,
+            results.latencies.percentile(0.5) / 1e3,
+            results.latencies.percentile(0.99) / 1e3,
+            results.latencies.percentile(0.999) / 1e3,
+            after[3] / 1e3, after[4] / 1e3, after[5] / 1e3,
+            (unsigned long) results.failed);
+    fflush(stdout);
+}
+
+int main(int argc, char** argv) {
+    GOOGLE_PROTOBUF_VERIFY_VERSION;
+    int seconds = argument(argc, argv, 1, 2);
+    int clients = argument(argc, argv, 2, 8);
+    std::vector<std::string> pools = listArgument(argc, argv, 3, "1,4");
+    std::vector<std::string> keyTypes = listArgument(argc, argv, 4,
+            "rsa2048,ecdsa256,ed25519");
+    std::string priority = argc > 5 ? argv[5] : "NORMAL";
+
+    Socket::init();
+    printf("priority %s, %d client threads\n", priority.c_str(), clients);
+    printf("%-8s %4s %-7s %9s %7s %6s %9s %9s %9s %8s %8s %8s %6s\n",
+            "key", "pool", "mode", "hs/s", "cpu us", "res %",
+            "p50 ms", "p99 ms", "p999 ms", "wait p99", "run p50",
+            "run p99", "failed");
+    std::string certPath = "/tmp/bench_handshake_cert.pem";
+    std::string keyPath = "/tmp/bench_handshake_key.pem";
+    int port = 25450;
+    for (size_t i = 0; i < keyTypes.size(); i++) {
+        // generated between inits, since TLSSocket::deinit ends GnuTLS
+        gnutls_global_init();
+        bool generated = generateCertificate(keyTypes[i], certPath, keyPath);
+        gnutls_global_deinit();
+        if (!generated) {
+            fprintf(stderr, "unknown key type %s\n", keyTypes[i].c_str());
+            continue;
+        }
+        try {
+            TLSSocket::init("", "", certPath, keyPath, priority);
+        } catch (SocketExcept& e) {
+            fprintf(stderr, "%s\n", e.what());
+            return 1;
+        }
+        for (size_t j = 0; j < pools.size(); j++) {
+            for (int resume = 0; resume < 2; resume++)
+                run(keyTypes[i], atoi(pools[j].c_str()), resume, clients,
+                        seconds, port++);
+        }
+        TLSSocket::deinit();
+    }
+    unlink(certPath.c_str());
+    unlink(keyPath.c_str());
+    Socket::deinit();
+    return 0;
+}
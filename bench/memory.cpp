@@ -0,0 +1,177 @@
+/** prototls - Portable asynchronous client/server communications C++ library
+
+     See LICENSE for copyright information.
+*/
+
+/* In-memory echo benchmark. A Server echoes the messages of N peers
+   connected to it through MemorySocket pairs, so that framing, handler
+   dispatch and backpressure are measured without the network stack.
+   Each peer sends its next message when the previous one has come
+   back. For message sizes from 16 bytes to 64 KB it runs with
+
+   - whole:    recv returns everything that is due
+   - 1448 B:   recv returns at most a TCP segment
+   - 64 B:     recv returns at most 64 bytes
+   - +100 us:  sent data becomes readable after 100 microseconds
+   - 4K cap:   at most 4 KB buffered per direction, so large messages
+               are sent piecewise as the other end reads
+
+   and reports round trips per second, echoed payload MB/s and round
+   trip latency percentiles.
+
+   Usage: bench_memory [milliseconds per run] [peers]
+*/
+#include "prototls.hpp"
+#include "../example/my_protocol.pb.h"
+#include "Bench.hpp"
+#include <boost/thread.hpp>
+#include <boost/bind.hpp>
+
+using namespace prototls;
+
+class EchoServer : public Server<Peer, EPoll> {
+        my_protocol::ClientMessage request;
+        my_protocol::ServerMessage reply;
+    public:
+        EchoServer() : Server<Peer, EPoll>(1) {}
+
+        void onPacket(Peer& p) {
+            p.recv(request);
+            reply.mutable_hello()->mutable_greeting()->swap(
+                    *request.mutable_hello()->mutable_greeting());
+            p.send(reply);
+            p.flush();
+        }
+        void onJoin(Peer&) {
+        }
+        void onLeave(Peer&) {
+        }
+};
+
+class EchoPeer : public Peer {
+    public:
+        /** the time the outstanding message was sent */
+        uint64_t sentAt;
+
+        /** true after the first round trip */
+        bool warm;
+
+        EchoPeer() : sentAt(0), warm(false) {}
+};
+
+typedef std::vector< boost::shared_ptr<EchoPeer> > Peers;
+
+/** a transport configuration */
+struct Case {
+    const char* name;
+    size_t fragment;
+    int latency;
+    size_t capacity;
+};
+
+void sendRequest(EchoPeer& p, my_protocol::ClientMessage& request) {
+    p.sentAt = monotonicMicros();
+    p.send(request);
+    p.flush();
+}
+
+/** exchanges messages until 'end', or until every peer has had a round
+  trip if 'end' is 0
+ \return the number of round trips */
+uint64_t exchange(Peers& peers, my_protocol::ClientMessage& request,
+        uint64_t end, Latencies& latencies) {
+    my_protocol::ServerMessage reply;
+    size_t cold = 0;
+    for (size_t i = 0; i < peers.size(); i++)
+        cold += !peers[i]->warm;
+    uint64_t trips = 0;
+    Poll poll;
+    while (end ? monotonicMicros() < end : cold > 0) {
+        poll.reset();
+        for (size_t i = 0; i < peers.size(); i++) {
+            EchoPeer& p = *peers[i];
+            poll.input(p.getFd());
+            if (p.hasOutput())
+                poll.output(p.getOutputFd());
+        }
+        if (poll.select(10) <= 0)
+            continue;
+        for (size_t i = 0; i < peers.size(); i++) {
+            EchoPeer& p = *peers[i];
+            if (p.hasOutput() && poll.canWrite(p.getOutputFd()))
+                p.flush();
+            if (!poll.canRead(p.getFd()))
+                continue;
+            p.onInput();
+            while (p.hasPacket()) {
+                p.recv(reply);
+                if (end) {
+                    latencies.add(monotonicMicros() - p.sentAt);
+                    trips++;
+                } else if (!p.warm) {
+                    p.warm = true;
+                    cold--;
+                }
+                sendRequest(p, request);
+            }
+        }
+    }
+    return trips;
+}
+
+void run(const Case& c, size_t size, size_t count, int msecs) {
+    EchoServer server;
+    boost::thread serverThread(boost::bind(&EchoServer::serve, &server,
+                false, -1, count));
+    Peers peers(count);
+    my_protocol::ClientMessage request;
+    request.mutable_hello()->set_greeting(std::string(size, 'x'));
+    for (size_t i = 0; i < count; i++) {
+        MemorySocket* mine;
+        MemorySocket* theirs;
+        MemorySocket::createPair(mine, theirs, c.fragment, c.latency,
+                c.capacity);
+        peers[i].reset(new EchoPeer());
+        peers[i]->setup(mine);
+        server.addPeer(theirs);
+        sendRequest(*peers[i], request);
+    }
+
+    Latencies latencies;
+    exchange(peers, request, 0, latencies);
+    uint64_t start = monotonicMicros();
+    uint64_t trips = exchange(peers, request,
+            start + (uint64_t) msecs * 1000, latencies);
+    double elapsed = (monotonicMicros() - start) / 1e6;
+
+    printf("%-8s %6s %12.0f %10.1f %9lu %9lu\n", c.name,
+            formatSize(size).c_str(), trips / elapsed,
+            trips * size * 2 / elapsed / 1e6,
+            (unsigned long) latencies.percentile(0.5),
+            (unsigned long) latencies.percentile(0.99));
+    fflush(stdout);
+    server.close();
+    serverThread.join();
+}
+
+int main(int argc, char** argv) {
+    GOOGLE_PROTOBUF_VERIFY_VERSION;
+    int msecs = argument(argc, argv, 1, 500);
+    size_t count = argument(argc, argv, 2, 16);
+
+    printf("%lu peers\n", (unsigned long) count);
+    printf("%-8s %6s %12s %10s %9s %9s\n", "case", "size", "msgs/s",
+            "MB/s", "p50 us", "p99 us");
+    Case cases[] = {
+        { "whole", 0, 0, 1024 * 1024 },
+        { "1448 B", 1448, 0, 1024 * 1024 },
+        { "64 B", 64, 0, 1024 * 1024 },
+        { "+100 us", 0, 100, 1024 * 1024 },
+        { "4K cap", 0, 0, 4096 }
+    };
+    size_t sizes[] = { 16, 4096, 65536 };
+    for (size_t i = 0; i < sizeof(sizes) / sizeof(sizes[0]); i++)
+        for (size_t j = 0; j < sizeof(cases) / sizeof(cases[0]); j++)
+            run(cases[j], sizes[i], count, msecs);
+    return 0;
+}
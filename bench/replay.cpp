@@ -0,0 +1,212 @@
+/** prototls - Portable asynchronous client/server communications C++ library
+
+     See LICENSE for copyright information.
+*/
+
+/* Replays a capture file written by Server::setCapture against a
+   server, for load tests with the message mix of real traffic. Every
+   captured connection is replayed over a connection of its own (or
+   several, see copies) that sends the captured messages at their
+   original pace, a multiple of it, or as fast as the server takes
+   them. Reports the messages and bytes sent per second, how late the
+   paced messages were sent, and the latency of the replies, assuming
+   that the server answers the messages of a connection in order.
+
+   Usage: bench_replay <capture file> <address> <port> [speed] [copies]
+            [tls]
+
+     speed   1 for the original pace (the default), 2 for twice as
+             fast, 0 for as fast as possible
+     copies  the number of times each captured connection is replayed
+             at the same time (1)
+     tls     1 to connect with TLS (0)
+
+   The connections share one Client, so their total is limited to
+   FD_SETSIZE.
+*/
+#include "prototls.hpp"
+#include "Bench.hpp"
+#include <map>
+
+using namespace prototls;
+
+/** the messages of a captured connection */
+typedef std::vector<const CaptureRecord*> Script;
+
+/** a message type that skips parsing, so that replies of any type are
+  counted */
+struct AnyMessage {
+    bool ParseFromArray(const void*, int) {
+        return true;
+    }
+};
+
+class ReplayPeer : public Peer {
+    public:
+        /** the messages to send */
+        const Script* script;
+
+        /** the index of the next message to send */
+        size_t next;
+
+        /** the times the messages not answered yet were sent */
+        std::deque<uint64_t> sent;
+
+        /** true while connected */
+        bool joined;
+
+        ReplayPeer() : script(NULL), next(0), joined(false) {}
+};
+
+class ReplayClient : public Client<ReplayPeer> {
+    public:
+        size_t joined;
+        uint64_t replies;
+        uint64_t lastReply;
+        Latencies latencies;
+
+        ReplayClient(bool tls) : Client<ReplayPeer>(tls, 100, 1000),
+            joined(0), replies(0), lastReply(0) {}
+
+        bool onVerify(ReplayPeer&, const TLSSocket::VerifyResult&) {
+            return true;
+        }
+        void onPacket(ReplayPeer& p) {
+            AnyMessage reply;
+            p.recv(reply);
+            lastReply = monotonicMicros();
+            replies++;
+            if (!p.sent.empty()) {
+                latencies.add(lastReply - p.sent.front());
+                p.sent.pop_front();
+            }
+        }
+        void onJoin(ReplayPeer& p) {
+            p.joined = true;
+            joined++;
+        }
+        void onLeave(ReplayPeer& p) {
+            p.joined = false;
+            joined--;
+        }
+};
+
+int main(int argc, char** argv) {
+    if (argc < 4) {
+        fprintf(stderr, "usage: %s <capture file> <address> <port> "
+                "[speed] [copies] [tls]\n", argv[0]);
+        return 1;
+    }
+    double speed = argc > 4 ? atof(argv[4]) : 1;
+    int copies = argument(argc, argv, 5, 1);
+    bool tls = argument(argc, argv, 6, 0);
+
+    // the records are kept in place, the scripts point to them
+    std::deque<CaptureRecord> records;
+    std::map<uint32_t, Script> scripts;
+    try {
+        CaptureReader reader(argv[1]);
+        CaptureRecord r;
+        while (reader.next(r)) {
+            if (r.kind != CaptureRecord::Frame)
+                continue;
+            records.push_back(r);
+            scripts[r.connection].push_back(&records.back());
+        }
+    } catch (SocketExcept& e) {
+        fprintf(stderr, "%s: %s\n", argv[1], e.what());
+        return 1;
+    }
+
+    Socket::init();
+    if (tls)
+        TLSSocket::init("", "", "", "");
+    ReplayClient client(tls);
+    std::vector<ReplayPeer*> peers;
+    for (std::map<uint32_t, Script>::iterator i = scripts.begin();
+            i != scripts.end(); i++) {
+        for (int c = 0; c < copies; c++) {
+            ReplayPeer& p = client.connect(argv[2], atoi(argv[3]));
+            p.script = &i->second;
+            peers.push_back(&p);
+        }
+    }
+    uint64_t deadline = monotonicMillis() + 10000;
+    while (client.joined < peers.size() && monotonicMillis() < deadline)
+        client.poll(10);
+    printf("%lu messages of %lu connections, %lu of %lu replay "
+            "connections joined\n", (unsigned long) records.size(),
+            (unsigned long) scripts.size(), (unsigned long) client.joined,
+            (unsigned long) peers.size());
+
+    // the messages a connection sends at once at full speed
+    const size_t window = 64 * 1024;
+    Latencies lags;
+    uint64_t messages = 0, bytes = 0;
+    uint64_t start = monotonicMicros(), lastSend = start;
+    bool pending = true;
+    while (pending) {
+        uint64_t now = monotonicMicros();
+        uint64_t elapsed = now - start;
+        pending = false;
+        for (size_t i = 0; i < peers.size(); i++) {
+            ReplayPeer& p = *peers[i];
+            const Script& script = *p.script;
+            if (!p.joined)
+                continue;
+            while (p.next < script.size()) {
+                const CaptureRecord& r = *script[p.next];
+                if (speed > 0) {
+                    uint64_t due = (uint64_t) (r.time / speed);
+                    if (due > elapsed)
+                        break;
+                    lags.add(elapsed - due);
+                } else if (p.getOutputSize() >= window) {
+                    break;
+                }
+                p.sendFrame(r.data.data(), r.data.size());
+                p.sent.push_back(now);
+                p.next++;
+                messages++;
+                bytes += r.data.size();
+                lastSend = now;
+            }
+            if (p.hasOutput())
+                p.flush();
+            if (p.next < script.size() || p.hasOutput())
+                pending = true;
+        }
+        client.poll(speed > 0 ? 1 : 0);
+    }
+    // replies still on the way, until none has come for a second
+    uint64_t quiet = monotonicMicros();
+    while (monotonicMicros() - std::max(quiet, client.lastReply) < 1000000) {
+        bool waiting = false;
+        for (size_t i = 0; i < peers.size(); i++)
+            waiting = waiting || !peers[i]->sent.empty();
+        if (!waiting)
+            break;
+        client.poll(10);
+    }
+
+    // at full speed the messages are queued at once, so the run lasts
+    // until the last reply
+    double secs = (std::max(lastSend, client.lastReply) - start) / 1e6;
+    if (secs <= 0)
+        secs = 1e-6;
+    printf("%10s %10s %9s %10s %10s %10s %9s %9s %9s %9s\n", "messages",
+            "msgs/s", "MB/s", "lag p99", "replies", "replies/s", "p50 ms",
+            "p99 ms", "p999 ms", "max ms");
+    printf("%10lu %10.0f %9.2f %10.2f %10lu %10.0f %9.2f %9.2f %9.2f %9.2f\n",
+            (unsigned long) messages, messages / secs, bytes / secs / 1e6,
+            lags.percentile(0.99) / 1e3, (unsigned long) client.replies,
+            client.replies / secs,
+            client.latencies.percentile(0.5) / 1e3,
+            client.latencies.percentile(0.99) / 1e3,
+            client.latencies.percentile(0.999) / 1e3,
+            client.latencies.percentile(1) / 1e3);
+    if (tls)
+        TLSSocket::deinit();
+    Socket::deinit();
+    return 0;
+}
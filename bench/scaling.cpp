@@ -0,0 +1,353 @@
+/** prototls - Portable asynchronous client/server communications C++ library
+
+     See LICENSE for copyright information.
+*/
+
+/* Connection scaling benchmark. A Server runs in a child process with
+   each poller backend while this process opens up to tens of
+   thousands of connections to it. For a growing number of peers it
+   reports:
+
+   - the rate at which the connections are made and accepted
+   - server RSS per idle peer, and per peer that has exchanged a message
+   - server CPU time while all peers are idle
+   - reactor loop iteration time, i.e. the time between two waits for
+     the sockets, while a few peers exchange messages
+   - wakeup latency from a client sending a message to the server
+     handling it, and round trips per second
+
+   The file descriptor limit is raised as far as allowed; the peer
+   counts that do not fit are skipped. Select is limited to FD_SETSIZE.
+
+   Usage: bench_scaling [max peers] [seconds per phase] [active peers]
+*/
+#include "prototls.hpp"
+#include "../example/my_protocol.pb.h"
+#include "Bench.hpp"
+#include <boost/thread.hpp>
+#include <boost/bind.hpp>
+
+using namespace prototls;
+
+/** reactor loop iterations recorded in the server process */
+struct Loop {
+    static boost::mutex monitor;
+    static bool measuring;
+    static Latencies iterations;
+};
+boost::mutex Loop::monitor;
+bool Loop::measuring = false;
+Latencies Loop::iterations;
+
+/** poller that records the time the reactor spends between waits */
+template <class PollerT>
+class TimedPoller : public PollerT {
+    /** the time the last wait returned, or 0 */
+    uint64_t woken;
+public:
+    TimedPoller() : woken(0) {}
+
+    int select(int msecs) {
+        if (woken) {
+            uint64_t busy = monotonicMicros() - woken;
+            boost::mutex::scoped_lock lock(Loop::monitor);
+            if (Loop::measuring)
+                Loop::iterations.add(busy);
+        }
+        int ret = PollerT::select(msecs);
+        woken = monotonicMicros();
+        return ret;
+    }
+};
+
+/** echoes the greeting, the time it was sent, with the time it was
+  handled appended */
+template <class PollerT>
+class ScalingServer : public Server<Peer, TimedPoller<PollerT> > {
+        my_protocol::ClientMessage request;
+        my_protocol::ServerMessage reply;
+    public:
+        /** the number of peers that have joined */
+        volatile size_t joined;
+
+        ScalingServer() : Server<Peer, TimedPoller<PollerT> >(1),
+            joined(0) {}
+
+        void onPacket(Peer& p) {
+            uint64_t now = monotonicMicros();
+            p.recv(request);
+            std::string& greeting = *reply.mutable_hello()->mutable_greeting();
+            greeting = request.hello().greeting();
+            greeting += " " + toString(now);
+            p.send(reply);
+            p.flush();
+        }
+        void onJoin(Peer&) {
+            joined++;
+        }
+        void onLeave(Peer&) {
+            joined--;
+        }
+};
+
+/** answers a command of the benchmark:
+  's' "cpu-usecs rss-bytes joined-peers"
+  'm' starts recording loop iterations
+  'r' stops recording, "iterations p50-usecs p99-usecs" */
+template <class PollerT>
+std::string answer(ScalingServer<PollerT>& server, char c) {
+    boost::mutex::scoped_lock lock(Loop::monitor);
+    if (c == 's') {
+        return toString(cpuMicros()) + " " + toString(residentBytes())
+            + " " + toString(server.joined);
+    } else if (c == 'm') {
+        Loop::iterations.clear();
+        Loop::measuring = true;
+    } else if (c == 'r') {
+        Loop::measuring = false;
+        return toString(Loop::iterations.size()) + " "
+            + toString(Loop::iterations.percentile(0.5)) + " "
+            + toString(Loop::iterations.percentile(0.99));
+    }
+    return "";
+}
+
+/** runs the server until told to quit */
+template <class PollerT>
+void serveChild(int port, int maxPeers, int commands, int results) {
+    ScalingServer<PollerT> server;
+    boost::thread serverThread(boost::bind(&ScalingServer<PollerT>::serve,
+                &server, false, port, maxPeers));
+    answerCommands(commands, results,
+            boost::bind(&answer<PollerT>, boost::ref(server), _1));
+    server.close();
+    serverThread.join();
+}
+
+/** \return the server process of a run
+ \param poller "select", "poll" or "epoll" */
+ServerProcess::Body serverBody(const std::string& poller, int port,
+        int maxPeers) {
+    if (poller == "select")
+        return boost::bind(&serveChild<Select>, port, maxPeers, _1, _2);
+    if (poller == "poll")
+        return boost::bind(&serveChild<Poll>, port, maxPeers, _1, _2);
+    return boost::bind(&serveChild<EPoll>, port, maxPeers, _1, _2);
+}
+
+/** the client side of a connection */
+class ScalingPeer : public Peer {
+    public:
+        /** true while a message is waiting for the reply */
+        bool waiting;
+
+        ScalingPeer() : waiting(false) {}
+};
+
+typedef std::vector< boost::shared_ptr<ScalingPeer> > Peers;
+
+/** spreads the connections over loopback addresses, so that the
+  ephemeral ports of one address do not run out */
+std::string address(size_t i) {
+    return "127.0.0." + toString(1 + i / 20000);
+}
+
+/** connects a peer
+ \return false if the connection failed */
+bool connectPeer(ScalingPeer& p, size_t i, int port) {
+    Socket* s = new Socket();
+    try {
+        s->connect(address(i), port);
+    } catch (SocketExcept& e) {
+        delete s;
+        return false;
+    }
+    s->setNonBlocking();
+    s->setNoDelay();
+    p.setup(s);
+    return true;
+}
+
+/** sends a message stamped with the current time */
+void sendRequest(ScalingPeer& p, my_protocol::ClientMessage& request) {
+    uint64_t now = monotonicMicros();
+    request.mutable_hello()->set_greeting(toString(now));
+    p.send(request);
+    p.flush();
+    p.waiting = true;
+}
+
+/** exchanges messages with the first 'active' peers. Each sends its
+  next message when the previous one has come back, until 'usecs'
+  have passed or, if 'once', every peer has had one round trip.
+ \return the number of round trips */
+uint64_t exchange(Peers& peers, size_t active, uint64_t usecs, bool once,
+        Latencies& wakeups) {
+    my_protocol::ClientMessage request;
+    my_protocol::ServerMessage reply;
+    for (size_t i = 0; i < active; i++)
+        sendRequest(*peers[i], request);
+    size_t outstanding = active;
+    uint64_t trips = 0;
+    uint64_t end = monotonicMicros() + usecs;
+    Poll poll;
+    while (outstanding && monotonicMicros() < end) {
+        poll.reset();
+        for (size_t i = 0; i < active; i++) {
+            ScalingPeer& p = *peers[i];
+            if (!p.waiting)
+                continue;
+            poll.input(p.getFd());
+            if (p.hasOutput())
+                poll.output(p.getFd());
+        }
+        if (poll.select(10) <= 0)
+            continue;
+        for (size_t i = 0; i < active; i++) {
+            ScalingPeer& p = *peers[i];
+            if (p.hasOutput() && poll.canWrite(p.getFd()))
+                p.flush();
+            if (poll.canRead(p.getFd()))
+                p.onInput();
+            while (p.hasPacket()) {
+                p.recv(reply);
+                unsigned long long sent, handled;
+                if (sscanf(reply.hello().greeting().c_str(), "%llu %llu",
+                            &sent, &handled) == 2)
+                    wakeups.add(handled - sent);
+                trips++;
+                p.waiting = false;
+                if (once)
+                    outstanding--;
+                else
+                    sendRequest(p, request);
+            }
+        }
+    }
+    return trips;
+}
+
+/** raises the limit of open files as close to 'wanted' as allowed
+ \return the limit */
+size_t raiseFileLimit(size_t wanted) {
+    struct rlimit rl;
+    getrlimit(RLIMIT_NOFILE, &rl);
+    if (rl.rlim_cur >= wanted)
+        return rl.rlim_cur;
+    struct rlimit raised = rl;
+    raised.rlim_cur = raised.rlim_max = std::max<rlim_t>(wanted, rl.rlim_max);
+    if (setrlimit(RLIMIT_NOFILE, &raised)) {
+        raised = rl;
+        raised.rlim_cur = rl.rlim_max;
+        setrlimit(RLIMIT_NOFILE, &raised);
+    }
+    getrlimit(RLIMIT_NOFILE, &rl);
+    return rl.rlim_cur;
+}
+
+void run(const std::string& poller, size_t count, int seconds, size_t active,
+        int port) {
+    ServerProcess child(serverBody(poller, port, count + 16));
+    Peers peers(count);
+    for (size_t i = 0; i < count; i++)
+        peers[i].reset(new ScalingPeer());
+
+    // the server process may not be listening yet
+    uint64_t deadline = monotonicMillis() + 5000;
+    while (!connectPeer(*peers[0], 0, port)) {
+        if (monotonicMillis() > deadline) {
+            fprintf(stderr, "%s: server did not start\n", poller.c_str());
+            return;
+        }
+        boost::this_thread::sleep(boost::posix_time::milliseconds(10));
+    }
+    std::vector<uint64_t> empty;
+    do {
+        empty = child.ask('s');
+    } while (empty.size() == 3 && empty[2] < 1
+            && monotonicMillis() < deadline);
+
+    uint64_t start = monotonicMicros();
+    size_t connected = 1;
+    while (connected < count && connectPeer(*peers[connected], connected, port))
+        connected++;
+    std::vector<uint64_t> idle;
+    deadline = monotonicMillis() + 60000;
+    do {
+        idle = child.ask('s');
+    } while (idle.size() == 3 && idle[2] < connected
+            && monotonicMillis() < deadline);
+    double connectSecs = (monotonicMicros() - start) / 1e6;
+    if (idle.size() != 3 || empty.size() != 3) {
+        fprintf(stderr, "%s: server process failed\n", poller.c_str());
+        return;
+    }
+    size_t joined = idle[2];
+
+    // idle peers only cost the passes of the loop over them
+    boost::this_thread::sleep(boost::posix_time::seconds(seconds));
+    std::vector<uint64_t> rested = child.ask('s');
+    double idleCpu = (rested[0] - idle[0]) / (seconds * 1e6) * 100;
+
+    // a message through every peer allocates its buffers
+    Latencies wakeups;
+    exchange(peers, connected, 60000000, true, wakeups);
+    std::vector<uint64_t> used = child.ask('s');
+
+    wakeups.clear();
+    child.ask('m');
+    uint64_t trips = exchange(peers, std::min(active, connected),
+            (uint64_t) seconds * 1000000, false, wakeups);
+    std::vector<uint64_t> loop = child.ask('r');
+
+    printf("%-6s %7lu %10.0f %9.0f %9.0f %7.1f %8lu %8lu %8lu %8lu %10.0f\n",
+            poller.c_str(), (unsigned long) joined,
+            connected / connectSecs,
+            ((double) idle[1] - empty[1]) / joined,
+            ((double) used[1] - empty[1]) / joined,
+            idleCpu,
+            (unsigned long) loop[1], (unsigned long) loop[2],
+            (unsigned long) wakeups.percentile(0.5),
+            (unsigned long) wakeups.percentile(0.99),
+            trips / (double) seconds);
+    fflush(stdout);
+}
+
+int main(int argc, char** argv) {
+    GOOGLE_PROTOBUF_VERIFY_VERSION;
+    size_t maxPeers = argument(argc, argv, 1, 100000);
+    int seconds = argument(argc, argv, 2, 2);
+    size_t active = argument(argc, argv, 3, 64);
+
+    // both ends of every connection are in this process or the server
+    // process, with some descriptors to spare
+    size_t spare = 64;
+    size_t limit = raiseFileLimit(maxPeers + spare);
+    if (limit < maxPeers + spare) {
+        printf("open file limit %lu, testing up to %lu peers\n",
+                (unsigned long) limit, (unsigned long) (limit - spare));
+        maxPeers = limit - spare;
+    }
+
+    Socket::init();
+    printf("%-6s %7s %10s %9s %9s %7s %8s %8s %8s %8s %10s\n", "poller",
+            "peers", "connects/s", "idle B/p", "used B/p", "idle %",
+            "loop p50", "loop p99", "wake p50", "wake p99", "trips/s");
+    size_t counts[] = { 100, 1000, 10000, 30000, 100000 };
+    const char* pollers[] = { "select", "poll", "epoll" };
+    int port = 24450;
+    for (size_t i = 0; i < sizeof(pollers) / sizeof(pollers[0]); i++) {
+        size_t last = 0;
+        for (size_t j = 0; j < sizeof(counts) / sizeof(counts[0]); j++) {
+            size_t count = std::min(counts[j], maxPeers);
+            if (std::string(pollers[i]) == "select")
+                count = std::min<size_t>(count, FD_SETSIZE - spare);
+            if (count == last)
+                break;
+            run(pollers[i], count, seconds, active, port++);
+            last = count;
+        }
+    }
+    Socket::deinit();
+    return 0;
+}
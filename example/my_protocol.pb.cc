@@ -0,0 +1,791 @@
+// Generated by the protocol buffer compiler.  DO NOT EDIT!
+// source: my_protocol.proto
+
+#include "my_protocol.pb.h"
+
+#include <algorithm>
+
+#include <google/protobuf/io/coded_stream.h>
+#include <google/protobuf/extension_set.h>
+#include <google/protobuf/wire_format_lite.h>
+#include <google/protobuf/descriptor.h>
+#include <google/protobuf/generated_message_reflection.h>
+#include <google/protobuf/reflection_ops.h>
+#include <google/protobuf/wire_format.h>
+// @@protoc_insertion_point(includes)
+#include <google/protobuf/port_def.inc>
+
+PROTOBUF_PRAGMA_INIT_SEG
+
+namespace _pb = ::PROTOBUF_NAMESPACE_ID;
+namespace _pbi = _pb::internal;
+
+namespace my_protocol {
+PROTOBUF_CONSTEXPR Hello::Hello(
+    ::_pbi::ConstantInitialized): _impl_{
+    /*decltype(_impl_._has_bits_)*/{}
+  , /*decltype(_impl_._cached_size_)*/{}
+  , /*decltype(_impl_.greeting_)*/{&::_pbi::fixed_address_empty_string, ::_pbi::ConstantInitialized{}}} {}
+struct HelloDefaultTypeInternal {
+  PROTOBUF_CONSTEXPR HelloDefaultTypeInternal()
+      : _instance(::_pbi::ConstantInitialized{}) {}
+  ~HelloDefaultTypeInternal() {}
+  union {
+    Hello _instance;
+  };
+};
+PROTOBUF_ATTRIBUTE_NO_DESTROY PROTOBUF_CONSTINIT PROTOBUF_ATTRIBUTE_INIT_PRIORITY1 HelloDefaultTypeInternal _Hello_default_instance_;
+PROTOBUF_CONSTEXPR ServerMessage::ServerMessage(
+    ::_pbi::ConstantInitialized): _impl_{
+    /*decltype(_impl_._has_bits_)*/{}
+  , /*decltype(_impl_._cached_size_)*/{}
+  , /*decltype(_impl_.hello_)*/nullptr} {}
+struct ServerMessageDefaultTypeInternal {
+  PROTOBUF_CONSTEXPR ServerMessageDefaultTypeInternal()
+      : _instance(::_pbi::ConstantInitialized{}) {}
+  ~ServerMessageDefaultTypeInternal() {}
+  union {
+    ServerMessage _instance;
+  };
+};
+PROTOBUF_ATTRIBUTE_NO_DESTROY PROTOBUF_CONSTINIT PROTOBUF_ATTRIBUTE_INIT_PRIORITY1 ServerMessageDefaultTypeInternal _ServerMessage_default_instance_;
+PROTOBUF_CONSTEXPR ClientMessage::ClientMessage(
+    ::_pbi::ConstantInitialized): _impl_{
+    /*decltype(_impl_._has_bits_)*/{}
+  , /*decltype(_impl_._cached_size_)*/{}
+  , /*decltype(_impl_.hello_)*/nullptr} {}
+struct ClientMessageDefaultTypeInternal {
+  PROTOBUF_CONSTEXPR ClientMessageDefaultTypeInternal()
+      : _instance(::_pbi::ConstantInitialized{}) {}
+  ~ClientMessageDefaultTypeInternal() {}
+  union {
+    ClientMessage _instance;
+  };
+};
+PROTOBUF_ATTRIBUTE_NO_DESTROY PROTOBUF_CONSTINIT PROTOBUF_ATTRIBUTE_INIT_PRIORITY1 ClientMessageDefaultTypeInternal _ClientMessage_default_instance_;
+}  // namespace my_protocol
+static ::_pb::Metadata file_level_metadata_my_5fprotocol_2eproto[3];
+static constexpr ::_pb::EnumDescriptor const** file_level_enum_descriptors_my_5fprotocol_2eproto = nullptr;
+static constexpr ::_pb::ServiceDescriptor const** file_level_service_descriptors_my_5fprotocol_2eproto = nullptr;
+
+const uint32_t TableStruct_my_5fprotocol_2eproto::offsets[] PROTOBUF_SECTION_VARIABLE(protodesc_cold) = {
+  PROTOBUF_FIELD_OFFSET(::my_protocol::Hello, _impl_._has_bits_),
+  PROTOBUF_FIELD_OFFSET(::my_protocol::Hello, _internal_metadata_),
+  ~0u,  // no _extensions_
+  ~0u,  // no _oneof_case_
+  ~0u,  // no _weak_field_map_
+  ~0u,  // no _inlined_string_donated_
+  PROTOBUF_FIELD_OFFSET(::my_protocol::Hello, _impl_.greeting_),
+  0,
+  PROTOBUF_FIELD_OFFSET(::my_protocol::ServerMessage, _impl_._has_bits_),
+  PROTOBUF_FIELD_OFFSET(::my_protocol::ServerMessage, _internal_metadata_),
+  ~0u,  // no _extensions_
+  ~0u,  // no _oneof_case_
+  ~0u,  // no _weak_field_map_
+  ~0u,  // no _inlined_string_donated_
+  PROTOBUF_FIELD_OFFSET(::my_protocol::ServerMessage, _impl_.hello_),
+  0,
+  PROTOBUF_FIELD_OFFSET(::my_protocol::ClientMessage, _impl_._has_bits_),
+  PROTOBUF_FIELD_OFFSET(::my_protocol::ClientMessage, _internal_metadata_),
+  ~0u,  // no _extensions_
+  ~0u,  // no _oneof_case_
+  ~0u,  // no _weak_field_map_
+  ~0u,  // no _inlined_string_donated_
+  PROTOBUF_FIELD_OFFSET(::my_protocol::ClientMessage, _impl_.hello_),
+  0,
+};
+static const ::_pbi::MigrationSchema schemas[] PROTOBUF_SECTION_VARIABLE(protodesc_cold) = {
+  { 0, 7, -1, sizeof(::my_protocol::Hello)},
+  { 8, 15, -1, sizeof(::my_protocol::ServerMessage)},
+  { 16, 23, -1, sizeof(::my_protocol::ClientMessage)},
+};
+
+static const ::_pb::Message* const file_default_instances[] = {
+  &::my_protocol::_Hello_default_instance_._instance,
+  &::my_protocol::_ServerMessage_default_instance_._instance,
+  &::my_protocol::_ClientMessage_default_instance_._instance,
+};
+
+const char descriptor_table_protodef_my_5fprotocol_2eproto[] PROTOBUF_SECTION_VARIABLE(protodesc_cold) =
+  "\n\021my_protocol.proto\022\013my_protocol\"\031\n\005Hell"
+  "o\022\020\n\010greeting\030\001 \002(\t\"2\n\rServerMessage\022!\n\005"
+  "hello\030\001 \001(\0132\022.my_protocol.Hello\"2\n\rClien"
+  "tMessage\022!\n\005hello\030\001 \001(\0132\022.my_protocol.He"
+  "llo"
+  ;
+static ::_pbi::once_flag descriptor_table_my_5fprotocol_2eproto_once;
+const ::_pbi::DescriptorTable descriptor_table_my_5fprotocol_2eproto = {
+    false, false, 163, descriptor_table_protodef_my_5fprotocol_2eproto,
+    "my_protocol.proto",
+    &descriptor_table_my_5fprotocol_2eproto_once, nullptr, 0, 3,
+    schemas, file_default_instances, TableStruct_my_5fprotocol_2eproto::offsets,
+    file_level_metadata_my_5fprotocol_2eproto, file_level_enum_descriptors_my_5fprotocol_2eproto,
+    file_level_service_descriptors_my_5fprotocol_2eproto,
+};
+PROTOBUF_ATTRIBUTE_WEAK const ::_pbi::DescriptorTable* descriptor_table_my_5fprotocol_2eproto_getter() {
+  return &descriptor_table_my_5fprotocol_2eproto;
+}
+
+// Force running AddDescriptors() at dynamic initialization time.
+PROTOBUF_ATTRIBUTE_INIT_PRIORITY2 static ::_pbi::AddDescriptorsRunner dynamic_init_dummy_my_5fprotocol_2eproto(&descriptor_table_my_5fprotocol_2eproto);
+namespace my_protocol {
+
+// ===================================================================
+
+class Hello::_Internal {
+ public:
+  using HasBits = decltype(std::declval<Hello>()._impl_._has_bits_);
+  static void set_has_greeting(HasBits* has_bits) {
+    (*has_bits)[0] |= 1u;
+  }
+  static bool MissingRequiredFields(const HasBits& has_bits) {
+    return ((has_bits[0] & 0x00000001) ^ 0x00000001) != 0;
+  }
+};
+
+Hello::Hello(::PROTOBUF_NAMESPACE_ID::Arena* arena,
+                         bool is_message_owned)
+  : ::PROTOBUF_NAMESPACE_ID::Message(arena, is_message_owned) {
+  SharedCtor(arena, is_message_owned);
+  // @@protoc_insertion_point(arena_constructor:my_protocol.Hello)
+}
+Hello::Hello(const Hello& from)
+  : ::PROTOBUF_NAMESPACE_ID::Message() {
+  Hello* const _this = this; (void)_this;
+  new (&_impl_) Impl_{
+      decltype(_impl_._has_bits_){from._impl_._has_bits_}
+    , /*decltype(_impl_._cached_size_)*/{}
+    , decltype(_impl_.greeting_){}};
+
+  _internal_metadata_.MergeFrom<::PROTOBUF_NAMESPACE_ID::UnknownFieldSet>(from._internal_metadata_);
+  _impl_.greeting_.InitDefault();
+  #ifdef PROTOBUF_FORCE_COPY_DEFAULT_STRING
+    _impl_.greeting_.Set("", GetArenaForAllocation());
+  #endif // PROTOBUF_FORCE_COPY_DEFAULT_STRING
+  if (from._internal_has_greeting()) {
+    _this->_impl_.greeting_.Set(from._internal_greeting(), 
+      _this->GetArenaForAllocation());
+  }
+  // @@protoc_insertion_point(copy_constructor:my_protocol.Hello)
+}
+
+inline void Hello::SharedCtor(
+    ::_pb::Arena* arena, bool is_message_owned) {
+  (void)arena;
+  (void)is_message_owned;
+  new (&_impl_) Impl_{
+      decltype(_impl_._has_bits_){}
+    , /*decltype(_impl_._cached_size_)*/{}
+    , decltype(_impl_.greeting_){}
+  };
+  _impl_.greeting_.InitDefault();
+  #ifdef PROTOBUF_FORCE_COPY_DEFAULT_STRING
+    _impl_.greeting_.Set("", GetArenaForAllocation());
+  #endif // PROTOBUF_FORCE_COPY_DEFAULT_STRING
+}
+
+Hello::~Hello() {
+  // @@protoc_insertion_point(destructor:my_protocol.Hello)
+  if (auto *arena = _internal_metadata_.DeleteReturnArena<::PROTOBUF_NAMESPACE_ID::UnknownFieldSet>()) {
+  (void)arena;
+    return;
+  }
+  SharedDtor();
+}
+
+inline void Hello::SharedDtor() {
+  GOOGLE_DCHECK(GetArenaForAllocation() == nullptr);
+  _impl_.greeting_.Destroy();
+}
+
+void Hello::SetCachedSize(int size) const {
+  _impl_._cached_size_.Set(size);
+}
+
+void Hello::Clear() {
+// @@protoc_insertion_point(message_clear_start:my_protocol.Hello)
+  uint32_t cached_has_bits = 0;
+  // Prevent compiler warnings about cached_has_bits being unused
+  (void) cached_has_bits;
+
+  cached_has_bits = _impl_._has_bits_[0];
+  if (cached_has_bits & 0x00000001u) {
+    _impl_.greeting_.ClearNonDefaultToEmpty();
+  }
+  _impl_._has_bits_.Clear();
+  _internal_metadata_.Clear<::PROTOBUF_NAMESPACE_ID::UnknownFieldSet>();
+}
+
+const char* Hello::_InternalParse(const char* ptr, ::_pbi::ParseContext* ctx) {
+#define CHK_(x) if (PROTOBUF_PREDICT_FALSE(!(x))) goto failure
+  _Internal::HasBits has_bits{};
+  while (!ctx->Done(&ptr)) {
+    uint32_t tag;
+    ptr = ::_pbi::ReadTag(ptr, &tag);
+    switch (tag >> 3) {
+      // required string greeting = 1;
+      case 1:
+        if (PROTOBUF_PREDICT_TRUE(static_cast<uint8_t>(tag) == 10)) {
+          auto str = _internal_mutable_greeting();
+          ptr = ::_pbi::InlineGreedyStringParser(str, ptr, ctx);
+          CHK_(ptr);
+          #ifndef NDEBUG
+          ::_pbi::VerifyUTF8(str, "my_protocol.Hello.greeting");
+          #endif  // !NDEBUG
+        } else
+          goto handle_unusual;
+        continue;
+      default:
+        goto handle_unusual;
+    }  // switch
+  handle_unusual:
+    if ((tag == 0) || ((tag & 7) == 4)) {
+      CHK_(ptr);
+      ctx->SetLastTag(tag);
+      goto message_done;
+    }
+    ptr = UnknownFieldParse(
+        tag,
+        _internal_metadata_.mutable_unknown_fields<::PROTOBUF_NAMESPACE_ID::UnknownFieldSet>(),
+        ptr, ctx);
+    CHK_(ptr != nullptr);
+  }  // while
+message_done:
+  _impl_._has_bits_.Or(has_bits);
+  return ptr;
+failure:
+  ptr = nullptr;
+  goto message_done;
+#undef CHK_
+}
+
+uint8_t* Hello::_InternalSerialize(
+    uint8_t* target, ::PROTOBUF_NAMESPACE_ID::io::EpsCopyOutputStream* stream) const {
+  // @@protoc_insertion_point(serialize_to_array_start:my_protocol.Hello)
+  uint32_t cached_has_bits = 0;
+  (void) cached_has_bits;
+
+  cached_has_bits = _impl_._has_bits_[0];
+  // required string greeting = 1;
+  if (cached_has_bits & 0x00000001u) {
+    ::PROTOBUF_NAMESPACE_ID::internal::WireFormat::VerifyUTF8StringNamedField(
+      this->_internal_greeting().data(), static_cast<int>(this->_internal_greeting().length()),
+      ::PROTOBUF_NAMESPACE_ID::internal::WireFormat::SERIALIZE,
+      "my_protocol.Hello.greeting");
+    target = stream->WriteStringMaybeAliased(
+        1, this->_internal_greeting(), target);
+  }
+
+  if (PROTOBUF_PREDICT_FALSE(_internal_metadata_.have_unknown_fields())) {
+    target = ::_pbi::WireFormat::InternalSerializeUnknownFieldsToArray(
+        _internal_metadata_.unknown_fields<::PROTOBUF_NAMESPACE_ID::UnknownFieldSet>(::PROTOBUF_NAMESPACE_ID::UnknownFieldSet::default_instance), target, stream);
+  }
+  // @@protoc_insertion_point(serialize_to_array_end:my_protocol.Hello)
+  return target;
+}
+
+size_t Hello::ByteSizeLong() const {
+// @@protoc_insertion_point(message_byte_size_start:my_protocol.Hello)
+  size_t total_size = 0;
+
+  // required string greeting = 1;
+  if (_internal_has_greeting()) {
+    total_size += 1 +
+      ::PROTOBUF_NAMESPACE_ID::internal::WireFormatLite::StringSize(
+        this->_internal_greeting());
+  }
+  uint32_t cached_has_bits = 0;
+  // Prevent compiler warnings about cached_has_bits being unused
+  (void) cached_has_bits;
+
+  return MaybeComputeUnknownFieldsSize(total_size, &_impl_._cached_size_);
+}
+
+const ::PROTOBUF_NAMESPACE_ID::Message::ClassData Hello::_class_data_ = {
+    ::PROTOBUF_NAMESPACE_ID::Message::CopyWithSourceCheck,
+    Hello::MergeImpl
+};
+const ::PROTOBUF_NAMESPACE_ID::Message::ClassData*Hello::GetClassData() const { return &_class_data_; }
+
+
+void Hello::MergeImpl(::PROTOBUF_NAMESPACE_ID::Message& to_msg, const ::PROTOBUF_NAMESPACE_ID::Message& from_msg) {
+  auto* const _this = static_cast<Hello*>(&to_msg);
+  auto& from = static_cast<const Hello&>(from_msg);
+  // @@protoc_insertion_point(class_specific_merge_from_start:my_protocol.Hello)
+  GOOGLE_DCHECK_NE(&from, _this);
+  uint32_t cached_has_bits = 0;
+  (void) cached_has_bits;
+
+  if (from._internal_has_greeting()) {
+    _this->_internal_set_greeting(from._internal_greeting());
+  }
+  _this->_internal_metadata_.MergeFrom<::PROTOBUF_NAMESPACE_ID::UnknownFieldSet>(from._internal_metadata_);
+}
+
+void Hello::CopyFrom(const Hello& from) {
+// @@protoc_insertion_point(class_specific_copy_from_start:my_protocol.Hello)
+  if (&from == this) return;
+  Clear();
+  MergeFrom(from);
+}
+
+bool Hello::IsInitialized() const {
+  if (_Internal::MissingRequiredFields(_impl_._has_bits_)) return false;
+  return true;
+}
+
+void Hello::InternalSwap(Hello* other) {
+  using std::swap;
+  auto* lhs_arena = GetArenaForAllocation();
+  auto* rhs_arena = other->GetArenaForAllocation();
+  _internal_metadata_.InternalSwap(&other->_internal_metadata_);
+  swap(_impl_._has_bits_[0], other->_impl_._has_bits_[0]);
+  ::PROTOBUF_NAMESPACE_ID::internal::ArenaStringPtr::InternalSwap(
+      &_impl_.greeting_, lhs_arena,
+      &other->_impl_.greeting_, rhs_arena
+  );
+}
+
+::PROTOBUF_NAMESPACE_ID::Metadata Hello::GetMetadata() const {
+  return ::_pbi::AssignDescriptors(
+      &descriptor_table_my_5fprotocol_2eproto_getter, &descriptor_table_my_5fprotocol_2eproto_once,
+      file_level_metadata_my_5fprotocol_2eproto[0]);
+}
+
+// ===================================================================
+
+class ServerMessage::_Internal {
+ public:
+  using HasBits = decltype(std::declval<ServerMessage>()._impl_._has_bits_);
+  static const ::my_protocol::Hello& hello(const ServerMessage* msg);
+  static void set_has_hello(HasBits* has_bits) {
+    (*has_bits)[0] |= 1u;
+  }
+};
+
+const ::my_protocol::Hello&
+ServerMessage::_Internal::hello(const ServerMessage* msg) {
+  return *msg->_impl_.hello_;
+}
+ServerMessage::ServerMessage(::PROTOBUF_NAMESPACE_ID::Arena* arena,
+                         bool is_message_owned)
+  : ::PROTOBUF_NAMESPACE_ID::Message(arena, is_message_owned) {
+  SharedCtor(arena, is_message_owned);
+  // @@protoc_insertion_point(arena_constructor:my_protocol.ServerMessage)
+}
+ServerMessage::ServerMessage(const ServerMessage& from)
+  : ::PROTOBUF_NAMESPACE_ID::Message() {
+  ServerMessage* const _this = this; (void)_this;
+  new (&_impl_) Impl_{
+      decltype(_impl_._has_bits_){from._impl_._has_bits_}
+    , /*decltype(_impl_._cached_size_)*/{}
+    , decltype(_impl_.hello_){nullptr}};
+
+  _internal_metadata_.MergeFrom<::PROTOBUF_NAMESPACE_ID::UnknownFieldSet>(from._internal_metadata_);
+  if (from._internal_has_hello()) {
+    _this->_impl_.hello_ = new ::my_protocol::Hello(*from._impl_.hello_);
+  }
+  // @@protoc_insertion_point(copy_constructor:my_protocol.ServerMessage)
+}
+
+inline void ServerMessage::SharedCtor(
+    ::_pb::Arena* arena, bool is_message_owned) {
+  (void)arena;
+  (void)is_message_owned;
+  new (&_impl_) Impl_{
+      decltype(_impl_._has_bits_){}
+    , /*decltype(_impl_._cached_size_)*/{}
+    , decltype(_impl_.hello_){nullptr}
+  };
+}
+
+ServerMessage::~ServerMessage() {
+  // @@protoc_insertion_point(destructor:my_protocol.ServerMessage)
+  if (auto *arena = _internal_metadata_.DeleteReturnArena<::PROTOBUF_NAMESPACE_ID::UnknownFieldSet>()) {
+  (void)arena;
+    return;
+  }
+  SharedDtor();
+}
+
+inline void ServerMessage::SharedDtor() {
+  GOOGLE_DCHECK(GetArenaForAllocation() == nullptr);
+  if (this != internal_default_instance()) delete _impl_.hello_;
+}
+
+void ServerMessage::SetCachedSize(int size) const {
+  _impl_._cached_size_.Set(size);
+}
+
+void ServerMessage::Clear() {
+// @@protoc_insertion_point(message_clear_start:my_protocol.ServerMessage)
+  uint32_t cached_has_bits = 0;
+  // Prevent compiler warnings about cached_has_bits being unused
+  (void) cached_has_bits;
+
+  cached_has_bits = _impl_._has_bits_[0];
+  if (cached_has_bits & 0x00000001u) {
+    GOOGLE_DCHECK(_impl_.hello_ != nullptr);
+    _impl_.hello_->Clear();
+  }
+  _impl_._has_bits_.Clear();
+  _internal_metadata_.Clear<::PROTOBUF_NAMESPACE_ID::UnknownFieldSet>();
+}
+
+const char* ServerMessage::_InternalParse(const char* ptr, ::_pbi::ParseContext* ctx) {
+#define CHK_(x) if (PROTOBUF_PREDICT_FALSE(!(x))) goto failure
+  _Internal::HasBits has_bits{};
+  while (!ctx->Done(&ptr)) {
+    uint32_t tag;
+    ptr = ::_pbi::ReadTag(ptr, &tag);
+    switch (tag >> 3) {
+      // optional .my_protocol.Hello hello = 1;
+      case 1:
+        if (PROTOBUF_PREDICT_TRUE(static_cast<uint8_t>(tag) == 10)) {
+          ptr = ctx->ParseMessage(_internal_mutable_hello(), ptr);
+          CHK_(ptr);
+        } else
+          goto handle_unusual;
+        continue;
+      default:
+        goto handle_unusual;
+    }  // switch
+  handle_unusual:
+    if ((tag == 0) || ((tag & 7) == 4)) {
+      CHK_(ptr);
+      ctx->SetLastTag(tag);
+      goto message_done;
+    }
+    ptr = UnknownFieldParse(
+        tag,
+        _internal_metadata_.mutable_unknown_fields<::PROTOBUF_NAMESPACE_ID::UnknownFieldSet>(),
+        ptr, ctx);
+    CHK_(ptr != nullptr);
+  }  // while
+message_done:
+  _impl_._has_bits_.Or(has_bits);
+  return ptr;
+failure:
+  ptr = nullptr;
+  goto message_done;
+#undef CHK_
+}
+
+uint8_t* ServerMessage::_InternalSerialize(
+    uint8_t* target, ::PROTOBUF_NAMESPACE_ID::io::EpsCopyOutputStream* stream) const {
+  // @@protoc_insertion_point(serialize_to_array_start:my_protocol.ServerMessage)
+  uint32_t cached_has_bits = 0;
+  (void) cached_has_bits;
+
+  cached_has_bits = _impl_._has_bits_[0];
+  // optional .my_protocol.Hello hello = 1;
+  if (cached_has_bits & 0x00000001u) {
+    target = ::PROTOBUF_NAMESPACE_ID::internal::WireFormatLite::
+      InternalWriteMessage(1, _Internal::hello(this),
+        _Internal::hello(this).GetCachedSize(), target, stream);
+  }
+
+  if (PROTOBUF_PREDICT_FALSE(_internal_metadata_.have_unknown_fields())) {
+    target = ::_pbi::WireFormat::InternalSerializeUnknownFieldsToArray(
+        _internal_metadata_.unknown_fields<::PROTOBUF_NAMESPACE_ID::UnknownFieldSet>(::PROTOBUF_NAMESPACE_ID::UnknownFieldSet::default_instance), target, stream);
+  }
+  // @@protoc_insertion_point(serialize_to_array_end:my_protocol.ServerMessage)
+  return target;
+}
+
+size_t ServerMessage::ByteSizeLong() const {
+// @@protoc_insertion_point(message_byte_size_start:my_protocol.ServerMessage)
+  size_t total_size = 0;
+
+  uint32_t cached_has_bits = 0;
+  // Prevent compiler warnings about cached_has_bits being unused
+  (void) cached_has_bits;
+
+  // optional .my_protocol.Hello hello = 1;
+  cached_has_bits = _impl_._has_bits_[0];
+  if (cached_has_bits & 0x00000001u) {
+    total_size += 1 +
+      ::PROTOBUF_NAMESPACE_ID::internal::WireFormatLite::MessageSize(
+        *_impl_.hello_);
+  }
+
+  return MaybeComputeUnknownFieldsSize(total_size, &_impl_._cached_size_);
+}
+
+const ::PROTOBUF_NAMESPACE_ID::Message::ClassData ServerMessage::_class_data_ = {
+    ::PROTOBUF_NAMESPACE_ID::Message::CopyWithSourceCheck,
+    ServerMessage::MergeImpl
+};
+const ::PROTOBUF_NAMESPACE_ID::Message::ClassData*ServerMessage::GetClassData() const { return &_class_data_; }
+
+
+void ServerMessage::MergeImpl(::PROTOBUF_NAMESPACE_ID::Message& to_msg, const ::PROTOBUF_NAMESPACE_ID::Message& from_msg) {
+  auto* const _this = static_cast<ServerMessage*>(&to_msg);
+  auto& from = static_cast<const ServerMessage&>(from_msg);
+  // @@protoc_insertion_point(class_specific_merge_from_start:my_protocol.ServerMessage)
+  GOOGLE_DCHECK_NE(&from, _this);
+  uint32_t cached_has_bits = 0;
+  (void) cached_has_bits;
+
+  if (from._internal_has_hello()) {
+    _this->_internal_mutable_hello()->::my_protocol::Hello::MergeFrom(
+        from._internal_hello());
+  }
+  _this->_internal_metadata_.MergeFrom<::PROTOBUF_NAMESPACE_ID::UnknownFieldSet>(from._internal_metadata_);
+}
+
+void ServerMessage::CopyFrom(const ServerMessage& from) {
+// @@protoc_insertion_point(class_specific_copy_from_start:my_protocol.ServerMessage)
+  if (&from == this) return;
+  Clear();
+  MergeFrom(from);
+}
+
+bool ServerMessage::IsInitialized() const {
+  if (_internal_has_hello()) {
+    if (!_impl_.hello_->IsInitialized()) return false;
+  }
+  return true;
+}
+
+void ServerMessage::InternalSwap(ServerMessage* other) {
+  using std::swap;
+  _internal_metadata_.InternalSwap(&other->_internal_metadata_);
+  swap(_impl_._has_bits_[0], other->_impl_._has_bits_[0]);
+  swap(_impl_.hello_, other->_impl_.hello_);
+}
+
+::PROTOBUF_NAMESPACE_ID::Metadata ServerMessage::GetMetadata() const {
+  return ::_pbi::AssignDescriptors(
+      &descriptor_table_my_5fprotocol_2eproto_getter, &descriptor_table_my_5fprotocol_2eproto_once,
+      file_level_metadata_my_5fprotocol_2eproto[1]);
+}
+
+// ===================================================================
+
+class ClientMessage::_Internal {
+ public:
+  using HasBits = decltype(std::declval<ClientMessage>()._impl_._has_bits_);
+  static const ::my_protocol::Hello& hello(const ClientMessage* msg);
+  static void set_has_hello(HasBits* has_bits) {
+    (*has_bits)[0] |= 1u;
+  }
+};
+
+const ::my_protocol::Hello&
+ClientMessage::_Internal::hello(const ClientMessage* msg) {
+  return *msg->_impl_.hello_;
+}
+ClientMessage::ClientMessage(::PROTOBUF_NAMESPACE_ID::Arena* arena,
+                         bool is_message_owned)
+  : ::PROTOBUF_NAMESPACE_ID::Message(arena, is_message_owned) {
+  SharedCtor(arena, is_message_owned);
+  // @@protoc_insertion_point(arena_constructor:my_protocol.ClientMessage)
+}
+ClientMessage::ClientMessage(const ClientMessage& from)
+  : ::PROTOBUF_NAMESPACE_ID::Message() {
+  ClientMessage* const _this = this; (void)_this;
+  new (&_impl_) Impl_{
+      decltype(_impl_._has_bits_){from._impl_._has_bits_}
+    , /*decltype(_impl_._cached_size_)*/{}
+    , decltype(_impl_.hello_){nullptr}};
+
+  _internal_metadata_.MergeFrom<::PROTOBUF_NAMESPACE_ID::UnknownFieldSet>(from._internal_metadata_);
+  if (from._internal_has_hello()) {
+    _this->_impl_.hello_ = new ::my_protocol::Hello(*from._impl_.hello_);
+  }
+  // @@protoc_insertion_point(copy_constructor:my_protocol.ClientMessage)
+}
+
+inline void ClientMessage::SharedCtor(
+    ::_pb::Arena* arena, bool is_message_owned) {
+  (void)arena;
+  (void)is_message_owned;
+  new (&_impl_) Impl_{
+      decltype(_impl_._has_bits_){}
+    , /*decltype(_impl_._cached_size_)*/{}
+    , decltype(_impl_.hello_){nullptr}
+  };
+}
+
+ClientMessage::~ClientMessage() {
+  // @@protoc_insertion_point(destructor:my_protocol.ClientMessage)
+  if (auto *arena = _internal_metadata_.DeleteReturnArena<::PROTOBUF_NAMESPACE_ID::UnknownFieldSet>()) {
+  (void)arena;
+    return;
+  }
+  SharedDtor();
+}
+
+inline void ClientMessage::SharedDtor() {
+  GOOGLE_DCHECK(GetArenaForAllocation() == nullptr);
+  if (this != internal_default_instance()) delete _impl_.hello_;
+}
+
+void ClientMessage::SetCachedSize(int size) const {
+  _impl_._cached_size_.Set(size);
+}
+
+void ClientMessage::Clear() {
+// @@protoc_insertion_point(message_clear_start:my_protocol.ClientMessage)
+  uint32_t cached_has_bits = 0;
+  // Prevent compiler warnings about cached_has_bits being unused
+  (void) cached_has_bits;
+
+  cached_has_bits = _impl_._has_bits_[0];
+  if (cached_has_bits & 0x00000001u) {
+    GOOGLE_DCHECK(_impl_.hello_ != nullptr);
+    _impl_.hello_->Clear();
+  }
+  _impl_._has_bits_.Clear();
+  _internal_metadata_.Clear<::PROTOBUF_NAMESPACE_ID::UnknownFieldSet>();
+}
+
+const char* ClientMessage::_InternalParse(const char* ptr, ::_pbi::ParseContext* ctx) {
+#define CHK_(x) if (PROTOBUF_PREDICT_FALSE(!(x))) goto failure
+  _Internal::HasBits has_bits{};
+  while (!ctx->Done(&ptr)) {
+    uint32_t tag;
+    ptr = ::_pbi::ReadTag(ptr, &tag);
+    switch (tag >> 3) {
+      // optional .my_protocol.Hello hello = 1;
+      case 1:
+        if (PROTOBUF_PREDICT_TRUE(static_cast<uint8_t>(tag) == 10)) {
+          ptr = ctx->ParseMessage(_internal_mutable_hello(), ptr);
+          CHK_(ptr);
+        } else
+          goto handle_unusual;
+        continue;
+      default:
+        goto handle_unusual;
+    }  // switch
+  handle_unusual:
+    if ((tag == 0) || ((tag & 7) == 4)) {
+      CHK_(ptr);
+      ctx->SetLastTag(tag);
+      goto message_done;
+    }
+    ptr = UnknownFieldParse(
+        tag,
+        _internal_metadata_.mutable_unknown_fields<::PROTOBUF_NAMESPACE_ID::UnknownFieldSet>(),
+        ptr, ctx);
+    CHK_(ptr != nullptr);
+  }  // while
+message_done:
+  _impl_._has_bits_.Or(has_bits);
+  return ptr;
+failure:
+  ptr = nullptr;
+  goto message_done;
+#undef CHK_
+}
+
+uint8_t* ClientMessage::_InternalSerialize(
+    uint8_t* target, ::PROTOBUF_NAMESPACE_ID::io::EpsCopyOutputStream* stream) const {
+  // @@protoc_insertion_point(serialize_to_array_start:my_protocol.ClientMessage)
+  uint32_t cached_has_bits = 0;
+  (void) cached_has_bits;
+
+  cached_has_bits = _impl_._has_bits_[0];
+  // optional .my_protocol.Hello hello = 1;
+  if (cached_has_bits & 0x00000001u) {
+    target = ::PROTOBUF_NAMESPACE_ID::internal::WireFormatLite::
+      InternalWriteMessage(1, _Internal::hello(this),
+        _Internal::hello(this).GetCachedSize(), target, stream);
+  }
+
+  if (PROTOBUF_PREDICT_FALSE(_internal_metadata_.have_unknown_fields())) {
+    target = ::_pbi::WireFormat::InternalSerializeUnknownFieldsToArray(
+        _internal_metadata_.unknown_fields<::PROTOBUF_NAMESPACE_ID::UnknownFieldSet>(::PROTOBUF_NAMESPACE_ID::UnknownFieldSet::default_instance), target, stream);
+  }
+  // @@protoc_insertion_point(serialize_to_array_end:my_protocol.ClientMessage)
+  return target;
+}
+
+size_t ClientMessage::ByteSizeLong() const {
+// @@protoc_insertion_point(message_byte_size_start:my_protocol.ClientMessage)
+  size_t total_size = 0;
+
+  uint32_t cached_has_bits = 0;
+  // Prevent compiler warnings about cached_has_bits being unused
+  (void) cached_has_bits;
+
+  // optional .my_protocol.Hello hello = 1;
+  cached_has_bits = _impl_._has_bits_[0];
+  if (cached_has_bits & 0x00000001u) {
+    total_size += 1 +
+      ::PROTOBUF_NAMESPACE_ID::internal::WireFormatLite::MessageSize(
+        *_impl_.hello_);
+  }
+
+  return MaybeComputeUnknownFieldsSize(total_size, &_impl_._cached_size_);
+}
+
+const ::PROTOBUF_NAMESPACE_ID::Message::ClassData ClientMessage::_class_data_ = {
+    ::PROTOBUF_NAMESPACE_ID::Message::CopyWithSourceCheck,
+    ClientMessage::MergeImpl
+};
+const ::PROTOBUF_NAMESPACE_ID::Message::ClassData*ClientMessage::GetClassData() const { return &_class_data_; }
+
+
+void ClientMessage::MergeImpl(::PROTOBUF_NAMESPACE_ID::Message& to_msg, const ::PROTOBUF_NAMESPACE_ID::Message& from_msg) {
+  auto* const _this = static_cast<ClientMessage*>(&to_msg);
+  auto& from = static_cast<const ClientMessage&>(from_msg);
+  // @@protoc_insertion_point(class_specific_merge_from_start:my_protocol.ClientMessage)
+  GOOGLE_DCHECK_NE(&from, _this);
+  uint32_t cached_has_bits = 0;
+  (void) cached_has_bits;
+
+  if (from._internal_has_hello()) {
+    _this->_internal_mutable_hello()->::my_protocol::Hello::MergeFrom(
+        from._internal_hello());
+  }
+  _this->_internal_metadata_.MergeFrom<::PROTOBUF_NAMESPACE_ID::UnknownFieldSet>(from._internal_metadata_);
+}
+
+void ClientMessage::CopyFrom(const ClientMessage& from) {
+// @@protoc_insertion_point(class_specific_copy_from_start:my_protocol.ClientMessage)
+  if (&from == this) return;
+  Clear();
+  MergeFrom(from);
+}
+
+bool ClientMessage::IsInitialized() const {
+  if (_internal_has_hello()) {
+    if (!_impl_.hello_->IsInitialized()) return false;
+  }
+  return true;
+}
+
+void ClientMessage::InternalSwap(ClientMessage* other) {
+  using std::swap;
+  _internal_metadata_.InternalSwap(&other->_internal_metadata_);
+  swap(_impl_._has_bits_[0], other->_impl_._has_bits_[0]);
+  swap(_impl_.hello_, other->_impl_.hello_);
+}
+
+::PROTOBUF_NAMESPACE_ID::Metadata ClientMessage::GetMetadata() const {
+  return ::_pbi::AssignDescriptors(
+      &descriptor_table_my_5fprotocol_2eproto_getter, &descriptor_table_my_5fprotocol_2eproto_once,
+      file_level_metadata_my_5fprotocol_2eproto[2]);
+}
+
+// @@protoc_insertion_point(namespace_scope)
+}  // namespace my_protocol
+PROTOBUF_NAMESPACE_OPEN
+template<> PROTOBUF_NOINLINE ::my_protocol::Hello*
+Arena::CreateMaybeMessage< ::my_protocol::Hello >(Arena* arena) {
+  return Arena::CreateMessageInternal< ::my_protocol::Hello >(arena);
+}
+template<> PROTOBUF_NOINLINE ::my_protocol::ServerMessage*
+Arena::CreateMaybeMessage< ::my_protocol::ServerMessage >(Arena* arena) {
+  return Arena::CreateMessageInternal< ::my_protocol::ServerMessage >(arena);
+}
+template<> PROTOBUF_NOINLINE ::my_protocol::ClientMessage*
+Arena::CreateMaybeMessage< ::my_protocol::ClientMessage >(Arena* arena) {
+  return Arena::CreateMessageInternal< ::my_protocol::ClientMessage >(arena);
+}
+PROTOBUF_NAMESPACE_CLOSE
+
+// @@protoc_insertion_point(global_scope)
+#include <google/protobuf/port_undef.inc>
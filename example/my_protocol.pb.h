@@ -0,0 +1,842 @@
+// Generated by the protocol buffer compiler.  DO NOT EDIT!
+// source: my_protocol.proto
+
+#ifndef GOOGLE_PROTOBUF_INCLUDED_my_5fprotocol_2eproto
+#define GOOGLE_PROTOBUF_INCLUDED_my_5fprotocol_2eproto
+
+#include <limits>
+#include <string>
+
+#include <google/protobuf/port_def.inc>
+#if PROTOBUF_VERSION < 3021000
+#error This file was generated by a newer version of protoc which is
+#error incompatible with your Protocol Buffer headers. Please update
+#error your headers.
+#endif
+#if 3021012 < PROTOBUF_MIN_PROTOC_VERSION
+#error This file was generated by an older version of protoc which is
+#error incompatible with your Protocol Buffer headers. Please
+#error regenerate this file with a newer version of protoc.
+#endif
+
+#include <google/protobuf/port_undef.inc>
+#include <google/protobuf/io/coded_stream.h>
+#include <google/protobuf/arena.h>
+#include <google/protobuf/arenastring.h>
+#include <google/protobuf/generated_message_util.h>
+#include <google/protobuf/metadata_lite.h>
+#include <google/protobuf/generated_message_reflection.h>
+#include <google/protobuf/message.h>
+#include <google/protobuf/repeated_field.h>  // IWYU pragma: export
+#include <google/protobuf/extension_set.h>  // IWYU pragma: export
+#include <google/protobuf/unknown_field_set.h>
+// @@protoc_insertion_point(includes)
+#include <google/protobuf/port_def.inc>
+#define PROTOBUF_INTERNAL_EXPORT_my_5fprotocol_2eproto
+PROTOBUF_NAMESPACE_OPEN
+namespace internal {
+class AnyMetadata;
+}  // namespace internal
+PROTOBUF_NAMESPACE_CLOSE
+
+// Internal implementation detail -- do not use these members.
+struct TableStruct_my_5fprotocol_2eproto {
+  static const uint32_t offsets[];
+};
+extern const ::PROTOBUF_NAMESPACE_ID::internal::DescriptorTable descriptor_table_my_5fprotocol_2eproto;
+namespace my_protocol {
+class ClientMessage;
+struct ClientMessageDefaultTypeInternal;
+extern ClientMessageDefaultTypeInternal _ClientMessage_default_instance_;
+class Hello;
+struct HelloDefaultTypeInternal;
+extern HelloDefaultTypeInternal _Hello_default_instance_;
+class ServerMessage;
+struct ServerMessageDefaultTypeInternal;
+extern ServerMessageDefaultTypeInternal _ServerMessage_default_instance_;
+}  // namespace my_protocol
+PROTOBUF_NAMESPACE_OPEN
+template<> ::my_protocol::ClientMessage* Arena::CreateMaybeMessage<::my_protocol::ClientMessage>(Arena*);
+template<> ::my_protocol::Hello* Arena::CreateMaybeMessage<::my_protocol::Hello>(Arena*);
+template<> ::my_protocol::ServerMessage* Arena::CreateMaybeMessage<::my_protocol::ServerMessage>(Arena*);
+PROTOBUF_NAMESPACE_CLOSE
+namespace my_protocol {
+
+// ===================================================================
+
+class Hello final :
+    public ::PROTOBUF_NAMESPACE_ID::Message /* @@protoc_insertion_point(class_definition:my_protocol.Hello) */ {
+ public:
+  inline Hello() : Hello(nullptr) {}
+  ~Hello() override;
+  explicit PROTOBUF_CONSTEXPR Hello(::PROTOBUF_NAMESPACE_ID::internal::ConstantInitialized);
+
+  Hello(const Hello& from);
+  Hello(Hello&& from) noexcept
+    : Hello() {
+    *this = ::std::move(from);
+  }
+
+  inline Hello& operator=(const Hello& from) {
+    CopyFrom(from);
+    return *this;
+  }
+  inline Hello& operator=(Hello&& from) noexcept {
+    if (this == &from) return *this;
+    if (GetOwningArena() == from.GetOwningArena()
+  #ifdef PROTOBUF_FORCE_COPY_IN_MOVE
+        && GetOwningArena() != nullptr
+  #endif  // !PROTOBUF_FORCE_COPY_IN_MOVE
+    ) {
+      InternalSwap(&from);
+    } else {
+      CopyFrom(from);
+    }
+    return *this;
+  }
+
+  inline const ::PROTOBUF_NAMESPACE_ID::UnknownFieldSet& unknown_fields() const {
+    return _internal_metadata_.unknown_fields<::PROTOBUF_NAMESPACE_ID::UnknownFieldSet>(::PROTOBUF_NAMESPACE_ID::UnknownFieldSet::default_instance);
+  }
+  inline ::PROTOBUF_NAMESPACE_ID::UnknownFieldSet* mutable_unknown_fields() {
+    return _internal_metadata_.mutable_unknown_fields<::PROTOBUF_NAMESPACE_ID::UnknownFieldSet>();
+  }
+
+  static const ::PROTOBUF_NAMESPACE_ID::Descriptor* descriptor() {
+    return GetDescriptor();
+  }
+  static const ::PROTOBUF_NAMESPACE_ID::Descriptor* GetDescriptor() {
+    return default_instance().GetMetadata().descriptor;
+  }
+  static const ::PROTOBUF_NAMESPACE_ID::Reflection* GetReflection() {
+    return default_instance().GetMetadata().reflection;
+  }
+  static const Hello& default_instance() {
+    return *internal_default_instance();
+  }
+  static inline const Hello* internal_default_instance() {
+    return reinterpret_cast<const Hello*>(
+               &_Hello_default_instance_);
+  }
+  static constexpr int kIndexInFileMessages =
+    0;
+
+  friend void swap(Hello& a, Hello& b) {
+    a.Swap(&b);
+  }
+  inline void Swap(Hello* other) {
+    if (other == this) return;
+  #ifdef PROTOBUF_FORCE_COPY_IN_SWAP
+    if (GetOwningArena() != nullptr &&
+        GetOwningArena() == other->GetOwningArena()) {
+   #else  // PROTOBUF_FORCE_COPY_IN_SWAP
+    if (GetOwningArena() == other->GetOwningArena()) {
+  #endif  // !PROTOBUF_FORCE_COPY_IN_SWAP
+      InternalSwap(other);
+    } else {
+      ::PROTOBUF_NAMESPACE_ID::internal::GenericSwap(this, other);
+    }
+  }
+  void UnsafeArenaSwap(Hello* other) {
+    if (other == this) return;
+    GOOGLE_DCHECK(GetOwningArena() == other->GetOwningArena());
+    InternalSwap(other);
+  }
+
+  // implements Message ----------------------------------------------
+
+  Hello* New(::PROTOBUF_NAMESPACE_ID::Arena* arena = nullptr) const final {
+    return CreateMaybeMessage<Hello>(arena);
+  }
+  using ::PROTOBUF_NAMESPACE_ID::Message::CopyFrom;
+  void CopyFrom(const Hello& from);
+  using ::PROTOBUF_NAMESPACE_ID::Message::MergeFrom;
+  void MergeFrom( const Hello& from) {
+    Hello::MergeImpl(*this, from);
+  }
+  private:
+  static void MergeImpl(::PROTOBUF_NAMESPACE_ID::Message& to_msg, const ::PROTOBUF_NAMESPACE_ID::Message& from_msg);
+  public:
+  PROTOBUF_ATTRIBUTE_REINITIALIZES void Clear() final;
+  bool IsInitialized() const final;
+
+  size_t ByteSizeLong() const final;
+  const char* _InternalParse(const char* ptr, ::PROTOBUF_NAMESPACE_ID::internal::ParseContext* ctx) final;
+  uint8_t* _InternalSerialize(
+      uint8_t* target, ::PROTOBUF_NAMESPACE_ID::io::EpsCopyOutputStream* stream) const final;
+  int GetCachedSize() const final { return _impl_._cached_size_.Get(); }
+
+  private:
+  void SharedCtor(::PROTOBUF_NAMESPACE_ID::Arena* arena, bool is_message_owned);
+  void SharedDtor();
+  void SetCachedSize(int size) const final;
+  void InternalSwap(Hello* other);
+
+  private:
+  friend class ::PROTOBUF_NAMESPACE_ID::internal::AnyMetadata;
+  static ::PROTOBUF_NAMESPACE_ID::StringPiece FullMessageName() {
+    return "my_protocol.Hello";
+  }
+  protected:
+  explicit Hello(::PROTOBUF_NAMESPACE_ID::Arena* arena,
+                       bool is_message_owned = false);
+  public:
+
+  static const ClassData _class_data_;
+  const ::PROTOBUF_NAMESPACE_ID::Message::ClassData*GetClassData() const final;
+
+  ::PROTOBUF_NAMESPACE_ID::Metadata GetMetadata() const final;
+
+  // nested types ----------------------------------------------------
+
+  // accessors -------------------------------------------------------
+
+  enum : int {
+    kGreetingFieldNumber = 1,
+  };
+  // required string greeting = 1;
+  bool has_greeting() const;
+  private:
+  bool _internal_has_greeting() const;
+  public:
+  void clear_greeting();
+  const std::string& greeting() const;
+  template <typename ArgT0 = const std::string&, typename... ArgT>
+  void set_greeting(ArgT0&& arg0, ArgT... args);
+  std::string* mutable_greeting();
+  PROTOBUF_NODISCARD std::string* release_greeting();
+  void set_allocated_greeting(std::string* greeting);
+  private:
+  const std::string& _internal_greeting() const;
+  inline PROTOBUF_ALWAYS_INLINE void _internal_set_greeting(const std::string& value);
+  std::string* _internal_mutable_greeting();
+  public:
+
+  // @@protoc_insertion_point(class_scope:my_protocol.Hello)
+ private:
+  class _Internal;
+
+  template <typename T> friend class ::PROTOBUF_NAMESPACE_ID::Arena::InternalHelper;
+  typedef void InternalArenaConstructable_;
+  typedef void DestructorSkippable_;
+  struct Impl_ {
+    ::PROTOBUF_NAMESPACE_ID::internal::HasBits<1> _has_bits_;
+    mutable ::PROTOBUF_NAMESPACE_ID::internal::CachedSize _cached_size_;
+    ::PROTOBUF_NAMESPACE_ID::internal::ArenaStringPtr greeting_;
+  };
+  union { Impl_ _impl_; };
+  friend struct ::TableStruct_my_5fprotocol_2eproto;
+};
+// -------------------------------------------------------------------
+
+class ServerMessage final :
+    public ::PROTOBUF_NAMESPACE_ID::Message /* @@protoc_insertion_point(class_definition:my_protocol.ServerMessage) */ {
+ public:
+  inline ServerMessage() : ServerMessage(nullptr) {}
+  ~ServerMessage() override;
+  explicit PROTOBUF_CONSTEXPR ServerMessage(::PROTOBUF_NAMESPACE_ID::internal::ConstantInitialized);
+
+  ServerMessage(const ServerMessage& from);
+  ServerMessage(ServerMessage&& from) noexcept
+    : ServerMessage() {
+    *this = ::std::move(from);
+  }
+
+  inline ServerMessage& operator=(const ServerMessage& from) {
+    CopyFrom(from);
+    return *this;
+  }
+  inline ServerMessage& operator=(ServerMessage&& from) noexcept {
+    if (this == &from) return *this;
+    if (GetOwningArena() == from.GetOwningArena()
+  #ifdef PROTOBUF_FORCE_COPY_IN_MOVE
+        && GetOwningArena() != nullptr
+  #endif  // !PROTOBUF_FORCE_COPY_IN_MOVE
+    ) {
+      InternalSwap(&from);
+    } else {
+      CopyFrom(from);
+    }
+    return *this;
+  }
+
+  inline const ::PROTOBUF_NAMESPACE_ID::UnknownFieldSet& unknown_fields() const {
+    return _internal_metadata_.unknown_fields<::PROTOBUF_NAMESPACE_ID::UnknownFieldSet>(::PROTOBUF_NAMESPACE_ID::UnknownFieldSet::default_instance);
+  }
+  inline ::PROTOBUF_NAMESPACE_ID::UnknownFieldSet* mutable_unknown_fields() {
+    return _internal_metadata_.mutable_unknown_fields<::PROTOBUF_NAMESPACE_ID::UnknownFieldSet>();
+  }
+
+  static const ::PROTOBUF_NAMESPACE_ID::Descriptor* descriptor() {
+    return GetDescriptor();
+  }
+  static const ::PROTOBUF_NAMESPACE_ID::Descriptor* GetDescriptor() {
+    return default_instance().GetMetadata().descriptor;
+  }
+  static const ::PROTOBUF_NAMESPACE_ID::Reflection* GetReflection() {
+    return default_instance().GetMetadata().reflection;
+  }
+  static const ServerMessage& default_instance() {
+    return *internal_default_instance();
+  }
+  static inline const ServerMessage* internal_default_instance() {
+    return reinterpret_cast<const ServerMessage*>(
+               &_ServerMessage_default_instance_);
+  }
+  static constexpr int kIndexInFileMessages =
+    1;
+
+  friend void swap(ServerMessage& a, ServerMessage& b) {
+    a.Swap(&b);
+  }
+  inline void Swap(ServerMessage* other) {
+    if (other == this) return;
+  #ifdef PROTOBUF_FORCE_COPY_IN_SWAP
+    if (GetOwningArena() != nullptr &&
+        GetOwningArena() == other->GetOwningArena()) {
+   #else  // PROTOBUF_FORCE_COPY_IN_SWAP
+    if (GetOwningArena() == other->GetOwningArena()) {
+  #endif  // !PROTOBUF_FORCE_COPY_IN_SWAP
+      InternalSwap(other);
+    } else {
+      ::PROTOBUF_NAMESPACE_ID::internal::GenericSwap(this, other);
+    }
+  }
+  void UnsafeArenaSwap(ServerMessage* other) {
+    if (other == this) return;
+    GOOGLE_DCHECK(GetOwningArena() == other->GetOwningArena());
+    InternalSwap(other);
+  }
+
+  // implements Message ----------------------------------------------
+
+  ServerMessage* New(::PROTOBUF_NAMESPACE_ID::Arena* arena = nullptr) const final {
+    return CreateMaybeMessage<ServerMessage>(arena);
+  }
+  using ::PROTOBUF_NAMESPACE_ID::Message::CopyFrom;
+  void CopyFrom(const ServerMessage& from);
+  using ::PROTOBUF_NAMESPACE_ID::Message::MergeFrom;
+  void MergeFrom( const ServerMessage& from) {
+    ServerMessage::MergeImpl(*this, from);
+  }
+  private:
+  static void MergeImpl(::PROTOBUF_NAMESPACE_ID::Message& to_msg, const ::PROTOBUF_NAMESPACE_ID::Message& from_msg);
+  public:
+  PROTOBUF_ATTRIBUTE_REINITIALIZES void Clear() final;
+  bool IsInitialized() const final;
+
+  size_t ByteSizeLong() const final;
+  const char* _InternalParse(const char* ptr, ::PROTOBUF_NAMESPACE_ID::internal::ParseContext* ctx) final;
+  uint8_t* _InternalSerialize(
+      uint8_t* target, ::PROTOBUF_NAMESPACE_ID::io::EpsCopyOutputStream* stream) const final;
+  int GetCachedSize() const final { return _impl_._cached_size_.Get(); }
+
+  private:
+  void SharedCtor(::PROTOBUF_NAMESPACE_ID::Arena* arena, bool is_message_owned);
+  void SharedDtor();
+  void SetCachedSize(int size) const final;
+  void InternalSwap(ServerMessage* other);
+
+  private:
+  friend class ::PROTOBUF_NAMESPACE_ID::internal::AnyMetadata;
+  static ::PROTOBUF_NAMESPACE_ID::StringPiece FullMessageName() {
+    return "my_protocol.ServerMessage";
+  }
+  protected:
+  explicit ServerMessage(::PROTOBUF_NAMESPACE_ID::Arena* arena,
+                       bool is_message_owned = false);
+  public:
+
+  static const ClassData _class_data_;
+  const ::PROTOBUF_NAMESPACE_ID::Message::ClassData*GetClassData() const final;
+
+  ::PROTOBUF_NAMESPACE_ID::Metadata GetMetadata() const final;
+
+  // nested types ----------------------------------------------------
+
+  // accessors -------------------------------------------------------
+
+  enum : int {
+    kHelloFieldNumber = 1,
+  };
+  // optional .my_protocol.Hello hello = 1;
+  bool has_hello() const;
+  private:
+  bool _internal_has_hello() const;
+  public:
+  void clear_hello();
+  const ::my_protocol::Hello& hello() const;
+  PROTOBUF_NODISCARD ::my_protocol::Hello* release_hello();
+  ::my_protocol::Hello* mutable_hello();
+  void set_allocated_hello(::my_protocol::Hello* hello);
+  private:
+  const ::my_protocol::Hello& _internal_hello() const;
+  ::my_protocol::Hello* _internal_mutable_hello();
+  public:
+  void unsafe_arena_set_allocated_hello(
+      ::my_protocol::Hello* hello);
+  ::my_protocol::Hello* unsafe_arena_release_hello();
+
+  // @@protoc_insertion_point(class_scope:my_protocol.ServerMessage)
+ private:
+  class _Internal;
+
+  template <typename T> friend class ::PROTOBUF_NAMESPACE_ID::Arena::InternalHelper;
+  typedef void InternalArenaConstructable_;
+  typedef void DestructorSkippable_;
+  struct Impl_ {
+    ::PROTOBUF_NAMESPACE_ID::internal::HasBits<1> _has_bits_;
+    mutable ::PROTOBUF_NAMESPACE_ID::internal::CachedSize _cached_size_;
+    ::my_protocol::Hello* hello_;
+  };
+  union { Impl_ _impl_; };
+  friend struct ::TableStruct_my_5fprotocol_2eproto;
+};
+// -------------------------------------------------------------------
+
+class ClientMessage final :
+    public ::PROTOBUF_NAMESPACE_ID::Message /* @@protoc_insertion_point(class_definition:my_protocol.ClientMessage) */ {
+ public:
+  inline ClientMessage() : ClientMessage(nullptr) {}
+  ~ClientMessage() override;
+  explicit PROTOBUF_CONSTEXPR ClientMessage(::PROTOBUF_NAMESPACE_ID::internal::ConstantInitialized);
+
+  ClientMessage(const ClientMessage& from);
+  ClientMessage(ClientMessage&& from) noexcept
+    : ClientMessage() {
+    *this = ::std::move(from);
+  }
+
+  inline ClientMessage& operator=(const ClientMessage& from) {
+    CopyFrom(from);
+    return *this;
+  }
+  inline ClientMessage& operator=(ClientMessage&& from) noexcept {
+    if (this == &from) return *this;
+    if (GetOwningArena() == from.GetOwningArena()
+  #ifdef PROTOBUF_FORCE_COPY_IN_MOVE
+        && GetOwningArena() != nullptr
+  #endif  // !PROTOBUF_FORCE_COPY_IN_MOVE
+    ) {
+      InternalSwap(&from);
+    } else {
+      CopyFrom(from);
+    }
+    return *this;
+  }
+
+  inline const ::PROTOBUF_NAMESPACE_ID::UnknownFieldSet& unknown_fields() const {
+    return _internal_metadata_.unknown_fields<::PROTOBUF_NAMESPACE_ID::UnknownFieldSet>(::PROTOBUF_NAMESPACE_ID::UnknownFieldSet::default_instance);
+  }
+  inline ::PROTOBUF_NAMESPACE_ID::UnknownFieldSet* mutable_unknown_fields() {
+    return _internal_metadata_.mutable_unknown_fields<::PROTOBUF_NAMESPACE_ID::UnknownFieldSet>();
+  }
+
+  static const ::PROTOBUF_NAMESPACE_ID::Descriptor* descriptor() {
+    return GetDescriptor();
+  }
+  static const ::PROTOBUF_NAMESPACE_ID::Descriptor* GetDescriptor() {
+    return default_instance().GetMetadata().descriptor;
+  }
+  static const ::PROTOBUF_NAMESPACE_ID::Reflection* GetReflection() {
+    return default_instance().GetMetadata().reflection;
+  }
+  static const ClientMessage& default_instance() {
+    return *internal_default_instance();
+  }
+  static inline const ClientMessage* internal_default_instance() {
+    return reinterpret_cast<const ClientMessage*>(
+               &_ClientMessage_default_instance_);
+  }
+  static constexpr int kIndexInFileMessages =
+    2;
+
+  friend void swap(ClientMessage& a, ClientMessage& b) {
+    a.Swap(&b);
+  }
+  inline void Swap(ClientMessage* other) {
+    if (other == this) return;
+  #ifdef PROTOBUF_FORCE_COPY_IN_SWAP
+    if (GetOwningArena() != nullptr &&
+        GetOwningArena() == other->GetOwningArena()) {
+   #else  // PROTOBUF_FORCE_COPY_IN_SWAP
+    if (GetOwningArena() == other->GetOwningArena()) {
+  #endif  // !PROTOBUF_FORCE_COPY_IN_SWAP
+      InternalSwap(other);
+    } else {
+      ::PROTOBUF_NAMESPACE_ID::internal::GenericSwap(this, other);
+    }
+  }
+  void UnsafeArenaSwap(ClientMessage* other) {
+    if (other == this) return;
+    GOOGLE_DCHECK(GetOwningArena() == other->GetOwningArena());
+    InternalSwap(other);
+  }
+
+  // implements Message ----------------------------------------------
+
+  ClientMessage* New(::PROTOBUF_NAMESPACE_ID::Arena* arena = nullptr) const final {
+    return CreateMaybeMessage<ClientMessage>(arena);
+  }
+  using ::PROTOBUF_NAMESPACE_ID::Message::CopyFrom;
+  void CopyFrom(const ClientMessage& from);
+  using ::PROTOBUF_NAMESPACE_ID::Message::MergeFrom;
+  void MergeFrom( const ClientMessage& from) {
+    ClientMessage::MergeImpl(*this, from);
+  }
+  private:
+  static void MergeImpl(::PROTOBUF_NAMESPACE_ID::Message& to_msg, const ::PROTOBUF_NAMESPACE_ID::Message& from_msg);
+  public:
+  PROTOBUF_ATTRIBUTE_REINITIALIZES void Clear() final;
+  bool IsInitialized() const final;
+
+  size_t ByteSizeLong() const final;
+  const char* _InternalParse(const char* ptr, ::PROTOBUF_NAMESPACE_ID::internal::ParseContext* ctx) final;
+  uint8_t* _InternalSerialize(
+      uint8_t* target, ::PROTOBUF_NAMESPACE_ID::io::EpsCopyOutputStream* stream) const final;
+  int GetCachedSize() const final { return _impl_._cached_size_.Get(); }
+
+  private:
+  void SharedCtor(::PROTOBUF_NAMESPACE_ID::Arena* arena, bool is_message_owned);
+  void SharedDtor();
+  void SetCachedSize(int size) const final;
+  void InternalSwap(ClientMessage* other);
+
+  private:
+  friend class ::PROTOBUF_NAMESPACE_ID::internal::AnyMetadata;
+  static ::PROTOBUF_NAMESPACE_ID::StringPiece FullMessageName() {
+    return "my_protocol.ClientMessage";
+  }
+  protected:
+  explicit ClientMessage(::PROTOBUF_NAMESPACE_ID::Arena* arena,
+                       bool is_message_owned = false);
+  public:
+
+  static const ClassData _class_data_;
+  const ::PROTOBUF_NAMESPACE_ID::Message::ClassData*GetClassData() const final;
+
+  ::PROTOBUF_NAMESPACE_ID::Metadata GetMetadata() const final;
+
+  // nested types ----------------------------------------------------
+
+  // accessors -------------------------------------------------------
+
+  enum : int {
+    kHelloFieldNumber = 1,
+  };
+  // optional .my_protocol.Hello hello = 1;
+  bool has_hello() const;
+  private:
+  bool _internal_has_hello() const;
+  public:
+  void clear_hello();
+  const ::my_protocol::Hello& hello() const;
+  PROTOBUF_NODISCARD ::my_protocol::Hello* release_hello();
+  ::my_protocol::Hello* mutable_hello();
+  void set_allocated_hello(::my_protocol::Hello* hello);
+  private:
+  const ::my_protocol::Hello& _internal_hello() const;
+  ::my_protocol::Hello* _internal_mutable_hello();
+  public:
+  void unsafe_arena_set_allocated_hello(
+      ::my_protocol::Hello* hello);
+  ::my_protocol::Hello* unsafe_arena_release_hello();
+
+  // @@protoc_insertion_point(class_scope:my_protocol.ClientMessage)
+ private:
+  class _Internal;
+
+  template <typename T> friend class ::PROTOBUF_NAMESPACE_ID::Arena::InternalHelper;
+  typedef void InternalArenaConstructable_;
+  typedef void DestructorSkippable_;
+  struct Impl_ {
+    ::PROTOBUF_NAMESPACE_ID::internal::HasBits<1> _has_bits_;
+    mutable ::PROTOBUF_NAMESPACE_ID::internal::CachedSize _cached_size_;
+    ::my_protocol::Hello* hello_;
+  };
+  union { Impl_ _impl_; };
+  friend struct ::TableStruct_my_5fprotocol_2eproto;
+};
+// ===================================================================
+
+
+// ===================================================================
+
+#ifdef __GNUC__
+  #pragma GCC diagnostic push
+  #pragma GCC diagnostic ignored "-Wstrict-aliasing"
+#endif  // __GNUC__
+// Hello
+
+// required string greeting = 1;
+inline bool Hello::_internal_has_greeting() const {
+  bool value = (_impl_._has_bits_[0] & 0x00000001u) != 0;
+  return value;
+}
+inline bool Hello::has_greeting() const {
+  return _internal_has_greeting();
+}
+inline void Hello::clear_greeting() {
+  _impl_.greeting_.ClearToEmpty();
+  _impl_._has_bits_[0] &= ~0x00000001u;
+}
+inline const std::string& Hello::greeting() const {
+  // @@protoc_insertion_point(field_get:my_protocol.Hello.greeting)
+  return _internal_greeting();
+}
+template <typename ArgT0, typename... ArgT>
+inline PROTOBUF_ALWAYS_INLINE
+void Hello::set_greeting(ArgT0&& arg0, ArgT... args) {
+ _impl_._has_bits_[0] |= 0x00000001u;
+ _impl_.greeting_.Set(static_cast<ArgT0 &&>(arg0), args..., GetArenaForAllocation());
+  // @@protoc_insertion_point(field_set:my_protocol.Hello.greeting)
+}
+inline std::string* Hello::mutable_greeting() {
+  std::string* _s = _internal_mutable_greeting();
+  // @@protoc_insertion_point(field_mutable:my_protocol.Hello.greeting)
+  return _s;
+}
+inline const std::string& Hello::_internal_greeting() const {
+  return _impl_.greeting_.Get();
+}
+inline void Hello::_internal_set_greeting(const std::string& value) {
+  _impl_._has_bits_[0] |= 0x00000001u;
+  _impl_.greeting_.Set(value, GetArenaForAllocation());
+}
+inline std::string* Hello::_internal_mutable_greeting() {
+  _impl_._has_bits_[0] |= 0x00000001u;
+  return _impl_.greeting_.Mutable(GetArenaForAllocation());
+}
+inline std::string* Hello::release_greeting() {
+  // @@protoc_insertion_point(field_release:my_protocol.Hello.greeting)
+  if (!_internal_has_greeting()) {
+    return nullptr;
+  }
+  _impl_._has_bits_[0] &= ~0x00000001u;
+  auto* p = _impl_.greeting_.Release();
+#ifdef PROTOBUF_FORCE_COPY_DEFAULT_STRING
+  if (_impl_.greeting_.IsDefault()) {
+    _impl_.greeting_.Set("", GetArenaForAllocation());
+  }
+#endif // PROTOBUF_FORCE_COPY_DEFAULT_STRING
+  return p;
+}
+inline void Hello::set_allocated_greeting(std::string* greeting) {
+  if (greeting != nullptr) {
+    _impl_._has_bits_[0] |= 0x00000001u;
+  } else {
+    _impl_._has_bits_[0] &= ~0x00000001u;
+  }
+  _impl_.greeting_.SetAllocated(greeting, GetArenaForAllocation());
+#ifdef PROTOBUF_FORCE_COPY_DEFAULT_STRING
+  if (_impl_.greeting_.IsDefault()) {
+    _impl_.greeting_.Set("", GetArenaForAllocation());
+  }
+#endif // PROTOBUF_FORCE_COPY_DEFAULT_STRING
+  // @@protoc_insertion_point(field_set_allocated:my_protocol.Hello.greeting)
+}
+
+// -------------------------------------------------------------------
+
+// ServerMessage
+
+// optional .my_protocol.Hello hello = 1;
+inline bool ServerMessage::_internal_has_hello() const {
+  bool value = (_impl_._has_bits_[0] & 0x00000001u) != 0;
+  PROTOBUF_ASSUME(!value || _impl_.hello_ != nullptr);
+  return value;
+}
+inline bool ServerMessage::has_hello() const {
+  return _internal_has_hello();
+}
+inline void ServerMessage::clear_hello() {
+  if (_impl_.hello_ != nullptr) _impl_.hello_->Clear();
+  _impl_._has_bits_[0] &= ~0x00000001u;
+}
+inline const ::my_protocol::Hello& ServerMessage::_internal_hello() const {
+  const ::my_protocol::Hello* p = _impl_.hello_;
+  return p != nullptr ? *p : reinterpret_cast<const ::my_protocol::Hello&>(
+      ::my_protocol::_Hello_default_instance_);
+}
+inline const ::my_protocol::Hello& ServerMessage::hello() const {
+  // @@protoc_insertion_point(field_get:my_protocol.ServerMessage.hello)
+  return _internal_hello();
+}
+inline void ServerMessage::unsafe_arena_set_allocated_hello(
+    ::my_protocol::Hello* hello) {
+  if (GetArenaForAllocation() == nullptr) {
+    delete reinterpret_cast<::PROTOBUF_NAMESPACE_ID::MessageLite*>(_impl_.hello_);
+  }
+  _impl_.hello_ = hello;
+  if (hello) {
+    _impl_._has_bits_[0] |= 0x00000001u;
+  } else {
+    _impl_._has_bits_[0] &= ~0x00000001u;
+  }
+  // @@protoc_insertion_point(field_unsafe_arena_set_allocated:my_protocol.ServerMessage.hello)
+}
+inline ::my_protocol::Hello* ServerMessage::release_hello() {
+  _impl_._has_bits_[0] &= ~0x00000001u;
+  ::my_protocol::Hello* temp = _impl_.hello_;
+  _impl_.hello_ = nullptr;
+#ifdef PROTOBUF_FORCE_COPY_IN_RELEASE
+  auto* old =  reinterpret_cast<::PROTOBUF_NAMESPACE_ID::MessageLite*>(temp);
+  temp = ::PROTOBUF_NAMESPACE_ID::internal::DuplicateIfNonNull(temp);
+  if (GetArenaForAllocation() == nullptr) { delete old; }
+#else  // PROTOBUF_FORCE_COPY_IN_RELEASE
+  if (GetArenaForAllocation() != nullptr) {
+    temp = ::PROTOBUF_NAMESPACE_ID::internal::DuplicateIfNonNull(temp);
+  }
+#endif  // !PROTOBUF_FORCE_COPY_IN_RELEASE
+  return temp;
+}
+inline ::my_protocol::Hello* ServerMessage::unsafe_arena_release_hello() {
+  // @@protoc_insertion_point(field_release:my_protocol.ServerMessage.hello)
+  _impl_._has_bits_[0] &= ~0x00000001u;
+  ::my_protocol::Hello* temp = _impl_.hello_;
+  _impl_.hello_ = nullptr;
+  return temp;
+}
+inline ::my_protocol::Hello* ServerMessage::_internal_mutable_hello() {
+  _impl_._has_bits_[0] |= 0x00000001u;
+  if (_impl_.hello_ == nullptr) {
+    auto* p = CreateMaybeMessage<::my_protocol::Hello>(GetArenaForAllocation());
+    _impl_.hello_ = p;
+  }
+  return _impl_.hello_;
+}
+inline ::my_protocol::Hello* ServerMessage::mutable_hello() {
+  ::my_protocol::Hello* _msg = _internal_mutable_hello();
+  // @@protoc_insertion_point(field_mutable:my_protocol.ServerMessage.hello)
+  return _msg;
+}
+inline void ServerMessage::set_allocated_hello(::my_protocol::Hello* hello) {
+  ::PROTOBUF_NAMESPACE_ID::Arena* message_arena = GetArenaForAllocation();
+  if (message_arena == nullptr) {
+    delete _impl_.hello_;
+  }
+  if (hello) {
+    ::PROTOBUF_NAMESPACE_ID::Arena* submessage_arena =
+        ::PROTOBUF_NAMESPACE_ID::Arena::InternalGetOwningArena(hello);
+    if (message_arena != submessage_arena) {
+      hello = ::PROTOBUF_NAMESPACE_ID::internal::GetOwnedMessage(
+          message_arena, hello, submessage_arena);
+    }
+    _impl_._has_bits_[0] |= 0x00000001u;
+  } else {
+    _impl_._has_bits_[0] &= ~0x00000001u;
+  }
+  _impl_.hello_ = hello;
+  // @@protoc_insertion_point(field_set_allocated:my_protocol.ServerMessage.hello)
+}
+
+// -------------------------------------------------------------------
+
+// ClientMessage
+
+// optional .my_protocol.Hello hello = 1;
+inline bool ClientMessage::_internal_has_hello() const {
+  bool value = (_impl_._has_bits_[0] & 0x00000001u) != 0;
+  PROTOBUF_ASSUME(!value || _impl_.hello_ != nullptr);
+  return value;
+}
+inline bool ClientMessage::has_hello() const {
+  return _internal_has_hello();
+}
+inline void ClientMessage::clear_hello() {
+  if (_impl_.hello_ != nullptr) _impl_.hello_->Clear();
+  _impl_._has_bits_[0] &= ~0x00000001u;
+}
+inline const ::my_protocol::Hello& ClientMessage::_internal_hello() const {
+  const ::my_protocol::Hello* p = _impl_.hello_;
+  return p != nullptr ? *p : reinterpret_cast<const ::my_protocol::Hello&>(
+      ::my_protocol::_Hello_default_instance_);
+}
+inline const ::my_protocol::Hello& ClientMessage::hello() const {
+  // @@protoc_insertion_point(field_get:my_protocol.ClientMessage.hello)
+  return _internal_hello();
+}
+inline void ClientMessage::unsafe_arena_set_allocated_hello(
+    ::my_protocol::Hello* hello) {
+  if (GetArenaForAllocation() == nullptr) {
+    delete reinterpret_cast<::PROTOBUF_NAMESPACE_ID::MessageLite*>(_impl_.hello_);
+  }
+  _impl_.hello_ = hello;
+  if (hello) {
+    _impl_._has_bits_[0] |= 0x00000001u;
+  } else {
+    _impl_._has_bits_[0] &= ~0x00000001u;
+  }
+  // @@protoc_insertion_point(field_unsafe_arena_set_allocated:my_protocol.ClientMessage.hello)
+}
+inline ::my_protocol::Hello* ClientMessage::release_hello() {
+  _impl_._has_bits_[0] &= ~0x00000001u;
+  ::my_protocol::Hello* temp = _impl_.hello_;
+  _impl_.hello_ = nullptr;
+#ifdef PROTOBUF_FORCE_COPY_IN_RELEASE
+  auto* old =  reinterpret_cast<::PROTOBUF_NAMESPACE_ID::MessageLite*>(temp);
+  temp = ::PROTOBUF_NAMESPACE_ID::internal::DuplicateIfNonNull(temp);
+  if (GetArenaForAllocation() == nullptr) { delete old; }
+#else  // PROTOBUF_FORCE_COPY_IN_RELEASE
+  if (GetArenaForAllocation() != nullptr) {
+    temp = ::PROTOBUF_NAMESPACE_ID::internal::DuplicateIfNonNull(temp);
+  }
+#endif  // !PROTOBUF_FORCE_COPY_IN_RELEASE
+  return temp;
+}
+inline ::my_protocol::Hello* ClientMessage::unsafe_arena_release_hello() {
+  // @@protoc_insertion_point(field_release:my_protocol.ClientMessage.hello)
+  _impl_._has_bits_[0] &= ~0x00000001u;
+  ::my_protocol::Hello* temp = _impl_.hello_;
+  _impl_.hello_ = nullptr;
+  return temp;
+}
+inline ::my_protocol::Hello* ClientMessage::_internal_mutable_hello() {
+  _impl_._has_bits_[0] |= 0x00000001u;
+  if (_impl_.hello_ == nullptr) {
+    auto* p = CreateMaybeMessage<::my_protocol::Hello>(GetArenaForAllocation());
+    _impl_.hello_ = p;
+  }
+  return _impl_.hello_;
+}
+inline ::my_protocol::Hello* ClientMessage::mutable_hello() {
+  ::my_protocol::Hello* _msg = _internal_mutable_hello();
+  // @@protoc_insertion_point(field_mutable:my_protocol.ClientMessage.hello)
+  return _msg;
+}
+inline void ClientMessage::set_allocated_hello(::my_protocol::Hello* hello) {
+  ::PROTOBUF_NAMESPACE_ID::Arena* message_arena = GetArenaForAllocation();
+  if (message_arena == nullptr) {
+    delete _impl_.hello_;
+  }
+  if (hello) {
+    ::PROTOBUF_NAMESPACE_ID::Arena* submessage_arena =
+        ::PROTOBUF_NAMESPACE_ID::Arena::InternalGetOwningArena(hello);
+    if (message_arena != submessage_arena) {
+      hello = ::PROTOBUF_NAMESPACE_ID::internal::GetOwnedMessage(
+          message_arena, hello, submessage_arena);
+    }
+    _impl_._has_bits_[0] |= 0x00000001u;
+  } else {
+    _impl_._has_bits_[0] &= ~0x00000001u;
+  }
+  _impl_.hello_ = hello;
+  // @@protoc_insertion_point(field_set_allocated:my_protocol.ClientMessage.hello)
+}
+
+#ifdef __GNUC__
+  #pragma GCC diagnostic pop
+#endif  // __GNUC__
+// -------------------------------------------------------------------
+
+// -------------------------------------------------------------------
+
+
+// @@protoc_insertion_point(namespace_scope)
+
+}  // namespace my_protocol
+
+// @@protoc_insertion_point(global_scope)
+
+#include <google/protobuf/port_undef.inc>
+#endif  // GOOGLE_PROTOBUF_INCLUDED_GOOGLE_PROTOBUF_INCLUDED_my_5fprotocol_2eproto
@@ -13,7 +13,7 @@ public:
 
 class MyServer : public prototls::Server<MyPeer> {
     public:
-        // start 8 threads to perform TLS handshakes simultaneously
+        // use up to 8 threads to perform TLS handshakes simultaneously
         MyServer() : prototls::Server<MyPeer>(8) {}
 
         void onPacket(MyPeer&p) {
@@ -46,6 +46,14 @@ int main(int argc, char** argv) {
 
     MyServer server;
 
+    // counters in the Prometheus text format at http://127.0.0.1:9234/
+    server.serveMetrics(9234);
+    // with timings of the handlers, and a log of those taking 10 ms
+    server.setTiming(true, 10000);
+    // stop reading from peers while their buffers hold 64 MB in
+    // total or 1 MB for one peer
+    server.setMemoryBudget(64 << 20, 1 << 20);
+
     // encryption on, serve on port 1234 for at most 1024 peers
     server.serve(true, 1234, 1024);  
     return 0;
@@ -5,10 +5,20 @@
 #ifndef _prototls_hpp_
 #define _prototls_hpp_
 #include "prototls/Common.hpp"
+#include "prototls/Probes.hpp"
 #include "prototls/Socket.hpp"
 #include "prototls/TLSSocket.hpp"
+#include "prototls/MemorySocket.hpp"
 #include "prototls/Select.hpp"
+#include "prototls/Poll.hpp"
+#include "prototls/EPoll.hpp"
 #include "prototls/TSDeque.hpp"
+#include "prototls/Metrics.hpp"
+#include "prototls/Capture.hpp"
+#include "prototls/BufferPool.hpp"
+#include "prototls/TimerWheel.hpp"
 #include "prototls/Peer.hpp"
 #include "prototls/Server.hpp"
+#include "prototls/Client.hpp"
+#include "prototls/ClientPool.hpp"
 #endif
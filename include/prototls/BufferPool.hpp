@@ -0,0 +1,56 @@
+/** prototls - Portable asynchronous client/server communications C++ library
+
+     See LICENSE for copyright information.
+*/
+#ifndef _prototls_bufferpool_hpp_
+#define _prototls_bufferpool_hpp_
+#include <string>
+#include <vector>
+namespace prototls {
+    /** Keeps the storage of drained peer buffers. A peer gives a
+      buffer back when it becomes empty, so that idle peers hold no
+      buffer memory, and takes one when data arrives, so that busy
+      peers do not allocate for every message. Not thread safe: share
+      a pool only among the peers run by one thread. */
+    class BufferPool {
+        /** empty buffers that have storage */
+        std::vector<std::string> buffers;
+
+        /** the maximum bytes of storage kept */
+        size_t maxHeld;
+
+        /** buffers with more storage are freed instead of kept, so
+          that a burst does not leave large buffers behind */
+        size_t maxCapacity;
+
+        /** the bytes of storage of the buffers kept */
+        size_t held;
+
+        /** the capacity of a string without storage of its own */
+        static const size_t inlineCapacity;
+    public:
+        /** \param maxHeld the maximum bytes of storage kept
+         \param maxCapacity the largest buffer kept, in bytes */
+        BufferPool(size_t maxHeld = 4 * 1024 * 1024,
+                size_t maxCapacity = 256 * 1024);
+
+        /** gives a buffer the storage of a kept one, unless it has
+          storage already or none is kept */
+        void take(std::string& buf);
+
+        /** empties a buffer and takes its storage, leaving the
+          buffer without storage */
+        void give(std::string& buf);
+
+        /** \return the number of buffers kept */
+        size_t size() const {
+            return buffers.size();
+        }
+
+        /** \return the bytes of storage of the buffers kept */
+        size_t getHeld() const {
+            return held;
+        }
+    };
+}
+#endif
@@ -0,0 +1,117 @@
+/** prototls - Portable asynchronous client/server communications C++ library
+
+     See LICENSE for copyright information.
+*/
+#ifndef _prototls_capture_hpp_
+#define _prototls_capture_hpp_
+#include "prototls/Common.hpp"
+#include <boost/thread/mutex.hpp>
+#include <cstdio>
+#include <string>
+namespace prototls {
+    /** a record of a capture file */
+    struct CaptureRecord {
+        /** record kinds */
+        enum Kind {
+            /** a message received from the connection */
+            Frame = 0,
+            /** the connection was opened */
+            Open = 1,
+            /** the connection was closed */
+            Close = 2
+        };
+
+        /** microseconds from the start of the capture */
+        uint64_t time;
+
+        /** the connection, numbered from 0 in the order opened */
+        uint32_t connection;
+
+        /** the kind of the record */
+        Kind kind;
+
+        /** the serialized message of a Frame */
+        std::string data;
+    };
+
+    /** Writes the messages received by peers to a file, with the time
+      they arrived, to be replayed later (see bench/replay.cpp). Records
+      are only appended; a record takes the message and a few bytes, as
+      the time since the previous record, the connection and the size
+      are stored as variable-length integers. Thread safe. The
+      records are buffered, so a crashed process leaves the last ones
+      out. */
+    class CaptureFile {
+        boost::mutex monitor;
+
+        /** the file */
+        FILE* file;
+
+        /** the time of the previous record (see monotonicMicros) */
+        uint64_t last;
+
+        /** writes a variable-length integer, 7 bits per byte */
+        void writeNumber(uint64_t n);
+
+        /** writes the header of a record */
+        void writeHeader(uint32_t connection, CaptureRecord::Kind kind);
+
+        /** declared but not defined to prevent copying */
+        CaptureFile(const CaptureFile& c);
+
+        /** declared but not defined to prevent copying */
+        CaptureFile& operator=(const CaptureFile& c);
+    public:
+        /** creates a capture file, replacing an existing one
+         \throw SocketExcept if the file cannot be created */
+        CaptureFile(const std::string& path);
+
+        /** flushes and closes the file */
+        ~CaptureFile();
+
+        /** records that a connection was opened */
+        void open(uint32_t connection);
+
+        /** records a message received from a connection */
+        void frame(uint32_t connection, const void* data, size_t size);
+
+        /** records that a connection was closed */
+        void close(uint32_t connection);
+
+        /** writes the buffered records to the file */
+        void flush();
+    };
+
+    /** reads a file written by CaptureFile */
+    class CaptureReader {
+        /** the file */
+        FILE* file;
+
+        /** the time of the previous record */
+        uint64_t time;
+
+        /** reads a variable-length integer
+         \return false at the end of the file */
+        bool readNumber(uint64_t& n);
+
+        /** declared but not defined to prevent copying */
+        CaptureReader(const CaptureReader& c);
+
+        /** declared but not defined to prevent copying */
+        CaptureReader& operator=(const CaptureReader& c);
+    public:
+        /** opens a capture file
+         \throw SocketExcept if the file cannot be opened or is not a
+         capture file */
+        CaptureReader(const std::string& path);
+
+        /** closes the file */
+        ~CaptureReader();
+
+        /** reads the next record
+         \return false at the end of the file, or if the rest of it
+         is truncated */
+        bool next(CaptureRecord& r);
+    };
+}
+#endif
@@ -0,0 +1,369 @@
+/** prototls - Portable asynchronous client/server communications C++ library
+
+     See LICENSE for copyright information.
+*/
+#ifndef _prototls_client_hpp_
+#define _prototls_client_hpp_
+#include "prototls/Common.hpp"
+#include "prototls/Socket.hpp"
+#include "prototls/TLSSocket.hpp"
+#include "prototls/Peer.hpp"
+#include "prototls/Select.hpp"
+#include <boost/smart_ptr.hpp>
+#include <iostream>
+#include <vector>
+#include <string>
+#include <algorithm>
+namespace prototls {
+    /** Client class template for implementing asynchronous clients
+        that send and receive protobuf messages with/without encrypted
+        communication. Any number of outbound connections share
+        one non-blocking event loop: connecting and TLS handshakes
+        do not block the loop, and lost connections are reestablished
+        with exponential backoff. The peer object of a connection is
+        kept over reconnections. */
+    template <class PeerT>
+        class Client {
+            /** connection states */
+            enum State {
+                /** waiting for the next connection attempt */
+                Waiting,
+                /** TCP connection is in progress */
+                Connecting,
+                /** TLS handshake is in progress */
+                Handshaking,
+                /** connected, packets are exchanged through the peer */
+                Connected
+            };
+
+            /** an outbound connection */
+            struct Connection {
+                /** remote address */
+                std::string addr;
+
+                /** remote port */
+                int port;
+
+                /** current state of the connection */
+                State state;
+
+                /** the peer that owns the socket when connected */
+                boost::shared_ptr<PeerT> peer;
+
+                /** socket that is connecting or handshaking, handed
+                  over to the peer when connected */
+                Socket* sock;
+
+                /** true if the handshake waits for the socket to be
+                  writable instead of readable */
+                bool wantWrite;
+
+                /** the delay in milliseconds before the next
+                  connection attempt */
+                int backoff;
+
+                /** the time of the next connection attempt when waiting,
+                  otherwise the time when connecting times out */
+                uint64_t deadline;
+
+                /** true if the connection has been removed with
+                  Client::disconnect */
+                bool removed;
+
+                /** closes the socket if still connecting */
+                ~Connection() {
+                    if (sock) {
+                        sock->Socket::close();
+                        delete sock;
+                    }
+                }
+            };
+
+            /** connections are stored in a vector holding
+              boost shared pointers to simplify memory management */
+            typedef std::vector< boost::shared_ptr<Connection> > Connections;
+
+            /** outbound connections */
+            Connections conns;
+
+            /** use GnuTLS for encryption */
+            bool tls;
+
+            /** the delay in milliseconds before the first reconnection
+              attempt */
+            int minBackoff;
+
+            /** upper limit for the reconnection delay in milliseconds */
+            int maxBackoff;
+
+            /** maximum time in milliseconds for connecting and
+              TLS handshake */
+            int timeout;
+
+            /** flag marking that the client has been closed */
+            bool closed;
+
+            /** this method is called when a peer can read a packet */
+            virtual void onPacket(PeerT&p) = 0;
+
+            /** this method is called when a connection has been
+              established (after TLS handshake if encrypted communication
+              is used) */
+            virtual void onJoin(PeerT&p) = 0;
+
+            /** this method is called when an established connection is
+              lost or closed */
+            virtual void onLeave(PeerT& p) = 0;
+
+            /** this method is called after TLS handshake to decide
+              whether to accept the server's certificate
+             \return true if the connection is accepted */
+            virtual bool onVerify(PeerT&,
+                    const TLSSocket::VerifyResult& res) {
+                return !res.distrusted;
+            }
+
+            /** closes the socket being connected and schedules the
+              next connection attempt */
+            void fail(Connection& c, uint64_t now) {
+                if (c.sock) {
+                    // no TLS session to shut down before the handshake
+                    c.sock->Socket::close();
+                    delete c.sock;
+                    c.sock = NULL;
+                }
+                retry(c, now);
+            }
+
+            /** schedules the next connection attempt and doubles
+              the delay for the following one */
+            void retry(Connection& c, uint64_t now) {
+                c.state = Waiting;
+                c.deadline = now + c.backoff;
+                c.backoff = std::min(c.backoff * 2, maxBackoff);
+            }
+
+            /** starts connecting */
+            void start(Connection& c, uint64_t now) {
+                try {
+                    if (tls)
+                        c.sock = new TLSSocket();
+                    else
+                        c.sock = new Socket();
+                    c.state = Connecting;
+                    c.deadline = now + timeout;
+                    bool connected = c.sock->connectAsync(c.addr, c.port);
+                    c.sock->setNoDelay();
+                    if (connected) {
+                        c.state = Handshaking;
+                        handshake(c, now);
+                    }
+                } catch (SocketExcept& e) {
+                    std::cerr << e.what() << std::endl;
+                    fail(c, now);
+                }
+            }
+
+            /** continues TLS handshake and hands the socket over
+              to the peer when done */
+            void handshake(Connection& c, uint64_t now) {
+                int ret = c.sock->tryHandshake(c.wantWrite);
+                if (ret > 0)
+                    return;
+                if (ret < 0) {
+                    fail(c, now);
+                    return;
+                }
+                Socket* s = c.sock;
+                c.sock = NULL;
+                c.peer->setup(s);
+                if (tls) {
+                    TLSSocket::VerifyResult res;
+                    if (static_cast<TLSSocket*>(s)->verify(res)
+                            || !onVerify(*c.peer, res)) {
+                        c.peer->close();
+                        retry(c, now);
+                        return;
+                    }
+                }
+                c.state = Connected;
+                c.backoff = minBackoff;
+                onJoin(*c.peer);
+            }
+
+            /** \return the connection of a peer or NULL */
+            Connection* find(PeerT& p) {
+                for (size_t i = 0; i < conns.size(); i++) {
+                    if (conns[i]->peer.get() == &p)
+                        return conns[i].get();
+                }
+                return NULL;
+            }
+        public:
+            /** initializes an empty client
+             \param tls use GnuTLS for encryption
+             \param minBackoff delay in milliseconds before the first
+             reconnection attempt
+             \param maxBackoff upper limit for the reconnection delay
+             \param timeout maximum time in milliseconds for connecting
+             and TLS handshake */
+            Client(bool tls, int minBackoff = 100, int maxBackoff = 30000,
+                    int timeout = 10000)
+                : tls(tls), minBackoff(minBackoff), maxBackoff(maxBackoff),
+                  timeout(timeout), closed(false) {
+            }
+
+            /** empty destructor */
+            virtual ~Client() {
+            }
+
+            /** adds an outbound connection. Connecting starts when
+              the event loop runs.
+             \param addr remote address
+             \param port remote port
+             \return the peer of the connection */
+            PeerT& connect(const std::string& addr, int port) {
+                boost::shared_ptr<Connection> c(new Connection());
+                c->addr = addr;
+                c->port = port;
+                c->state = Waiting;
+                c->peer.reset(new PeerT());
+                c->sock = NULL;
+                c->wantWrite = false;
+                c->backoff = minBackoff;
+                c->deadline = 0;
+                c->removed = false;
+                conns.push_back(c);
+                return *c->peer;
+            }
+
+            /** closes the connection of a peer and stops reconnecting.
+              The peer is removed (and Client::onLeave called if it
+              was connected) when the event loop runs. */
+            void disconnect(PeerT& p) {
+                Connection* c = find(p);
+                if (c)
+                    c->removed = true;
+            }
+
+            /** \return true if the peer is connected */
+            bool isConnected(PeerT& p) {
+                Connection* c = find(p);
+                return c && c->state == Connected && !c->removed;
+            }
+
+            /** runs one iteration of the event loop: starts due
+              connection attempts, waits at most 'msecs' milliseconds
+              for socket events, continues connecting and handshakes,
+              reads data from connected peers and notifies through
+              virtual methods if packets can be deserialized */
+            void poll(int msecs) {
+                uint64_t now = monotonicMillis();
+                Select select;
+                for (size_t i = 0; i < conns.size(); i++) {
+                    Connection& c = *conns[i];
+                    if (c.removed)
+                        continue;
+                    if (c.state != Connected && now >= c.deadline) {
+                        if (c.state == Waiting)
+                            start(c, now);
+                        else
+                            fail(c, now);
+                    }
+                    switch (c.state) {
+                        case Connecting:
+                            select.output(c.sock->getFd());
+                            break;
+                        case Handshaking:
+                            if (c.wantWrite)
+                                select.output(c.sock->getFd());
+                            else
+                                select.input(c.sock->getFd());
+                            break;
+                        case Connected:
+                            select.input(c.peer->getFd());
+                            if (c.peer->hasOutput())
+                                select.output(c.peer->getFd());
+                            break;
+                        default:
+                            break;
+                    }
+                    if (c.state != Connected) {
+                        uint64_t wait = c.deadline > now ? c.deadline - now : 0;
+                        if (wait < (uint64_t) msecs)
+                            msecs = (int) wait;
+                    }
+                }
+                if (select.select(msecs) == -1)
+                    return;
+                now = monotonicMillis();
+                for (size_t i = 0; i < conns.size(); i++) {
+                    Connection& c = *conns[i];
+                    if (c.removed)
+                        continue;
+                    switch (c.state) {
+                        case Connecting:
+                            if (select.canWrite(c.sock->getFd())) {
+                                if (c.sock->finishConnect()) {
+                                    fail(c, now);
+                                } else {
+                                    c.state = Handshaking;
+                                    handshake(c, now);
+                                }
+                            }
+                            break;
+                        case Handshaking:
+                            if (select.canRead(c.sock->getFd())
+                                    || select.canWrite(c.sock->getFd()))
+                                handshake(c, now);
+                            break;
+                        case Connected:
+                            if (c.peer->hasOutput()
+                                    && select.canWrite(c.peer->getFd()))
+                                c.peer->flush();
+                            if (select.canRead(c.peer->getFd()))
+                                c.peer->onInput();
+                            while (c.peer->hasPacket()) {
+                                onPacket(*c.peer);
+                            }
+                            break;
+                        default:
+                            break;
+                    }
+                }
+                // collect lost and removed connections
+                size_t count = conns.size();
+                for (size_t i = 0; i < count; ) {
+                    Connection& c = *conns[i];
+                    if (c.state == Connected
+                            && (c.removed || !c.peer->isActive())) {
+                        if (c.peer->isActive())
+                            c.peer->close();
+                        onLeave(*c.peer);
+                        retry(c, now);
+                    }
+                    if (c.removed) {
+                        conns[i] = conns[count - 1];
+                        count--;
+                    } else
+                        i++;
+                }
+                if (count < conns.size()) {
+                    conns.resize(count);
+                }
+            }
+
+            /** runs the event loop until Client::close is called */
+            void run() {
+                while (!closed)
+                    poll(100);
+            }
+
+            /** sets the closed-bit to true, and the running
+              Client::run method will exit */
+            void close() {
+                closed = true;
+            }
+        };
+}
+#endif
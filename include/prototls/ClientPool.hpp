@@ -0,0 +1,344 @@
+/** prototls - Portable asynchronous client/server communications C++ library
+
+     See LICENSE for copyright information.
+*/
+#ifndef _prototls_clientpool_hpp_
+#define _prototls_clientpool_hpp_
+#include "prototls/Common.hpp"
+#include "prototls/Client.hpp"
+#include <google/protobuf/message.h>
+#include <boost/smart_ptr.hpp>
+#include <boost/random/linear_congruential.hpp>
+#include <map>
+#include <vector>
+#include <string>
+namespace prototls {
+    /** ClientPool class template for spreading requests over
+        a fleet of servers. The pool holds several connections per
+        server endpoint on one Client event loop and selects the
+        connection for each request by the number of outstanding
+        requests (every packet received from a server is counted as
+        the reply to the oldest outstanding request). Connections that
+        stop replying are evicted and replaced with fresh ones, while
+        connections that cannot be established are retried with
+        backoff by the client and are not selected meanwhile. */
+    template <class PeerT>
+        class ClientPool {
+        public:
+            /** connection selection policies */
+            enum Balancing {
+                /** the connection with the least outstanding requests */
+                LeastOutstanding,
+                /** the less loaded of two randomly chosen connections */
+                PowerOfTwoChoices
+            };
+        private:
+            /** a pooled connection */
+            struct Member {
+                /** the peer of the connection (owned by the client) */
+                PeerT* peer;
+
+                /** index of the server endpoint */
+                size_t endpoint;
+
+                /** the number of requests without reply */
+                size_t outstanding;
+
+                /** the time of the last reply, or the time the first
+                  outstanding request was sent if later */
+                uint64_t progress;
+
+                /** position in 'ready' or -1 if not connected */
+                int readyPos;
+
+                /** true if the connection is being evicted */
+                bool evicted;
+            };
+
+            /** the event loop of the pooled connections forwarding
+              the callbacks to the pool */
+            class Connections : public Client<PeerT> {
+                ClientPool& pool;
+                void onPacket(PeerT& p) {
+                    pool.packet(p);
+                }
+                void onJoin(PeerT& p) {
+                    pool.join(p);
+                }
+                void onLeave(PeerT& p) {
+                    pool.leave(p);
+                }
+                bool onVerify(PeerT& p, const TLSSocket::VerifyResult& res) {
+                    return pool.onVerify(p, res);
+                }
+            public:
+                Connections(ClientPool& pool, bool tls)
+                    : Client<PeerT>(tls), pool(pool) {
+                }
+            };
+
+            /** a server endpoint */
+            struct Endpoint {
+                /** remote address */
+                std::string addr;
+
+                /** remote port */
+                int port;
+            };
+
+            /** pooled connections by peer */
+            typedef std::map<const PeerT*, boost::shared_ptr<Member> > Members;
+
+            /** the event loop of the pooled connections */
+            Connections client;
+
+            /** server endpoints */
+            std::vector<Endpoint> endpoints;
+
+            /** pooled connections */
+            Members members;
+
+            /** connected pooled connections to select from */
+            std::vector<Member*> ready;
+
+            /** connection selection policy */
+            Balancing balancing;
+
+            /** the number of connections per endpoint */
+            size_t perEndpoint;
+
+            /** the time in milliseconds a connection may leave
+              requests without reply before it is evicted */
+            int requestTimeout;
+
+            /** start position of the next selection to spread ties */
+            size_t next;
+
+            /** the generator choosing connections at random, seeded
+              per pool */
+            boost::random::minstd_rand random;
+
+            /** flag marking that the pool has been closed */
+            bool closed;
+
+            /** this method is called when a peer can read a packet */
+            virtual void onPacket(PeerT&p) = 0;
+
+            /** this method is called when a pooled connection has been
+              established */
+            virtual void onJoin(PeerT&p) = 0;
+
+            /** this method is called when an established pooled
+              connection is lost, closed or evicted */
+            virtual void onLeave(PeerT& p) = 0;
+
+            /** this method is called after TLS handshake to decide
+              whether to accept the server's certificate
+             \return true if the connection is accepted */
+            virtual bool onVerify(PeerT&,
+                    const TLSSocket::VerifyResult& res) {
+                return !res.distrusted;
+            }
+
+            /** \return the pooled connection of a peer
+             \throw SocketExcept if the peer is not pooled */
+            Member& member(PeerT& p) {
+                typename Members::iterator i = members.find(&p);
+                if (i == members.end())
+                    throw SocketExcept("Peer is not pooled");
+                return *i->second;
+            }
+
+            /** opens a new connection to an endpoint */
+            void open(size_t endpoint) {
+                boost::shared_ptr<Member> m(new Member());
+                m->peer = &client.connect(endpoints[endpoint].addr,
+                        endpoints[endpoint].port);
+                m->endpoint = endpoint;
+                m->outstanding = 0;
+                m->progress = 0;
+                m->readyPos = -1;
+                m->evicted = false;
+                members[m->peer] = m;
+            }
+
+            /** removes a connection from the selectable connections */
+            void unready(Member& m) {
+                if (m.readyPos < 0)
+                    return;
+                ready[m.readyPos] = ready.back();
+                ready[m.readyPos]->readyPos = m.readyPos;
+                ready.pop_back();
+                m.readyPos = -1;
+            }
+
+            /** closes a connection and opens a replacement to the
+              same endpoint */
+            void evict(Member& m) {
+                if (m.evicted)
+                    return;
+                m.evicted = true;
+                open(m.endpoint);
+                client.disconnect(*m.peer);
+                unready(m);
+            }
+
+            void packet(PeerT& p) {
+                Member& m = member(p);
+                if (m.outstanding > 0)
+                    m.outstanding--;
+                m.progress = monotonicMillis();
+                onPacket(p);
+            }
+
+            void join(PeerT& p) {
+                Member& m = member(p);
+                m.outstanding = 0;
+                m.readyPos = ready.size();
+                ready.push_back(&m);
+                onJoin(p);
+            }
+
+            void leave(PeerT& p) {
+                Member& m = member(p);
+                unready(m);
+                m.outstanding = 0;
+                onLeave(p);
+                if (m.evicted)
+                    members.erase(&p);
+            }
+
+            /** evicts connections that have not replied in time */
+            void checkHealth() {
+                uint64_t now = monotonicMillis();
+                for (size_t i = 0; i < ready.size(); ) {
+                    Member& m = *ready[i];
+                    if (m.outstanding && now - m.progress > (uint64_t) requestTimeout)
+                        evict(m);
+                    else
+                        i++;
+                }
+            }
+        public:
+            /** initializes an empty pool
+             \param tls use GnuTLS for encryption
+             \param perEndpoint the number of connections per endpoint
+             \param balancing connection selection policy
+             \param requestTimeout the time in milliseconds a connection
+             may leave requests without reply before it is evicted */
+            ClientPool(bool tls, size_t perEndpoint,
+                    Balancing balancing = PowerOfTwoChoices,
+                    int requestTimeout = 5000)
+                : client(*this, tls), balancing(balancing),
+                  perEndpoint(perEndpoint), requestTimeout(requestTimeout),
+                  next(0), random((uint32_t) (monotonicMicros()
+                              ^ (uintptr_t) this)), closed(false) {
+            }
+
+            /** empty destructor */
+            virtual ~ClientPool() {
+            }
+
+            /** adds a server endpoint and opens the connections
+              to it. Connecting starts when the event loop runs. */
+            void addEndpoint(const std::string& addr, int port) {
+                Endpoint e;
+                e.addr = addr;
+                e.port = port;
+                endpoints.push_back(e);
+                for (size_t i = 0; i < perEndpoint; i++)
+                    open(endpoints.size() - 1);
+            }
+
+            /** runs the event loop until all connections have been
+              established (including TLS handshakes) or 'msecs'
+              milliseconds have passed
+             \return true if all connections are ready */
+            bool warmup(int msecs) {
+                uint64_t end = monotonicMillis() + msecs;
+                while (ready.size() < members.size()) {
+                    uint64_t now = monotonicMillis();
+                    if (now >= end)
+                        return false;
+                    poll((int) std::min<uint64_t>(end - now, 100));
+                }
+                return true;
+            }
+
+            /** selects a connection for the next request
+             \return the peer or NULL if no connection is ready */
+            PeerT* select() {
+                if (ready.empty())
+                    return NULL;
+                Member* best;
+                if (balancing == PowerOfTwoChoices) {
+                    Member* a = ready[random() % ready.size()];
+                    Member* b = ready[random() % ready.size()];
+                    best = b->outstanding < a->outstanding ? b : a;
+                } else {
+                    size_t n = ready.size();
+                    next = (next + 1) % n;
+                    best = ready[next];
+                    for (size_t i = 1; i < n && best->outstanding; i++) {
+                        Member* m = ready[(next + i) % n];
+                        if (m->outstanding < best->outstanding)
+                            best = m;
+                    }
+                }
+                return best->peer;
+            }
+
+            /** sends a request over the selected connection and counts
+              it outstanding until a packet is received from the peer
+             \return the peer or NULL if no connection is ready */
+            PeerT* send(const google::protobuf::MessageLite& m) {
+                PeerT* p = select();
+                if (!p)
+                    return NULL;
+                Member& mem = member(*p);
+                if (!mem.outstanding)
+                    mem.progress = monotonicMillis();
+                mem.outstanding++;
+                p->send(m);
+                p->flush();
+                return p;
+            }
+
+            /** \return the number of requests without reply on
+              the connection of a peer
+             \throw SocketExcept if the peer is not pooled */
+            size_t outstanding(PeerT& p) {
+                return member(p).outstanding;
+            }
+
+            /** \return the number of pooled connections */
+            size_t size() const {
+                return members.size();
+            }
+
+            /** \return the number of connected pooled connections */
+            size_t readyCount() const {
+                return ready.size();
+            }
+
+            /** runs one iteration of the event loop (see Client::poll)
+              and evicts unhealthy connections */
+            void poll(int msecs) {
+                client.poll(msecs);
+                checkHealth();
+            }
+
+            /** runs the event loop until ClientPool::close is called */
+            void run() {
+                while (!closed)
+                    poll(100);
+            }
+
+            /** sets the closed-bit to true, and the running
+              ClientPool::run method will exit */
+            void close() {
+                closed = true;
+            }
+        };
+}
+#endif
@@ -6,6 +6,13 @@
 #define _prototls_common_hpp_
 #include <string>
 #include <sstream>
+#include <stdint.h>
+#ifdef __linux__
+#include <time.h>
+#endif
+#ifdef WIN32
+#include <windows.h>
+#endif
 namespace prototls {
     /** a convenience method to convert objects to strings */
     template <class T> std::string toString(T t) {
@@ -13,5 +20,54 @@ namespace prototls {
         s << t;
         return s.str();
     }
+
+    /** \return milliseconds from an unspecified starting point, 
+      not affected by changes of the system time */
+    inline uint64_t monotonicMillis() {
+#ifdef __linux__
+        struct timespec ts;
+        clock_gettime(CLOCK_MONOTONIC, &ts);
+        return (uint64_t) ts.tv_sec * 1000 + ts.tv_nsec / 1000000;
+#endif
+#ifdef WIN32
+        return GetTickCount64();
+#endif
+    }
+
+    /** \return microseconds from an unspecified starting point,
+      not affected by changes of the system time */
+    inline uint64_t monotonicMicros() {
+#ifdef __linux__
+        struct timespec ts;
+        clock_gettime(CLOCK_MONOTONIC, &ts);
+        return (uint64_t) ts.tv_sec * 1000000 + ts.tv_nsec / 1000;
+#endif
+#ifdef WIN32
+        LARGE_INTEGER frequency, counter;
+        QueryPerformanceFrequency(&frequency);
+        QueryPerformanceCounter(&counter);
+        return (uint64_t) (counter.QuadPart / frequency.QuadPart) * 1000000
+            + (uint64_t) (counter.QuadPart % frequency.QuadPart) * 1000000
+            / frequency.QuadPart;
+#endif
+    }
+
+    /** \return nanoseconds from an unspecified starting point,
+      not affected by changes of the system time */
+    inline uint64_t monotonicNanos() {
+#ifdef __linux__
+        struct timespec ts;
+        clock_gettime(CLOCK_MONOTONIC, &ts);
+        return (uint64_t) ts.tv_sec * 1000000000 + ts.tv_nsec;
+#endif
+#ifdef WIN32
+        LARGE_INTEGER frequency, counter;
+        QueryPerformanceFrequency(&frequency);
+        QueryPerformanceCounter(&counter);
+        return (uint64_t) (counter.QuadPart / frequency.QuadPart) * 1000000000
+            + (uint64_t) (counter.QuadPart % frequency.QuadPart) * 1000000000
+            / frequency.QuadPart;
+#endif
+    }
 }
 #endif
@@ -0,0 +1,178 @@
+/** prototls - Portable asynchronous client/server communications C++ library 
+   
+     See LICENSE for copyright information.
+*/
+#ifndef _prototls_epoll_hpp_
+#define _prototls_epoll_hpp_
+#include "prototls/Socket.hpp"
+#ifdef __linux__
+#include <sys/epoll.h>
+#include <algorithm>
+#include <vector>
+namespace prototls {
+    /** wrapper for Linux epoll with the interface of Select. The
+      sockets are watched again after every EPoll::reset like with
+      Select, but only the changes are passed to the kernel, so
+      waiting costs in proportion to the number of ready sockets
+      instead of watched ones. A socket descriptor that is closed must
+      be left out for one EPoll::select, or passed to EPoll::remove,
+      before it is watched again as a new socket. */
+    class EPoll {
+        /** epoll instance */
+        int epfd;
+
+        /** events each socket descriptor is registered for in the
+          epoll instance, or 0 */
+        std::vector<uint32_t> registered;
+
+        /** events each socket descriptor has been marked for since
+          EPoll::reset, or 0 */
+        std::vector<uint32_t> wanted;
+
+        /** events reported for each socket descriptor by the last
+          EPoll::select, or 0 */
+        std::vector<uint32_t> ready;
+
+        /** socket descriptors registered in the epoll instance */
+        std::vector<Socket::Fd> active;
+
+        /** socket descriptors marked since EPoll::reset */
+        std::vector<Socket::Fd> marked;
+
+        /** socket descriptors reported by the last EPoll::select */
+        std::vector<Socket::Fd> fired;
+
+        /** buffer for epoll_wait */
+        std::vector<struct epoll_event> events;
+
+        /** adds events to the socket descriptor */
+        void mark(Socket::Fd fd, uint32_t e) {
+            if ((size_t) fd >= wanted.size()) {
+                registered.resize(fd + 1, 0);
+                wanted.resize(fd + 1, 0);
+                ready.resize(fd + 1, 0);
+            }
+            if (!wanted[fd])
+                marked.push_back(fd);
+            wanted[fd] |= e;
+        }
+
+        /** passes the changes made since the last EPoll::select to
+          the epoll instance */
+        void update() {
+            for (size_t i = 0; i < marked.size(); i++) {
+                Socket::Fd fd = marked[i];
+                if (wanted[fd] == registered[fd])
+                    continue;
+                struct epoll_event ev;
+                ev.events = wanted[fd];
+                ev.data.fd = fd;
+                // the kernel forgets a descriptor when it is closed
+                if (!registered[fd]
+                        || epoll_ctl(epfd, EPOLL_CTL_MOD, fd, &ev))
+                    epoll_ctl(epfd, EPOLL_CTL_ADD, fd, &ev);
+                if (!registered[fd])
+                    active.push_back(fd);
+                registered[fd] = wanted[fd];
+            }
+            for (size_t i = 0; i < active.size(); ) {
+                Socket::Fd fd = active[i];
+                if (wanted[fd]) {
+                    i++;
+                    continue;
+                }
+                struct epoll_event ev;
+                epoll_ctl(epfd, EPOLL_CTL_DEL, fd, &ev);
+                registered[fd] = 0;
+                active[i] = active.back();
+                active.pop_back();
+            }
+        }
+
+        /** declared but not defined to prevent copying */
+        EPoll(const EPoll& e);
+
+        /** declared but not defined to prevent copying */
+        EPoll& operator=(const EPoll& e);
+    public:
+        /** creates the epoll instance */
+        EPoll() : epfd(epoll_create1(0)) {
+            if (epfd == -1)
+                throw SocketExcept("epoll_create1 failed");
+        }
+
+        /** closes the epoll instance */
+        ~EPoll() {
+            ::close(epfd);
+        }
+
+        /** starts marking the sockets to watch again */
+        void reset() {
+            for (size_t i = 0; i < marked.size(); i++)
+                wanted[marked[i]] = 0;
+            marked.clear();
+        }
+
+        /** forgets a socket descriptor that may have been closed and
+          reused by a new socket since the last EPoll::select. The
+          kernel has dropped the closed socket, but its registration
+          would otherwise be kept for the new one. */
+        void remove(Socket::Fd fd) {
+            if ((size_t) fd >= registered.size() || !registered[fd])
+                return;
+            struct epoll_event ev;
+            // fails if the registered socket has been closed
+            epoll_ctl(epfd, EPOLL_CTL_DEL, fd, &ev);
+            registered[fd] = 0;
+            ready[fd] = 0;
+            active.erase(std::find(active.begin(), active.end(), fd));
+        }
+
+        /** marks the socket to be watched for reading */
+        void input(Socket::Fd fd) {
+            mark(fd, EPOLLIN);
+        }
+
+        /** marks the socket to be watched for writing */
+        void output(Socket::Fd fd) {
+            mark(fd, EPOLLOUT);
+        }
+
+        /** \return true if the socket has data waiting to be read
+          (or has been closed or failed) */
+        bool canRead(Socket::Fd fd) const {
+            return (size_t) fd < ready.size() && (wanted[fd] & EPOLLIN)
+                && (ready[fd] & (EPOLLIN | EPOLLHUP | EPOLLERR));
+        }
+
+        /** \return true if the socket can be written to without 
+          blocking (or a pending connection attempt has finished) */
+        bool canWrite(Socket::Fd fd) const {
+            return (size_t) fd < ready.size() && (wanted[fd] & EPOLLOUT)
+                && (ready[fd] & (EPOLLOUT | EPOLLHUP | EPOLLERR));
+        }
+
+        /** waits 'msecs' milliseconds for the marked sockets
+         \return -1 on error, 0 if no data, > 0 number of sockets 
+         that are ready */
+        int select(int msecs) {
+            update();
+            for (size_t i = 0; i < fired.size(); i++)
+                ready[fired[i]] = 0;
+            fired.clear();
+            // level-triggered, so the sockets that do not fit are
+            // reported by the next call
+            events.resize(std::min<size_t>(
+                        std::max<size_t>(active.size(), 1), 1024));
+            int n = epoll_wait(epfd, &events[0], events.size(), msecs);
+            for (int i = 0; i < n; i++) {
+                Socket::Fd fd = events[i].data.fd;
+                ready[fd] = events[i].events;
+                fired.push_back(fd);
+            }
+            return n;
+        }
+    };
+}
+#endif
+#endif
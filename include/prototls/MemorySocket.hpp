@@ -0,0 +1,101 @@
+/** prototls - Portable asynchronous client/server communications C++ library
+
+     See LICENSE for copyright information.
+*/
+#ifndef _prototls_memorysocket_hpp_
+#define _prototls_memorysocket_hpp_
+#include "prototls/Socket.hpp"
+#ifdef __linux__
+#include <boost/smart_ptr.hpp>
+namespace prototls {
+    /** the state shared by the ends of a MemorySocket pair */
+    class MemoryPipe;
+
+    /** One end of an in-process connection that implements the Socket
+      interface without the network stack, for deterministic tests and
+      benchmarks of framing, handler dispatch and backpressure. Create
+      the two ends with MemorySocket::createPair, and hand one to
+      Server::addPeer and the other to a Peer.
+
+      The socket descriptor is a timerfd, so the ends work with Select,
+      Poll and EPoll. It is readable when data or the end of the stream
+      is due. A timerfd cannot report writability, so room for output
+      is signalled apart, see MemorySocket::getOutputFd. Linux only. */
+    class MemorySocket : public Socket {
+        /** the state shared with the other end */
+        boost::shared_ptr<MemoryPipe> pipe;
+
+        /** the index of this end in 'pipe' */
+        int end;
+
+        /** the maximum number of bytes a recv returns, or 0 */
+        size_t fragment;
+
+        /** the descriptor that reports room for output, or 0 */
+        Fd outputFd;
+
+        /** creates an end of a pair */
+        MemorySocket(const boost::shared_ptr<MemoryPipe>& pipe, int end,
+                size_t fragment, Fd fd, Fd outputFd);
+
+        /** declared but not defined to prevent copying */
+        MemorySocket(const MemorySocket& m);
+
+        /** declared but not defined to prevent copying */
+        MemorySocket& operator=(const MemorySocket& m);
+    public:
+        /** creates the two ends of a connection
+          \param a set to the first end
+          \param b set to the second end
+          \param fragment the maximum number of bytes a recv returns,
+          so that messages arrive in pieces, or 0 for no limit
+          \param latency microseconds sent data takes to become
+          readable
+          \param capacity the maximum number of bytes buffered in each
+          direction */
+        static void createPair(MemorySocket*& a, MemorySocket*& b,
+                size_t fragment = 0, int latency = 0,
+                size_t capacity = 1024 * 1024);
+
+        /** closes this end, so that the other end reads the end of
+          the stream after the data sent before */
+        ~MemorySocket();
+
+        /** not supported, throws SocketExcept */
+        void connect(const std::string& addr, int port);
+
+        /** not supported, throws SocketExcept */
+        bool connectAsync(const std::string& addr, int port);
+
+        /** queues data for the other end
+          \return the number of bytes queued, or -1 with errno EAGAIN
+          if the other end has 'capacity' bytes buffered, or EPIPE if
+          it has been closed */
+        ssize_t send(const void* buf, size_t len);
+
+        /** receives data that is due
+          \return the number of bytes read, 0 at the end of the stream,
+          or -1 with errno EAGAIN if no data is due */
+        ssize_t recv(void* buf, size_t len);
+
+        /** \return the number of bytes due, so that a fragmented
+          stream is read in pieces at once */
+        size_t pending() const;
+
+        /** not supported, throws SocketExcept */
+        Socket* accept();
+
+        /** \return an eventfd that is writable while the other end
+          has less than 'capacity' bytes buffered, or has been closed
+          so that a send fails at once */
+        Fd getOutputFd() const;
+
+        /** \return "memory:" and the descriptor of this end */
+        std::string getInfo() const;
+
+        /** closes this end and its output descriptor */
+        void close();
+    };
+}
+#endif
+#endif
@@ -0,0 +1,317 @@
+/** prototls - Portable asynchronous client/server communications C++ library
+
+     See LICENSE for copyright information.
+*/
+#ifndef _prototls_metrics_hpp_
+#define _prototls_metrics_hpp_
+#include "prototls/Socket.hpp"
+#include <boost/atomic.hpp>
+#include <boost/function.hpp>
+#include <boost/smart_ptr.hpp>
+#include <boost/thread/thread.hpp>
+#include <string>
+namespace prototls {
+    /** A counter that one thread writes and any thread reads. An
+      update is a plain load and store, without a locked instruction,
+      so counting costs next to nothing on the hot path. */
+    class Counter {
+        boost::atomic<uint64_t> value;
+
+        /** declared but not defined to prevent copying */
+        Counter(const Counter& c);
+
+        /** declared but not defined to prevent copying */
+        Counter& operator=(const Counter& c);
+    public:
+        Counter() : value(0) {}
+
+        /** adds to the counter. Call only from the writing thread. */
+        void add(uint64_t n = 1) {
+            value.store(value.load(boost::memory_order_relaxed) + n,
+                    boost::memory_order_relaxed);
+        }
+
+        /** sets the value, e.g. of a gauge. Call only from the
+          writing thread. */
+        void set(uint64_t n) {
+            value.store(n, boost::memory_order_relaxed);
+        }
+
+        /** \return the value */
+        uint64_t get() const {
+            return value.load(boost::memory_order_relaxed);
+        }
+    };
+
+    /** A histogram of durations in nanoseconds in the style of
+      HdrHistogram: each power of two is split into 32 buckets, so
+      the percentiles are within about 3% of the recorded values.
+      Values above about 18 minutes count as that. One thread records,
+      any thread reads. */
+    class Histogram {
+    public:
+        /** the number of buckets */
+        static const size_t buckets = 1152;
+
+        /** the largest value recorded exactly enough */
+        static const uint64_t maxValue = (1ULL << 40) - 1;
+    private:
+        /** the number of values in each bucket */
+        Counter counts[buckets];
+
+        /** the number of values */
+        Counter total;
+
+        /** the sum of the values */
+        Counter totalSum;
+
+        /** the largest value */
+        Counter largest;
+
+        /** \return the bucket of a value */
+        static size_t index(uint64_t v) {
+            if (v < 64)
+                return v;
+            // keep the 6 highest bits: 32 buckets per power of two
+#ifdef __GNUC__
+            int shift = 63 - __builtin_clzll(v) - 5;
+#else
+            int shift = 0;
+            for (uint64_t top = v >> 6; top; top >>= 1)
+                shift++;
+#endif
+            return 64 + (shift - 1) * 32 + (v >> shift) - 32;
+        }
+
+        /** \return the middle of the values of a bucket */
+        static uint64_t middle(size_t i);
+
+        /** declared but not defined to prevent copying */
+        Histogram(const Histogram& h);
+
+        /** declared but not defined to prevent copying */
+        Histogram& operator=(const Histogram& h);
+    public:
+        Histogram() {}
+
+        /** records a value. Call only from the recording thread. */
+        void record(uint64_t nanos) {
+            if (nanos > maxValue)
+                nanos = maxValue;
+            counts[index(nanos)].add();
+            total.add();
+            totalSum.add(nanos);
+            if (nanos > largest.get())
+                largest.set(nanos);
+        }
+
+        /** \return the number of values */
+        uint64_t count() const {
+            return total.get();
+        }
+
+        /** \return the sum of the values */
+        uint64_t sum() const {
+            return totalSum.get();
+        }
+
+        /** \return the largest value */
+        uint64_t max() const {
+            return largest.get();
+        }
+
+        /** \return the value that 'fraction' of the values do not
+          exceed, e.g. 0.99 for the 99th percentile, or 0 if there
+          are no values */
+        uint64_t percentile(double fraction) const;
+    };
+
+    /** traffic counters of the peers run by one thread, see
+      Peer::setCounters */
+    struct TrafficCounters {
+        /** bytes received */
+        Counter bytesIn;
+
+        /** bytes sent */
+        Counter bytesOut;
+
+        /** messages received, not counting heartbeats */
+        Counter framesIn;
+
+        /** messages queued for sending, not counting heartbeats */
+        Counter framesOut;
+
+        /** the time Peer::send takes to serialize a message, or NULL
+          if not timed */
+        Histogram* serialize;
+
+        TrafficCounters() : serialize(NULL) {}
+    };
+
+    /** counters of a Server, written by the thread running
+      Server::serve */
+    struct ServerCounters : public TrafficCounters {
+        /** connections accepted */
+        Counter accepted;
+
+        /** peers that have joined */
+        Counter joined;
+
+        /** peers that have left */
+        Counter left;
+
+        /** peers connected now */
+        Counter active;
+
+        /** bytes waiting in the outgoing data buffers of the peers */
+        Counter outputQueued;
+
+        /** peers that have data waiting to be sent */
+        Counter outputPeers;
+
+        /** bytes held in the incoming and outgoing data buffers of
+          the peers */
+        Counter buffered;
+
+        /** peers not read from because of the memory budget */
+        Counter pausedPeers;
+
+        /** peers closed for a message larger than their quota */
+        Counter oversized;
+
+        /** reactor loop iterations */
+        Counter loops;
+
+        /** microseconds the reactor has spent between waits for the
+          sockets */
+        Counter loopMicros;
+
+        /** TLS handshakes that have succeeded. The handshake counters
+          are written by all the handshake threads, so they are added
+          to atomically; a handshake takes far longer. */
+        boost::atomic<uint64_t> handshakes;
+
+        /** TLS handshakes that have failed */
+        boost::atomic<uint64_t> handshakeFailures;
+
+        ServerCounters() : handshakes(0), handshakeFailures(0) {}
+    };
+
+    /** a snapshot of the counters of a Server, see Server::getStats */
+    struct ServerStats {
+        uint64_t accepted;
+        uint64_t joined;
+        uint64_t left;
+        uint64_t active;
+        uint64_t handshakes;
+        uint64_t handshakeFailures;
+        uint64_t bytesIn;
+        uint64_t bytesOut;
+        uint64_t framesIn;
+        uint64_t framesOut;
+        uint64_t outputQueued;
+        uint64_t outputPeers;
+        uint64_t buffered;
+        uint64_t pausedPeers;
+        uint64_t oversized;
+        uint64_t loops;
+        uint64_t loopMicros;
+
+        /** reads the counters */
+        explicit ServerStats(const ServerCounters& c);
+
+        /** \return the statistics in the Prometheus text exposition
+          format
+         \param prefix the prefix of the metric names */
+        std::string toPrometheus(const std::string& prefix = "prototls") const;
+    };
+
+    /** timings of the handlers and reactor phases of a Server, see
+      Server::setTiming. Recorded by the thread running Server::serve. */
+    struct ServerTimings {
+        /** Server::onPacket calls */
+        Histogram onPacket;
+
+        /** Server::onJoin calls */
+        Histogram onJoin;
+
+        /** Server::onLeave calls */
+        Histogram onLeave;
+
+        /** message serialization in Peer::send */
+        Histogram serialize;
+
+        /** marking the sockets to wait for */
+        Histogram poll;
+
+        /** waiting for the sockets */
+        Histogram wait;
+
+        /** firing timers and checking idle deadlines */
+        Histogram timers;
+
+        /** accepting connections */
+        Histogram accept;
+
+        /** joining peers that are ready, onJoin included */
+        Histogram join;
+
+        /** reading, writing and dispatching packets, onPacket
+          included */
+        Histogram peers;
+
+        /** removing peers that have left, onLeave included */
+        Histogram collect;
+
+        /** \return the timings in the Prometheus text exposition
+          format, as summaries in seconds
+         \param prefix the prefix of the metric names */
+        std::string toPrometheus(const std::string& prefix = "prototls") const;
+    };
+
+    /** Serves a text document, such as metrics in the Prometheus text
+      format, over HTTP from a thread of its own. Every GET request is
+      answered with the document rendered at that time. */
+    class MetricsListener {
+        /** renders the document */
+        boost::function0<std::string> render;
+
+        /** the listening socket */
+        Socket sock;
+
+        /** the thread answering requests */
+        boost::scoped_ptr<boost::thread> thread;
+
+        /** flag marking that the listener has been stopped */
+        volatile bool stopped;
+
+        /** accepts and answers requests until stopped */
+        void run();
+
+        /** answers a request */
+        void answer(Socket& s);
+
+        /** declared but not defined to prevent copying */
+        MetricsListener(const MetricsListener& m);
+
+        /** declared but not defined to prevent copying */
+        MetricsListener& operator=(const MetricsListener& m);
+    public:
+        /** \param render called in the listener's thread to render the
+          document for a request */
+        MetricsListener(const boost::function0<std::string>& render);
+
+        /** stops the listener */
+        ~MetricsListener();
+
+        /** starts answering requests
+         \param port the port to listen at
+         \param addr the address to listen at, by default only local
+         connections are accepted */
+        void start(int port, const std::string& addr = "127.0.0.1");
+
+        /** stops answering requests and waits for the thread */
+        void stop();
+    };
+}
+#endif
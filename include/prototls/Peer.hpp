@@ -5,7 +5,11 @@
 #ifndef _prototls_peer_hpp_
 #define _prototls_peer_hpp_
 #include <google/protobuf/message.h>
+#include "prototls/Common.hpp"
 #include "prototls/Socket.hpp"
+#include "prototls/Metrics.hpp"
+#include "prototls/Capture.hpp"
+#include "prototls/BufferPool.hpp"
 #include <boost/smart_ptr.hpp>
 namespace prototls {
     /** Packet serializer on top of a Socket */
@@ -13,20 +17,67 @@ namespace prototls {
         /** socket operated and owned by peer */
         boost::scoped_ptr<Socket> sock;
 
-        /** the length of the next protobuf message if nonzero */
-        size_t msgSize;
-
         /** buffer for incoming data */
         std::string inBuf;
 
         /** buffer for outgoing data */
         std::string outBuf;
 
+        /** the time data was last received */
+        uint64_t lastInput;
+
+        /** the time data was last sent, or queued when none was
+          waiting (or the peer was set up) */
+        uint64_t lastOutput;
+
+        /** counters of the traffic, or NULL */
+        TrafficCounters* counters;
+
+        /** the file the received messages are captured to, or NULL */
+        CaptureFile* capture;
+
+        /** the pool drained buffers are given to, or NULL */
+        BufferPool* pool;
+
+        /** the length of the next protobuf message if nonzero */
+        uint32_t msgSize;
+
         /** byte position in the incoming data buffer for parsing packets */
         int inBufPos;
 
+        /** the connection number of the peer in 'capture' */
+        uint32_t captureId;
+
+        /** true while the server does not read from the peer */
+        bool inputPaused;
+
+        /** gives a buffer that has become empty to the pool */
+        void release(std::string& buf) {
+            if (pool)
+                pool->give(buf);
+            else
+                buf.clear();
+        }
+
+        /** takes a buffer from the pool for data to be added */
+        void acquire(std::string& buf) {
+            if (pool && buf.empty())
+                pool->take(buf);
+        }
+
+        /** prepares the outgoing data buffer for data to be added.
+          Output queued when none is waiting starts the write timeout
+          of the server afresh. */
+        void startOutput() {
+            if (!outBuf.empty())
+                return;
+            lastOutput = monotonicMillis();
+            acquire(outBuf);
+        }
+
         /** reads the next protobuf message size from incoming data buffer
-          and sets 'msgSize' */
+          and sets 'msgSize'. Zero-length frames are heartbeats and
+          skipped. */
         void readMessageSize();
      public:
 
@@ -44,17 +95,24 @@ namespace prototls {
             return sock->getFd();
         }
 
+        /** \return the descriptor to watch for room for output, see
+          Socket::getOutputFd */
+        int getOutputFd() const {
+            return sock->getOutputFd();
+        }
+
         /** \return true if the socket is set and alive */
         bool isActive() const {
             return sock.get() ? sock->isActive() : false;
         }
 
         /** \return socket specific address description */
-        const std::string& getInfo() const {
+        std::string getInfo() const {
             return sock->getInfo();
         }
 
-        /** reads data from socket and tries to read the next message size */
+        /** reads data from socket, including data already buffered
+          by the TLS layer, and tries to read the next message size */
         void onInput();
 
         /** serializes protobuf message and stores the data in the
@@ -66,22 +124,122 @@ namespace prototls {
         bool hasPacket() const {
             return msgSize && inBuf.size() - inBufPos >= msgSize;
         }
+        /** \return true if the next packet has started arriving: its
+          size or some of its data has been received */
+        bool hasPartialPacket() const {
+            return msgSize || inBuf.size() > (size_t) inBufPos;
+        }
+
+        /** \return the size of the next packet in bytes, or 0 if its
+          size has not been received yet */
+        size_t getPacketSize() const {
+            return msgSize;
+        }
+
         /** deserializes a protobuf message of type T from the incoming
           data buffer */
         template <class T>
             void recv(T& m) {
+                if (capture)
+                    capture->frame(captureId, inBuf.data() + inBufPos,
+                            msgSize);
                 m.ParseFromArray(inBuf.c_str() + inBufPos, msgSize);
                 inBufPos += msgSize;
                 msgSize = 0;
+                if (counters)
+                    counters->framesIn.add();
                 if (inBufPos == inBuf.size()) {
                     inBufPos = 0;
-                    inBuf.clear();
+                    release(inBuf);
                 }
                 readMessageSize();
             }
 
-        /** sends the outgoing data buffer and empties it */
+        /** stores an already serialized message, e.g. one read from a
+          capture file, in the outgoing data buffer */
+        void sendFrame(const void* data, size_t size);
+
+        /** appends a heartbeat (a zero-length frame) to the outgoing
+          data buffer. Heartbeats are not reported as packets by
+          the receiving peer. */
+        void sendHeartbeat();
+
+        /** sends as much of the outgoing data buffer as the socket
+          accepts without blocking. The rest is kept to be sent by
+          the next flush (when the socket is writable). The peer is
+          closed on error. */
         void flush();
+
+        /** \return true if the outgoing data buffer has data that has
+          not been sent */
+        bool hasOutput() const {
+            return !outBuf.empty();
+        }
+
+        /** \return the number of bytes in the outgoing data buffer */
+        size_t getOutputSize() const {
+            return outBuf.size();
+        }
+
+        /** \return the number of bytes held in the incoming data
+          buffer, including packets taken out but not yet dropped */
+        size_t getInputSize() const {
+            return inBuf.size();
+        }
+
+        /** \return the number of bytes held in the incoming and
+          outgoing data buffers */
+        size_t getBufferedSize() const {
+            return inBuf.size() + outBuf.size();
+        }
+
+        /** marks that the peer is not read from until resumed, see
+          Server::setMemoryBudget. The peer does not count as silent
+          while paused: when resumed, the time data was last received
+          is set to now. */
+        void setInputPaused(bool paused) {
+            if (inputPaused && !paused)
+                lastInput = monotonicMillis();
+            inputPaused = paused;
+        }
+
+        /** \return true if the peer is not read from */
+        bool isInputPaused() const {
+            return inputPaused;
+        }
+
+        /** counts the traffic of the peer. The counters must be
+          written only by the thread running the peer.
+         \param counters the counters, or NULL to stop counting */
+        void setCounters(TrafficCounters* counters) {
+            this->counters = counters;
+        }
+
+        /** gives the storage of the buffers to a pool whenever they
+          become empty, and takes it from there when data is added,
+          so that idle peers hold no buffer memory
+         \param pool the pool, used only by the thread running the
+         peer, or NULL to keep the storage */
+        void setBufferPool(BufferPool* pool) {
+            this->pool = pool;
+        }
+
+        /** records the messages taken out with Peer::recv, and when
+          the peer is closed, to a capture file
+         \param capture the file, or NULL to stop capturing
+         \param connection the number of the connection in the file */
+        void setCapture(CaptureFile* capture, uint32_t connection);
+
+        /** \return the time data was last received (see monotonicMillis) */
+        uint64_t getLastInput() const {
+            return lastInput;
+        }
+
+        /** \return the time data was last sent, or queued when none
+          was waiting (see monotonicMillis) */
+        uint64_t getLastOutput() const {
+            return lastOutput;
+        }
     };
 }
 #endif
@@ -0,0 +1,93 @@
+/** prototls - Portable asynchronous client/server communications C++ library 
+   
+     See LICENSE for copyright information.
+*/
+#ifndef _prototls_poll_hpp_
+#define _prototls_poll_hpp_
+#include "prototls/Socket.hpp"
+#ifdef __linux__
+#include <poll.h>
+#include <vector>
+namespace prototls {
+    /** wrapper for poll system call with the interface of Select.
+      Unlike Select, it is not limited to socket descriptors below
+      FD_SETSIZE. */
+    class Poll {
+        /** watched socket descriptors and their events */
+        std::vector<struct pollfd> fds;
+
+        /** position of each socket descriptor in 'fds', or -1 */
+        std::vector<int> index;
+
+        /** \return the entry of the socket, added if not watched yet */
+        struct pollfd& entry(Socket::Fd fd) {
+            if ((size_t) fd >= index.size())
+                index.resize(fd + 1, -1);
+            if (index[fd] < 0) {
+                struct pollfd p;
+                p.fd = fd;
+                p.events = 0;
+                p.revents = 0;
+                index[fd] = fds.size();
+                fds.push_back(p);
+            }
+            return fds[index[fd]];
+        }
+
+        /** \return true if the socket is watched for the events and
+          one of 'ready' has been reported */
+        bool has(Socket::Fd fd, short events, short ready) const {
+            if ((size_t) fd >= index.size() || index[fd] < 0)
+                return false;
+            const struct pollfd& p = fds[index[fd]];
+            return (p.events & events) && (p.revents & ready);
+        }
+    public:
+        /** initializes the set of watched sockets */
+        void reset() {
+            for (size_t i = 0; i < fds.size(); i++)
+                index[fds[i].fd] = -1;
+            fds.clear();
+        }
+
+        /** forgets the events reported for a socket descriptor that
+          may have been closed and reused by a new socket since the
+          last Poll::select. The sockets are watched afresh after
+          every Poll::reset, so there is nothing else to forget. */
+        void remove(Socket::Fd fd) {
+            if ((size_t) fd < index.size() && index[fd] >= 0)
+                fds[index[fd]].revents = 0;
+        }
+
+        /** marks the socket to be watched for reading */
+        void input(Socket::Fd fd) {
+            entry(fd).events |= POLLIN;
+        }
+
+        /** marks the socket to be watched for writing */
+        void output(Socket::Fd fd) {
+            entry(fd).events |= POLLOUT;
+        }
+
+        /** \return true if the socket has data waiting to be read
+          (or has been closed or failed) */
+        bool canRead(Socket::Fd fd) const {
+            return has(fd, POLLIN, POLLIN | POLLHUP | POLLERR);
+        }
+
+        /** \return true if the socket can be written to without 
+          blocking (or a pending connection attempt has finished) */
+        bool canWrite(Socket::Fd fd) const {
+            return has(fd, POLLOUT, POLLOUT | POLLHUP | POLLERR);
+        }
+
+        /** waits 'msecs' milliseconds for the watched sockets
+         \return -1 on error, 0 if no data, > 0 number of sockets 
+         that are ready */
+        int select(int msecs) {
+            return ::poll(fds.empty() ? NULL : &fds[0], fds.size(), msecs);
+        }
+    };
+}
+#endif
+#endif
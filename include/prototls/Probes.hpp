@@ -0,0 +1,43 @@
+/** prototls - Portable asynchronous client/server communications C++ library
+
+     See LICENSE for copyright information.
+*/
+#ifndef _prototls_probes_hpp_
+#define _prototls_probes_hpp_
+/** Static tracepoints (USDT) of the provider "prototls", for tracing
+  running processes with bpftrace, perf or SystemTap, e.g.
+
+    bpftrace -e 'usdt:./server:prototls:read { @bytes = hist(arg1); }'
+
+  A probe is a no-op instruction until a tracer attaches to it. The
+  probes are compiled in when <sys/sdt.h> (systemtap-sdt-dev or
+  systemtap-sdt-devel) is found, unless PROTOTLS_NO_PROBES is defined.
+  The arguments, fd being the socket descriptor:
+
+    accept(fd, tls)                    Server accepted a connection
+    handshake-start(fd)                a blocking TLS handshake starts
+    handshake-done(fd, result)         a TLS handshake has finished,
+                                       result is 0 or a GnuTLS error
+    read(fd, bytes)                    Peer::onInput received data
+    frame(fd, bytes)                   the size of the next incoming
+                                       message has been read
+    flush(fd, sent, left)              Peer::flush sent data, 'left'
+                                       bytes are still waiting
+    close(fd)                          a peer was closed */
+#if defined(__linux__) && !defined(PROTOTLS_NO_PROBES) && defined(__has_include)
+#if __has_include(<sys/sdt.h>)
+#include <sys/sdt.h>
+#define PROTOTLS_PROBES 1
+#endif
+#endif
+
+#ifdef PROTOTLS_PROBES
+#define PROTOTLS_PROBE1(name, a) DTRACE_PROBE1(prototls, name, a)
+#define PROTOTLS_PROBE2(name, a, b) DTRACE_PROBE2(prototls, name, a, b)
+#define PROTOTLS_PROBE3(name, a, b, c) DTRACE_PROBE3(prototls, name, a, b, c)
+#else
+#define PROTOTLS_PROBE1(name, a) do {} while (0)
+#define PROTOTLS_PROBE2(name, a, b) do {} while (0)
+#define PROTOTLS_PROBE3(name, a, b, c) do {} while (0)
+#endif
+#endif
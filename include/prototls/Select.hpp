@@ -9,10 +9,13 @@ namespace prototls {
     /** wrapper for select system call to perform asynchronous IO
       on multiple sockets */
     class Select {
-        /** file descriptor set */
+        /** file descriptor set watched for reading */
         fd_set rfds;
 
-        /** the highest socket descriptor 'rfds' */
+        /** file descriptor set watched for writing */
+        fd_set wfds;
+
+        /** the highest socket descriptor in 'rfds' and 'wfds' */
         Socket::Fd max;
     public:
         /** performs reset */
@@ -23,9 +26,19 @@ namespace prototls {
         /** initializes the file descriptor set */
         void reset() {
             FD_ZERO(&rfds);
+            FD_ZERO(&wfds);
             max = 0;
         }
 
+        /** forgets the events reported for a socket descriptor that
+          may have been closed and reused by a new socket since the
+          last Select::select. The sets are filled afresh after every
+          Select::reset, so there is nothing else to forget. */
+        void remove(Socket::Fd fd) {
+            FD_CLR(fd, &rfds);
+            FD_CLR(fd, &wfds);
+        }
+
         /** marks the socket to be watched for reading */
         void input(Socket::Fd fd) {
             FD_SET(fd, &rfds);
@@ -33,20 +46,33 @@ namespace prototls {
                 max = fd;
         }
 
+        /** marks the socket to be watched for writing */
+        void output(Socket::Fd fd) {
+            FD_SET(fd, &wfds);
+            if (fd > max)
+                max = fd;
+        }
+
         /** \return true if the socket has data waiting to be read */
         bool canRead(Socket::Fd fd) const {
             return FD_ISSET(fd, &rfds);
         }
 
+        /** \return true if the socket can be written to without 
+          blocking (or a pending connection attempt has finished) */
+        bool canWrite(Socket::Fd fd) const {
+            return FD_ISSET(fd, &wfds);
+        }
+
         /** waits 'msecs' milliseconds for the sockets in the 
-          socket descriptor set for input
+          socket descriptor sets for input or output
          \return -1 on error, 0 if no data, > 0 number of sockets 
          that have data waiting */
         int select(int msecs) {
             struct timeval tv;
             tv.tv_usec = (msecs % 1000) * 1000;
             tv.tv_sec = msecs / 1000;
-            return ::select(max+1, &rfds, NULL, NULL, &tv);
+            return ::select(max+1, &rfds, &wfds, NULL, &tv);
         }
 
 
@@ -7,11 +7,17 @@
 #include "prototls/Socket.hpp"
 #include "prototls/TLSSocket.hpp"
 #include "prototls/Peer.hpp"
+#include "prototls/BufferPool.hpp"
+#include "prototls/Metrics.hpp"
+#include "prototls/Probes.hpp"
 #include "prototls/TSDeque.hpp"
 #include <boost/smart_ptr.hpp>
+#include <boost/make_shared.hpp>
 #include "prototls/Select.hpp"
+#include "prototls/TimerWheel.hpp"
 #include <boost/thread/mutex.hpp>
 #include "boost/threadpool.hpp"
+#include <algorithm>
 #include <sstream>
 #include <cstdio>
 #include <iostream>
@@ -22,8 +28,9 @@ namespace prototls {
         asynchronous servers that send and receive protobuf messages
         with/without encrypted communication. TLS handshakes
         are performed in separate threads in order to avoid blocking 
-        for long time. */
-    template <class PeerT>
+        for long time. The sockets are watched with PollerT: Select,
+        or Poll or EPoll for more than FD_SETSIZE sockets. */
+    template <class PeerT, class PollerT = Select>
         class Server {
             /** socket that accepts connections */
             boost::scoped_ptr<Socket> sock;
@@ -35,12 +42,103 @@ namespace prototls {
             /** connected peers */
             Peers peers;
 
-            /** a pool of threads for TLS handshakes */
-            boost::threadpool::pool pool;
-
             /** thread safe deque that holds fresh TLS sockets */
             TSDeque<Socket*> socketsReady;
 
+#ifdef __linux__
+            /** pipe written to when a socket is added to 'socketsReady',
+              so that the thread running Server::serve joins it at once
+              instead of after the next timeout */
+            int wakeup[2];
+#endif
+
+            /** timers fired in the thread running Server::serve */
+            boost::threadpool::timer_queue timers;
+
+            /** peers by the time their idle deadlines must be checked */
+            TimerWheel< boost::weak_ptr<PeerT> > deadlines;
+
+            /** milliseconds a peer may stay silent before it is closed,
+              or 0 */
+            int readTimeout;
+
+            /** milliseconds a peer may leave sent data unread before it
+              is closed, or 0 */
+            int writeTimeout;
+
+            /** milliseconds of no outgoing data after which a heartbeat
+              is sent, or 0 */
+            int heartbeatInterval;
+
+            /** CPUs the thread running Server::serve is bound to */
+            std::vector<int> reactorCpus;
+
+            /** CPU whose connections the listening socket prefers,
+              or -1 */
+            int incomingCpu;
+
+            /** counters of the server */
+            ServerCounters counters;
+
+            /** a pool of threads for TLS handshakes. Handshake tasks
+              are stored inline, so accepting does not allocate for them.
+              The pool grows when handshakes queue up, also while all
+              of its threads are blocked in handshakes, and retires
+              idle threads. It is declared after the members the
+              handshakes use, so it is destroyed before them. */
+            boost::threadpool::adaptive_inplace_pool pool;
+
+            /** the listener serving the counters over HTTP, or NULL */
+            boost::scoped_ptr<MetricsListener> metricsListener;
+
+            /** timings of the handlers and reactor phases, or NULL */
+            boost::scoped_ptr<ServerTimings> timings;
+
+            /** nanoseconds a handler may take before it is logged as
+              slow, or 0 */
+            uint64_t slowNanos;
+
+            /** the second (of monotonicMillis) of the last slow handler
+              logged */
+            uint64_t slowSecond;
+
+            /** slow handlers logged in 'slowSecond' */
+            int slowLogged;
+
+            /** slow handlers in 'slowSecond' that were not logged */
+            uint64_t slowSuppressed;
+
+            /** the file the received messages are captured to, or NULL */
+            boost::scoped_ptr<CaptureFile> capture;
+
+            /** the number of the next connection captured */
+            uint32_t captureId;
+
+            /** the storage of the buffers the peers have drained */
+            BufferPool buffers;
+
+            /** the bytes the buffers of all the peers may hold before
+              reading pauses, or 0 */
+            size_t memoryBudget;
+
+            /** the bytes the buffers of a peer may hold before reading
+              from it pauses, or 0 */
+            size_t peerQuota;
+
+            /** the bytes held in the buffers of the peers, counted at
+              each pass over the peers and updated as they are read */
+            size_t buffered;
+
+            /** the bytes held in the incoming data buffers of the
+              peers at the last pass over them */
+            size_t bufferedInput;
+
+            /** the maximum number of slow handlers logged per second */
+            static const int slowLogLimit = 10;
+
+            /** the maximum number of connections accepted per wakeup */
+            static const int acceptBatch = 64;
+
             /** this method is called when a peer can read a packet */
             virtual void onPacket(PeerT&p) = 0;
 
@@ -55,90 +153,356 @@ namespace prototls {
              adds it to the list of ready sockets */
             void handshake(Socket* sock) {
                 if (sock->handshake()) {
+                    counters.handshakeFailures.fetch_add(1,
+                            boost::memory_order_relaxed);
+                    delete sock;
                     return;
                 }
+                counters.handshakes.fetch_add(1, boost::memory_order_relaxed);
+                ready(sock);
+            }
+
+            /** adds a socket to the list of ready sockets and wakes up
+              the thread running Server::serve */
+            void ready(Socket* sock) {
                 socketsReady.push_back(sock);
+#ifdef __linux__
+                if (write(wakeup[1], "", 1) < 0) {
+                    // the pipe is full, so the reactor is waking up anyway
+                }
+#endif
             }
             /** flag marking that the server has been closed */
             bool closed;
+
+            /** adds a peer to the deadlines unless it has none */
+            void watch(const boost::shared_ptr<PeerT>& p) {
+                uint64_t deadline = (uint64_t) -1;
+                // a paused peer is not silent, so it is checked again
+                // at the earliest a timeout after it is resumed
+                if (readTimeout)
+                    deadline = std::min(deadline, (p->isInputPaused()
+                                ? monotonicMillis() : p->getLastInput())
+                            + readTimeout);
+                // a peer without output is checked again a timeout
+                // later, so that output queued meanwhile is timed
+                if (writeTimeout)
+                    deadline = std::min(deadline, (p->hasOutput()
+                                ? p->getLastOutput() : monotonicMillis())
+                            + writeTimeout);
+                if (heartbeatInterval)
+                    deadline = std::min(deadline, p->getLastOutput() + heartbeatInterval);
+                if (deadline != (uint64_t) -1)
+                    deadlines.add(p, deadline);
+            }
+
+            /** closes a peer whose idle deadline has passed or sends
+              a heartbeat to it, and watches it again */
+            void checkDeadlines(const boost::weak_ptr<PeerT>& w) {
+                boost::shared_ptr<PeerT> p = w.lock();
+                if (!p || !p->isActive())
+                    return;
+                uint64_t now = monotonicMillis();
+                if ((readTimeout && !p->isInputPaused()
+                            && now - p->getLastInput() >= (uint64_t) readTimeout)
+                        || (writeTimeout && p->hasOutput()
+                            && now - p->getLastOutput() >= (uint64_t) writeTimeout)) {
+                    // collected with the other dead peers
+                    p->close();
+                    return;
+                }
+                if (heartbeatInterval && !p->hasOutput()
+                        && now - p->getLastOutput() >= (uint64_t) heartbeatInterval) {
+                    p->sendHeartbeat();
+                    p->flush();
+                }
+                watch(p);
+            }
+
+            /** \return true if reading from a peer must wait for buffers
+              to drain: the buffers of the peer hold its quota, or those
+              of all the peers the budget */
+            bool mustPause(const PeerT& p) const {
+                if (peerQuota && p.getBufferedSize() >= peerQuota)
+                    return true;
+                // when parts of messages take the whole budget, sending
+                // cannot free it, so the peers complete their messages
+                return memoryBudget && buffered >= memoryBudget
+                    && !(bufferedInput >= memoryBudget
+                            && p.hasPartialPacket());
+            }
+
+            /** \return the counters, and the timings if recorded, in
+              the Prometheus text format */
+            std::string renderMetrics() const {
+                std::string text = getStats().toPrometheus();
+                if (timings)
+                    text += timings->toPrometheus();
+                return text;
+            }
+
+            /** logs a slow handler, at most 'slowLogLimit' a second */
+            void logSlow(const char* handler, PeerT& p, size_t size,
+                    uint64_t nanos) {
+                uint64_t second = monotonicMillis() / 1000;
+                if (second != slowSecond) {
+                    if (slowSuppressed)
+                        std::cerr << slowSuppressed
+                            << " more slow handlers not logged" << std::endl;
+                    slowSecond = second;
+                    slowLogged = 0;
+                    slowSuppressed = 0;
+                }
+                if (slowLogged == slowLogLimit) {
+                    slowSuppressed++;
+                    return;
+                }
+                slowLogged++;
+                std::cerr << "slow " << handler << ": " << nanos / 1000
+                    << " us, peer " << p.getInfo();
+                if (size)
+                    std::cerr << ", packet " << size << " bytes";
+                std::cerr << std::endl;
+            }
+
+            /** calls a handler, timing it if timings are recorded or
+              slow handlers logged */
+            void call(void (Server::*handler)(PeerT&),
+                    Histogram ServerTimings::* timing, const char* name,
+                    PeerT& p) {
+                if (!timings && !slowNanos) {
+                    (this->*handler)(p);
+                    return;
+                }
+                size_t size = p.getPacketSize();
+                uint64_t start = monotonicNanos();
+                (this->*handler)(p);
+                uint64_t took = monotonicNanos() - start;
+                if (timings)
+                    (timings.get()->*timing).record(took);
+                if (slowNanos && took >= slowNanos)
+                    logSlow(name, p, size, took);
+            }
+
+            /** records the time from 'mark' to now as a phase of the
+              reactor loop, and moves 'mark' to now */
+            void phase(Histogram ServerTimings::* timing, uint64_t& mark) {
+                if (!timings)
+                    return;
+                uint64_t now = monotonicNanos();
+                (timings.get()->*timing).record(now - mark);
+                mark = now;
+            }
+
+            /** adds a connected peer. A peer closed earlier in the pass
+              may have left its socket descriptor to this one, so
+              'select' forgets what it knows of the descriptor. */
+            void join(Socket* s, PollerT& select) {
+                select.remove(s->getFd());
+                select.remove(s->getOutputFd());
+                s->setNonBlocking();
+                // the peer and its reference count in one allocation
+                peers.push_back(boost::make_shared<PeerT>());
+                peers.back()->setup(s);
+                peers.back()->setCounters(&counters);
+                peers.back()->setBufferPool(&buffers);
+                if (capture)
+                    peers.back()->setCapture(capture.get(), captureId++);
+                counters.joined.add();
+                watch(peers.back());
+                call(&Server::onJoin, &ServerTimings::onJoin, "onJoin",
+                        *peers.back());
+            }
         public:
-            /** initializes a number of threads
-              that will handle parallel TLS handshakes */
-            Server(int threads) : pool(threads), closed(false) {
+            /** initializes the pool of threads that will handle
+              parallel TLS handshakes
+             \param threads the maximum number of handshake threads */
+            Server(int threads) : deadlines(100, 1024),
+                readTimeout(0), writeTimeout(0), heartbeatInterval(0),
+                incomingCpu(-1), pool(0), slowNanos(0), slowSecond(0),
+                slowLogged(0), slowSuppressed(0), captureId(0),
+                memoryBudget(0), peerQuota(0), buffered(0), bufferedInput(0),
+                closed(false) {
+                pool.size_controller().set_limits(1, threads);
+                pool.enable_stats();
+#ifdef __linux__
+                if (pipe(wakeup))
+                    throw SocketExcept("pipe failed");
+                fcntl(wakeup[0], F_SETFL, O_NONBLOCK);
+                fcntl(wakeup[1], F_SETFL, O_NONBLOCK);
+#endif
             }
 
-            /** empty destructor */
+            /** finishes the handshakes in progress, deletes the sockets
+              they have handed over but were not joined, and closes the
+              wakeup pipe */
             virtual ~Server() {
+                metricsListener.reset();
+                // handshake tasks write to the pipe when they finish
+                pool.wait();
+                Socket* s = NULL;
+                socketsReady.try_pop_front(s);
+                while (s) {
+                    delete s;
+                    s = NULL;
+                    socketsReady.try_pop_front(s);
+                }
+#ifdef __linux__
+                ::close(wakeup[0]);
+                ::close(wakeup[1]);
+#endif
             }
 
             /** accepts and keeps track of connections. reads data
               from connected peers and notifies through virtual methods
               if packets can be deserialized 
              \param tls use GnuTLS for encryption 
-             \param port listen for incoming connections at this port
+             \param port listen for incoming connections at this port,
+             or if negative, serve only the peers added with
+             Server::addPeer
              \param maxPeers maximum number of connected peers */
             void serve(bool tls, int port, int maxPeers) {
-                if (tls)
-                    sock.reset(new TLSSocket());
-                else
-                    sock.reset(new Socket());
-                sock->setNonBlocking();
-                sock->bind(port);
-                sock->listen(maxPeers);
-                Select select;
+                // bind before allocating, so that the memory of the
+                // peers is placed on the node of the reactor's CPUs
+                boost::threadpool::bind_current_thread(reactorCpus);
+                if (port >= 0) {
+                    if (tls)
+                        sock.reset(new TLSSocket());
+                    else
+                        sock.reset(new Socket());
+                    // Socket::bind creates the socket descriptor
+                    sock->bind(port, incomingCpu >= 0);
+                    sock->setNonBlocking();
+                    if (incomingCpu >= 0)
+                        sock->setIncomingCpu(incomingCpu);
+                    sock->listen(maxPeers);
+                }
+                PollerT select;
+                // the time the last wait for the sockets returned
+                uint64_t woken = 0;
                 /* Wait for a peer, send data and term */
                 while (!closed)
                 {
+                    uint64_t mark = timings ? monotonicNanos() : 0;
                     select.reset();
-                    if (peers.size() < maxPeers)
+                    if (sock && peers.size() < maxPeers)
                         select.input(sock->getFd());
+#ifdef __linux__
+                    select.input(wakeup[0]);
+#endif
+                    size_t queued = 0, queuedPeers = 0, held = 0, paused = 0;
+                    size_t heldInput = 0;
                     for (typename Peers::iterator i = peers.begin(); i != peers.end(); i++) {
-                        select.input((*i)->getFd());
+                        (*i)->setInputPaused(mustPause(**i));
+                        if ((*i)->isInputPaused())
+                            paused++;
+                        else
+                            select.input((*i)->getFd());
+                        held += (*i)->getBufferedSize();
+                        heldInput += (*i)->getInputSize();
+                        if ((*i)->hasOutput()) {
+                            select.output((*i)->getOutputFd());
+                            queued += (*i)->getOutputSize();
+                            queuedPeers++;
+                        }
+                    }
+                    counters.active.set(peers.size());
+                    counters.outputQueued.set(queued);
+                    counters.outputPeers.set(queuedPeers);
+                    buffered = held;
+                    bufferedInput = heldInput;
+                    counters.buffered.set(held);
+                    counters.pausedPeers.set(paused);
+                    if (woken) {
+                        counters.loops.add();
+                        counters.loopMicros.add(monotonicMicros() - woken);
                     }
-                    if (select.select(100) == -1)
+                    phase(&ServerTimings::poll, mark);
+                    int ret = select.select(timers.next_timeout(100));
+                    woken = monotonicMicros();
+                    phase(&ServerTimings::wait, mark);
+                    timers.dispatch();
+                    deadlines.expire(monotonicMillis(),
+                            boost::bind(&Server::checkDeadlines, this, _1));
+                    phase(&ServerTimings::timers, mark);
+                    if (ret == -1)
                         continue;
-                    if (select.canRead(sock->getFd()) 
-                            && peers.size() < maxPeers) {
-                        try {
-                            Socket* csock = sock->accept();
-
-                            if (tls)  {
-                                boost::threadpool::schedule(pool, 
-                                        boost::bind(&Server::handshake, this, csock));
-                            } else {
-                                peers.push_back(boost::shared_ptr<PeerT>(new PeerT()));
-                                csock->setNonBlocking();
-                                peers.back()->setup(csock);
-                                onJoin(*peers.back());
+                    if (sock && select.canRead(sock->getFd())) {
+                        // accept a burst of connections at once instead
+                        // of one per pass over the peers
+                        for (int n = 0; n < acceptBatch
+                                && peers.size() < maxPeers; n++) {
+                            try {
+                                Socket* csock = sock->accept();
+                                if (!csock)
+                                    break;
+                                counters.accepted.add();
+                                PROTOTLS_PROBE2(accept, csock->getFd(), tls);
+                                // before the handshake, which takes
+                                // several flights
+                                csock->setNoDelay();
 
+                                if (tls)  {
+                                    boost::threadpool::schedule(pool, 
+                                            boost::bind(&Server::handshake, this, csock));
+                                } else {
+                                    join(csock, select);
+                                }
+                            } catch (SocketExcept& e) {
+                                std::cerr << e.what() << std::endl;
+                                break;
                             }
-                        } catch (SocketExcept& e) {
-                            std::cerr << e.what() << std::endl;
                         }
                     }
-                    if (tls)  {
-                        Socket* sock = NULL;
-                        socketsReady.try_pop_front(sock);
-                        if (sock) {
-                            sock->setNonBlocking();
-                            peers.push_back(boost::shared_ptr<PeerT>(new PeerT()));
-                            peers.back()->setup(sock);
-                            onJoin(*peers.back());
+                    phase(&ServerTimings::accept, mark);
+#ifdef __linux__
+                    char drained[64];
+                    if (select.canRead(wakeup[0]))
+                        while (read(wakeup[0], drained, sizeof(drained)) > 0) {
+                            // only wakes up the reactor
                         }
-                    }
+#endif
+                    // handshaked and added sockets
+                    Socket* s;
+                    do {
+                        s = NULL;
+                        socketsReady.try_pop_front(s);
+                        if (s)
+                            join(s, select);
+                    } while (s);
+                    phase(&ServerTimings::join, mark);
                     for (size_t i = 0; i < peers.size(); i++) {
                         boost::shared_ptr<PeerT>& p = peers[i];
-                        if (select.canRead(p->getFd()))
+                        size_t before = p->getBufferedSize();
+                        if (p->hasOutput()
+                                && select.canWrite(p->getOutputFd()))
+                            p->flush();
+                        // the budget may have run out since the pass
+                        // that watched the socket
+                        if (select.canRead(p->getFd()) && !mustPause(*p))
                             p->onInput();
                         while (p->hasPacket()) {
-                            onPacket(*p);
+                            call(&Server::onPacket, &ServerTimings::onPacket,
+                                    "onPacket", *p);
+                        }
+                        if (peerQuota && p->getPacketSize() > peerQuota
+                                && p->isActive()) {
+                            // it could never be received whole
+                            counters.oversized.add();
+                            p->close();
                         }
+                        size_t after = p->getBufferedSize();
+                        buffered = after >= before ? buffered + (after - before)
+                            : buffered - std::min(buffered, before - after);
                     }
+                    phase(&ServerTimings::peers, mark);
                     // collect dead peers
                     size_t count = peers.size();
                     for (size_t i = 0; i < count; ) {
                         if (!peers[i]->isActive()) {
-                            onLeave(*peers[i]);
+                            call(&Server::onLeave, &ServerTimings::onLeave,
+                                    "onLeave", *peers[i]);
+                            counters.left.add();
 
                             peers[i] = peers[peers.size() - 1];
                             count--;
@@ -148,11 +512,175 @@ namespace prototls {
                     if (count < peers.size()) {
                         peers.resize(count);
                     }
+                    phase(&ServerTimings::collect, mark);
 
                 }
             }
 
 
+            /** adds a connected socket, such as an end of a
+              MemorySocket pair, as a peer. May be called from any
+              thread; the peer joins in the thread running
+              Server::serve, which takes ownership of the socket.
+              No TLS handshake is performed. */
+            void addPeer(Socket* s) {
+                ready(s);
+            }
+
+            /** sets the idle deadlines of peers. Call before
+              Server::serve. A value of 0 disables the deadline.
+             \param readTimeout milliseconds a peer may stay silent
+             (heartbeats included) before it is closed
+             \param writeTimeout milliseconds a peer may leave data that
+             has been flushed unread before it is closed
+             \param heartbeatInterval milliseconds of no outgoing data
+             after which a heartbeat (a zero-length frame) is sent to
+             keep the peer from timing out on its side */
+            void setTimeouts(int readTimeout, int writeTimeout,
+                    int heartbeatInterval) {
+                this->readTimeout = readTimeout;
+                this->writeTimeout = writeTimeout;
+                this->heartbeatInterval = heartbeatInterval;
+            }
+
+            /** binds the server to CPUs. Call before Server::serve.
+              Memory is placed on the NUMA node of the CPU that first
+              touches it, so the peers stay local to the reactor.
+             \param reactorCpus CPUs of the thread running
+             Server::serve, or empty to leave it unbound
+             \param poolCpus CPUs of the handshake threads, or empty to
+             leave them unbound */
+            void setAffinity(const std::vector<int>& reactorCpus,
+                    const std::vector<int>& poolCpus) {
+                this->reactorCpus = reactorCpus;
+                if (!poolCpus.empty())
+                    pool.set_worker_init(
+                            boost::threadpool::cpu_affinity(poolCpus));
+            }
+
+            /** \return the statistics of the handshake threads: how
+              long handshakes have waited for a thread and taken, and
+              how busy the threads are */
+            boost::threadpool::pool_stats getHandshakeStats() const {
+                return pool.stats();
+            }
+
+            /** \return the counters of the server: peers, handshakes,
+              traffic, queued output and reactor loop time. May be
+              called from any thread. */
+            ServerStats getStats() const {
+                return ServerStats(counters);
+            }
+
+            /** serves the counters in the Prometheus text format over
+              HTTP (at any path) from a thread of its own, until the
+              server is destroyed
+             \param port the port to listen at
+             \param addr the address to listen at, by default only
+             local connections are accepted */
+            void serveMetrics(int port, const std::string& addr = "127.0.0.1") {
+                metricsListener.reset(new MetricsListener(
+                            boost::bind(&Server::renderMetrics, this)));
+                metricsListener->start(port, addr);
+            }
+
+            /** records histograms of the time taken by the handlers,
+              message serialization and the phases of the reactor loop,
+              and logs handlers that take too long. Call before
+              Server::serve. When both are off, a handler call costs
+              one more branch.
+             \param enabled record the histograms, see
+             Server::getTimings
+             \param slowMicros log the handlers (at most ten a second)
+             that take at least this many microseconds, with the peer
+             and packet size, or 0 not to */
+            void setTiming(bool enabled, int slowMicros = 0) {
+                if (enabled && !timings)
+                    timings.reset(new ServerTimings());
+                else if (!enabled)
+                    timings.reset();
+                counters.serialize = timings ? &timings->serialize : NULL;
+                slowNanos = (uint64_t) slowMicros * 1000;
+            }
+
+            /** captures the messages received by the peers that join
+              from now on, with the time they arrive, to a file that
+              bench_replay replays against a server. Call before
+              Server::serve.
+             \param path the file, replaced if it exists, or empty to
+             stop capturing
+             \throw SocketExcept if the file cannot be created */
+            void setCapture(const std::string& path) {
+                capture.reset(path.empty() ? NULL : new CaptureFile(path));
+            }
+
+            /** bounds the memory held in the buffers of the peers. Reading
+              from a peer pauses (its socket is not watched for input)
+              while its buffers hold 'peerQuota' bytes, or while the
+              buffers of all the peers hold 'budget' bytes, until they
+              drain below it. Should parts of messages take the whole
+              budget, the peers receiving them keep reading up to their
+              quotas to complete them. A peer that announces a
+              message larger than its quota is closed. The limits may
+              be exceeded by a read (16 KB) per peer and by the
+              messages handlers send, so applications sending to other
+              peers should check Peer::getOutputSize. Call before
+              Server::serve.
+             \param budget the bytes for all the peers, or 0 for no
+             limit
+             \param peerQuota the bytes for a peer, which must fit the
+             largest message expected, or 0 for no limit */
+            void setMemoryBudget(size_t budget, size_t peerQuota) {
+                memoryBudget = budget;
+                this->peerQuota = peerQuota;
+            }
+
+            /** \return the timings recorded, or NULL if not enabled
+              with Server::setTiming. May be read from any thread. */
+            const ServerTimings* getTimings() const {
+                return timings.get();
+            }
+
+            /** restarts the statistics of the handshake threads */
+            void resetHandshakeStats() {
+                pool.enable_stats();
+            }
+
+            /** shares the port with other servers (SO_REUSEPORT) and
+              prefers the connections whose packets are processed by
+              the given CPU, so that a server per CPU, bound with
+              Server::setAffinity, handles its connections locally.
+              Call before Server::serve.
+             \param cpu the CPU, or -1 to own the port alone */
+            void setIncomingCpu(int cpu) {
+                incomingCpu = cpu;
+            }
+
+            /** adds a timer that calls a function once in the thread
+              running Server::serve, so it may access the peers
+             \param msecs the delay in milliseconds
+             \param f the function
+             \return the id of the timer */
+            uint64_t setTimer(int msecs, const boost::function0<void>& f) {
+                return timers.schedule_after(msecs, f);
+            }
+
+            /** adds a timer that calls a function every 'msecs'
+              milliseconds in the thread running Server::serve
+             \param msecs the interval in milliseconds
+             \param f the function
+             \return the id of the timer */
+            uint64_t setInterval(int msecs, const boost::function0<void>& f) {
+                return timers.schedule_every(msecs, f);
+            }
+
+            /** cancels a timer added with Server::setTimer or
+              Server::setInterval
+             \return true if the timer was active */
+            bool cancelTimer(uint64_t id) {
+                return timers.cancel(id);
+            }
+
             /** sets the closed-bit to true, and the running 
               Server::serve method will exit */
             void close() {
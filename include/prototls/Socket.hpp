@@ -11,6 +11,7 @@
 #include <sys/ioctl.h>
 #include <sys/time.h>
 #include <netinet/in.h>
+#include <netinet/tcp.h>
 #include <arpa/inet.h>
 #include <stdlib.h>
 #include <unistd.h>
@@ -46,12 +47,20 @@ namespace prototls {
         typedef SOCKET Fd;
 #endif
 
+        /** the address of an endpoint, IPv4 or IPv6 */
+        union Address {
+            struct sockaddr sa;
+            struct sockaddr_in v4;
+            struct sockaddr_in6 v6;
+        };
+
     protected:
         /** socket descriptor */
         Fd fd;
 
-        /** connection endpoint information */
-        std::string info;
+        /** the address of the other end, formatted only when asked
+          for by Socket::getInfo */
+        Address address;
 
     private:
         /** socket domain, typically AF_INET */
@@ -74,11 +83,14 @@ namespace prototls {
     protected:
 
         /** assigns socket descriptor and inherits socket type */
-        Socket(Fd fd, const Socket& parent, const std::string& info);
-        /** wrapper for ::accept system call. sets connection
-          endpoint information
+        Socket(Fd fd, const Socket& parent, const Address& address);
+        /** wrapper for ::accept system call. sets the address of the
+          other end
           \return a socket or -1 if error */
-        Fd _accept(std::string& info);
+        Fd _accept(Address& address);
+
+        /** stores the address of the other end */
+        void setAddress(const struct sockaddr* addr, socklen_t len);
     public:
         /** system specific socket communication init */
         static void init();
@@ -88,33 +100,74 @@ namespace prototls {
 
         /** sets socket type */
         Socket(int domain = AF_INET, int type = SOCK_STREAM, int protocol = 0);
-        /** empty destructor */
+        /** closes the socket descriptor if it is still open */
         virtual ~Socket();
 
         /** connects to the specified address */
         virtual void connect(const std::string& addr, int port);
 
+        /** starts connecting to the specified address without blocking
+          (the socket is set non-blocking). Note that the address
+          resolution itself may still block.
+          \return true if the connection was established immediately,
+          false if it is in progress (wait until the socket is writable
+          and call Socket::finishConnect) */
+        virtual bool connectAsync(const std::string& addr, int port);
+
+        /** completes a connection started with Socket::connectAsync
+          \return zero if connected, otherwise the socket error code */
+        int finishConnect();
+
         /** sets the maximum number of incoming connections that can wait
           to be accepted */
         void listen(int peers);
 
-        /** creates a socket and sets it to listen on the specified port */
-        void bind(int port);
-
-        /** \return socket endpoint information */
-        const std::string& getInfo() const;
+        /** creates a socket and sets it to listen on the specified port
+          \param reusePort allow other sockets to bind to the same port
+          (SO_REUSEPORT) so that incoming connections are spread over
+          them, e.g. over one server per CPU
+          \param addr the IPv4 address to listen at, or empty for
+          all addresses */
+        void bind(int port, bool reusePort = false,
+                const std::string& addr = "");
+
+        /** on Linux, sets the CPU whose incoming connections a listening
+          socket bound with reusePort prefers (SO_INCOMING_CPU), so that
+          connections are accepted on the CPU that handles their
+          network queue
+          \return false if not supported */
+        bool setIncomingCpu(int cpu);
+
+        /** \return the CPU that processed the last incoming packet of
+          the socket (SO_INCOMING_CPU), or -1 if not known */
+        int getIncomingCpu() const;
+
+        /** \return the address and port of the other end, formatted
+          on each call, or an empty string if not known */
+        virtual std::string getInfo() const;
 
         /** tries to send data over the socket
           \param buf pointer to the data
           \param len number of bytes to send
           \return number of bytes sent (or -1 if error) */
-        ssize_t send(const void* buf, size_t len);
+        virtual ssize_t send(const void* buf, size_t len);
 
         /** tries to receive data from the socket
           \param buf pointer to a buffer
           \param len maximum number of bytes that can be read
           \return number of bytes read (or -1 if error)*/
-        ssize_t recv(void* buf, size_t len);
+        virtual ssize_t recv(void* buf, size_t len);
+
+        /** \return true if a failed Socket::send or Socket::recv
+          should be retried later because the non-blocking socket was
+          not ready
+          \param result the value returned by send or recv */
+        virtual bool wouldBlock(ssize_t result) const;
+
+        /** \return the number of bytes that have been received and
+          can be read with Socket::recv although the socket descriptor
+          may not be readable. Regular sockets buffer nothing. */
+        virtual size_t pending() const;
 
         /** a convenience method to use regular sockets and TLS
           sockets interchangeably. For regular sockets, this
@@ -122,12 +175,26 @@ namespace prototls {
          TLS handshake (see TLSSocket::handshake) */
         virtual int handshake();
 
+        /** non-blocking variant of Socket::handshake. For regular
+          sockets, this code does nothing.
+          \param wantWrite set to true if the handshake should be
+          continued when the socket is writable, false if readable
+          \return 0 when done, 1 if the handshake should be continued
+          later, negative on error */
+        virtual int tryHandshake(bool& wantWrite);
+
         /** sets the socket non-blocking meaning that accept,
           connect, read, and write will no longer block */
         void setNonBlocking();
 
+        /** disables (or re-enables) Nagle's algorithm (TCP_NODELAY) so
+          that a flushed message is sent without waiting for the
+          acknowledgement of earlier data */
+        void setNoDelay(bool on = true);
+
         /** accepts an incoming connection 
-          \return a new Socket object */
+          \return a new Socket object, or NULL if the socket is
+          non-blocking and no connection is waiting */
         virtual Socket* accept();
 
         /** closes the socket */
@@ -138,6 +205,10 @@ namespace prototls {
 
         /** \return socket descriptor */ 
         Fd getFd() const;
+
+        /** \return the descriptor that reports room for output: the
+          socket descriptor, unless the socket signals it apart */
+        virtual Fd getOutputFd() const;
     };
 }
 #endif
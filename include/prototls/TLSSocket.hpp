@@ -19,9 +19,18 @@ namespace prototls {
         /**  the Diffie Hellman parameters for a certificate server to use */
         static gnutls_dh_params_t dh_params;
 
+        /** the key that encrypts the session tickets of the server */
+        static gnutls_datum_t ticketKey;
+
         /** GnuTLS connection state */
         gnutls_session_t session;
 
+        /** the name of the host connected to, used for verification */
+        std::string hostname;
+
+        /** initializes GnuTLS connection state in a client mode */
+        void initClient(const std::string& addr);
+
         /** declared but not defined to prevent copying */
         TLSSocket(const TLSSocket& t);
 
@@ -32,8 +41,8 @@ namespace prototls {
           mode on the socket descriptor 'fd' 
           \param fd socket descriptor
           \param parent "parent" socket, inherits socket type 
-          \param info connection endpoint information */
-        TLSSocket(Fd fd, const TLSSocket& parent, const std::string& info);
+          \param address the address of the other end */
+        TLSSocket(Fd fd, const TLSSocket& parent, const Address& address);
 
     public:
         /** container for storing the result of verification the endpoint's
@@ -65,11 +74,15 @@ namespace prototls {
           \param caPath   path to certificate authority certificate file 
           \param crlPath  path to certificate revocation list file
           \param certPath path to own certificate file
-          \param keyPath  path to private key file */
+          \param keyPath  path to private key file
+          \param priority GnuTLS priority string that selects the
+          protocol versions and cipher suites, e.g. "NORMAL" or
+          "SECURE128:-VERS-ALL:+VERS-TLS1.2" */
         static void init(const std::string& caPath, 
                 const std::string& crlPath,
                 const std::string& certPath,
-                const std::string& keyPath);
+                const std::string& keyPath,
+                const std::string& priority = "NORMAL");
 
         /** cleans up GnuTLS global data structures */
         static void deinit();
@@ -77,20 +90,45 @@ namespace prototls {
         /** empty constructor */
         TLSSocket();
 
-        /** empty desctrucotr */
+        /** releases GnuTLS connection state */
         ~TLSSocket();
 
         /** connects to the specified address (GnuTLS client mode) */
         void connect(const std::string& addr, int port);
 
+        /** starts connecting to the specified address without 
+          blocking (GnuTLS client mode), see Socket::connectAsync */
+        bool connectAsync(const std::string& addr, int port);
+
         /** verifies the endpoint's certificate
           \return -1 if an error occurs, 0 otherwise */
         int verify(VerifyResult& result);
 
+        /** \return the data for resuming the session of a connected
+          client with TLSSocket::setSessionData, or empty if none.
+          With TLS 1.3 the data arrives after the handshake, along
+          with the first data received. */
+        std::string getSessionData() const;
+
+        /** asks to resume a session on the next handshake. Call after
+          TLSSocket::connect or TLSSocket::connectAsync.
+          \param data from TLSSocket::getSessionData of an earlier
+          connection to the same server
+          \return false if the data is not valid */
+        bool setSessionData(const std::string& data);
+
+        /** \return true if the handshake resumed an earlier session
+          instead of performing a full one */
+        bool isResumed() const;
+
         /** performs TLS handshake
           \return nonzero if error, zero otherwise */
         int handshake();
 
+        /** performs a step of the TLS handshake on a non-blocking
+          socket, see Socket::tryHandshake */
+        int tryHandshake(bool& wantWrite);
+
         /** tries to send data over the TLS socket
           \param buf pointer to the data
           \param len number of bytes to send
@@ -103,8 +141,17 @@ namespace prototls {
           \return number of bytes read (or -1 if error)*/
         ssize_t recv(void* buf, size_t len);
 
+        /** \return true if a failed send or recv should be retried
+          (with the same data in case of send), see Socket::wouldBlock */
+        bool wouldBlock(ssize_t result) const;
+
+        /** \return the number of decrypted bytes buffered by GnuTLS,
+          see Socket::pending */
+        size_t pending() const;
+
         /** accepts a incoming connection 
-          \return a TLSSocket in server mode */
+          \return a TLSSocket in server mode, or NULL if the socket is
+          non-blocking and no connection is waiting */
         Socket* accept();
 
         /** closes connection */
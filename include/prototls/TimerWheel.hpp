@@ -0,0 +1,85 @@
+/** prototls - Portable asynchronous client/server communications C++ library
+
+     See LICENSE for copyright information.
+*/
+#ifndef _prototls_timerwheel_hpp_
+#define _prototls_timerwheel_hpp_
+#include "prototls/Common.hpp"
+#include <vector>
+namespace prototls {
+    /** Hashed timer wheel. Entries are hashed by their deadline
+        into a ring of slots, each covering 'tick' milliseconds, so
+        adding an entry and expiring it are O(1). Deadlines beyond
+        the span of the ring wrap around and are seen early; the
+        handler is expected to check the actual deadline and add
+        the entry again if it has not passed. Entries cannot be
+        removed, so they should refer to their objects weakly. */
+    template <class T>
+        class TimerWheel {
+            /** entries by slot */
+            std::vector< std::vector<T> > slots;
+
+            /** entries of the slot being expired */
+            std::vector<T> expiring;
+
+            /** milliseconds per slot */
+            uint64_t tick;
+
+            /** the next tick to expire */
+            uint64_t current;
+
+            /** the number of entries */
+            size_t count;
+        public:
+            /** initializes an empty wheel
+             \param tick milliseconds per slot (the resolution)
+             \param slots the number of slots */
+            TimerWheel(int tick, size_t slots)
+                : slots(slots), tick(tick),
+                  current(monotonicMillis() / tick), count(0) {
+            }
+
+            /** adds an entry. An entry whose deadline has passed
+              expires at the next tick.
+             \param t the entry
+             \param deadline the time in milliseconds (see monotonicMillis) */
+            void add(const T& t, uint64_t deadline) {
+                uint64_t at = deadline / tick;
+                if (at < current)
+                    at = current;
+                slots[at % slots.size()].push_back(t);
+                count++;
+            }
+
+            /** \return the number of entries */
+            size_t size() const {
+                return count;
+            }
+
+            /** expires the slots of the ticks that have passed. The
+              handler may add entries, also the expiring ones.
+             \param now the current time in milliseconds
+             \param handler function object called with each entry of
+             the expired slots */
+            template <class F>
+                void expire(uint64_t now, F handler) {
+                    uint64_t end = now / tick;
+                    // a full turn visits every slot once
+                    if (end > current + slots.size())
+                        current = end - slots.size();
+                    while (current < end) {
+                        // entries added by the handler go to the next slots
+                        std::vector<T>& slot = slots[current++ % slots.size()];
+                        if (slot.empty())
+                            continue;
+                        // keep the capacity of both vectors
+                        expiring.swap(slot);
+                        count -= expiring.size();
+                        for (size_t i = 0; i < expiring.size(); i++)
+                            handler(expiring[i]);
+                        expiring.clear();
+                    }
+                }
+        };
+}
+#endif
@@ -0,0 +1,35 @@
+/** prototls - Portable asynchronous client/server communications C++ library
+
+     See LICENSE for copyright information.
+*/
+#include "prototls.hpp"
+using namespace std;
+
+namespace prototls {
+    const size_t BufferPool::inlineCapacity = string().capacity();
+
+    BufferPool::BufferPool(size_t maxHeld_, size_t maxCapacity_)
+        : maxHeld(maxHeld_), maxCapacity(maxCapacity_), held(0) {
+    }
+    void BufferPool::take(string& buf) {
+        if (buf.capacity() > inlineCapacity || buffers.empty())
+            return;
+        buf.swap(buffers.back());
+        buffers.pop_back();
+        held -= buf.capacity();
+    }
+    void BufferPool::give(string& buf) {
+        // the data of a short buffer is stored inline and must go too
+        buf.clear();
+        if (buf.capacity() <= inlineCapacity)
+            return;
+        if (buf.capacity() > maxCapacity
+                || held + buf.capacity() > maxHeld) {
+            string().swap(buf);
+            return;
+        }
+        held += buf.capacity();
+        buffers.push_back(string());
+        buffers.back().swap(buf);
+    }
+}
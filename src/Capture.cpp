@@ -0,0 +1,102 @@
+/** prototls - Portable asynchronous client/server communications C++ library
+
+     See LICENSE for copyright information.
+*/
+#include "prototls.hpp"
+#include <cstring>
+using namespace std;
+
+namespace prototls {
+    /** the first bytes of a capture file, the last one being the
+      version of the format */
+    static const char captureMagic[8] = { 'P', 'T', 'L', 'S', 'C', 'A', 'P', 1 };
+
+    CaptureFile::CaptureFile(const string& path) {
+        file = fopen(path.c_str(), "wb");
+        if (!file)
+            throw SocketExcept("Cannot create capture file");
+        setvbuf(file, NULL, _IOFBF, 65536);
+        fwrite(captureMagic, 1, sizeof(captureMagic), file);
+        last = monotonicMicros();
+    }
+    CaptureFile::~CaptureFile() {
+        fclose(file);
+    }
+    void CaptureFile::writeNumber(uint64_t n) {
+        while (n >= 0x80) {
+            putc((int) (n & 0x7f) | 0x80, file);
+            n >>= 7;
+        }
+        putc((int) n, file);
+    }
+    void CaptureFile::writeHeader(uint32_t connection,
+            CaptureRecord::Kind kind) {
+        uint64_t now = monotonicMicros();
+        writeNumber(now - last);
+        last = now;
+        writeNumber(((uint64_t) connection << 2) | kind);
+    }
+    void CaptureFile::open(uint32_t connection) {
+        boost::mutex::scoped_lock lock(monitor);
+        writeHeader(connection, CaptureRecord::Open);
+    }
+    void CaptureFile::frame(uint32_t connection, const void* data,
+            size_t size) {
+        boost::mutex::scoped_lock lock(monitor);
+        writeHeader(connection, CaptureRecord::Frame);
+        writeNumber(size);
+        fwrite(data, 1, size, file);
+    }
+    void CaptureFile::close(uint32_t connection) {
+        boost::mutex::scoped_lock lock(monitor);
+        writeHeader(connection, CaptureRecord::Close);
+    }
+    void CaptureFile::flush() {
+        boost::mutex::scoped_lock lock(monitor);
+        fflush(file);
+    }
+
+    CaptureReader::CaptureReader(const string& path) : time(0) {
+        file = fopen(path.c_str(), "rb");
+        if (!file)
+            throw SocketExcept("Cannot open capture file");
+        char magic[sizeof(captureMagic)];
+        if (fread(magic, 1, sizeof(magic), file) != sizeof(magic)
+                || memcmp(magic, captureMagic, sizeof(magic))) {
+            fclose(file);
+            throw SocketExcept("Not a capture file");
+        }
+    }
+    CaptureReader::~CaptureReader() {
+        fclose(file);
+    }
+    bool CaptureReader::readNumber(uint64_t& n) {
+        n = 0;
+        for (int shift = 0; shift < 64; shift += 7) {
+            int c = getc(file);
+            if (c == EOF)
+                return false;
+            n |= (uint64_t) (c & 0x7f) << shift;
+            if (!(c & 0x80))
+                return true;
+        }
+        return false;
+    }
+    bool CaptureReader::next(CaptureRecord& r) {
+        uint64_t delta, header;
+        if (!readNumber(delta) || !readNumber(header))
+            return false;
+        time += delta;
+        r.time = time;
+        r.connection = (uint32_t) (header >> 2);
+        r.kind = (CaptureRecord::Kind) (header & 3);
+        r.data.clear();
+        if (r.kind != CaptureRecord::Frame)
+            return true;
+        uint64_t size;
+        if (!readNumber(size))
+            return false;
+        r.data.resize(size);
+        return !size || fread(&r.data[0], 1, size, file) == size;
+    }
+}
@@ -0,0 +1,290 @@
+/** prototls - Portable asynchronous client/server communications C++ library
+
+     See LICENSE for copyright information.
+*/
+#include "prototls.hpp"
+#ifdef __linux__
+#include <boost/thread/mutex.hpp>
+#include <sys/eventfd.h>
+#include <sys/timerfd.h>
+#include <cstring>
+#include <deque>
+using namespace std;
+
+namespace prototls {
+    class MemoryPipe {
+        /** data sent at once */
+        struct Chunk {
+            /** the data */
+            string data;
+
+            /** the position of the next byte to read */
+            size_t pos;
+
+            /** the time the data becomes readable (monotonicMicros) */
+            uint64_t due;
+        };
+
+        /** data flowing to one end */
+        struct Direction {
+            /** the chunks in the order sent */
+            deque<Chunk> chunks;
+
+            /** the number of bytes in 'chunks' not read yet */
+            size_t buffered;
+
+            /** true if no more data will be sent */
+            bool closed;
+
+            Direction() : buffered(0), closed(false) {}
+        };
+
+        /** microseconds sent data takes to become readable */
+        const int latency;
+
+        /** the maximum number of bytes buffered in a direction */
+        const size_t capacity;
+
+        boost::mutex monitor;
+
+        /** data flowing to each end */
+        Direction to[2];
+
+        /** the timerfds of the ends, or -1 for a closed end */
+        int fds[2];
+
+        /** the times the timerfds are armed to expire at, or 0 */
+        uint64_t armed[2];
+
+        /** the output eventfds of the ends, or -1 for a closed end */
+        int outputFds[2];
+
+        /** true if the output eventfd of an end is writable */
+        bool writable[2];
+
+        /** arms the timerfd of an end to expire at 'due', or disarms
+          it if 'due' is 0 */
+        void arm(int end, uint64_t due) {
+            // the descriptor is readable exactly when 'due' has passed,
+            // so reading in pieces costs no system calls
+            if (due == armed[end])
+                return;
+            armed[end] = due;
+            int fd = fds[end];
+            uint64_t expirations;
+            // consume a past expiration, so the descriptor becomes
+            // unreadable if nothing is due
+            if (::read(fd, &expirations, sizeof(expirations)) < 0) {
+                // not expired
+            }
+            struct itimerspec t;
+            memset(&t, 0, sizeof(t));
+            // a time in the past expires at once
+            if (due) {
+                t.it_value.tv_sec = due / 1000000;
+                t.it_value.tv_nsec = (due % 1000000) * 1000 + 1;
+            }
+            timerfd_settime(fd, TFD_TIMER_ABSTIME, &t, NULL);
+        }
+
+        /** makes the descriptor of an end readable when it has data
+          or the end of the stream due */
+        void update(int end) {
+            if (fds[end] < 0)
+                return;
+            Direction& in = to[end];
+            uint64_t due = 0;
+            if (!in.chunks.empty())
+                due = in.chunks.front().due;
+            if (in.closed)
+                due = 1;
+            arm(end, due);
+        }
+
+        /** makes the output descriptor of an end writable when a send
+          would not fail with EAGAIN */
+        void updateOutput(int end) {
+            if (outputFds[end] < 0)
+                return;
+            Direction& out = to[1 - end];
+            bool room = out.closed || out.buffered < capacity;
+            if (room == writable[end])
+                return;
+            writable[end] = room;
+            // an eventfd is writable while its counter is below the
+            // maximum: reading resets the counter, and adding the
+            // maximum to a reset counter blocks writing
+            uint64_t count = 0xfffffffffffffffeULL;
+            if (room) {
+                if (::read(outputFds[end], &count, sizeof(count)) < 0) {
+                    // already reset
+                }
+            } else if (::write(outputFds[end], &count, sizeof(count)) < 0) {
+                // already at the maximum
+            }
+        }
+    public:
+        MemoryPipe(int fdA, int fdB, int outputFdA, int outputFdB,
+                int latency, size_t capacity) :
+            latency(latency), capacity(capacity) {
+            fds[0] = fdA;
+            fds[1] = fdB;
+            armed[0] = armed[1] = 0;
+            outputFds[0] = outputFdA;
+            outputFds[1] = outputFdB;
+            writable[0] = writable[1] = true;
+        }
+
+        /** queues data for the other end, see MemorySocket::send */
+        ssize_t write(int end, const void* buf, size_t len) {
+            boost::mutex::scoped_lock lock(monitor);
+            Direction& out = to[1 - end];
+            if (out.closed) {
+                errno = EPIPE;
+                return -1;
+            }
+            size_t n = min(len, capacity - out.buffered);
+            if (!n) {
+                errno = EAGAIN;
+                return -1;
+            }
+            Chunk c;
+            c.data.assign((const char*) buf, n);
+            c.pos = 0;
+            c.due = monotonicMicros() + latency;
+            out.chunks.push_back(c);
+            out.buffered += n;
+            // a later chunk is not due before the first
+            if (out.chunks.size() == 1)
+                update(1 - end);
+            updateOutput(end);
+            return n;
+        }
+
+        /** takes data that is due, see MemorySocket::recv */
+        ssize_t read(int end, void* buf, size_t len) {
+            boost::mutex::scoped_lock lock(monitor);
+            Direction& in = to[end];
+            uint64_t now = monotonicMicros();
+            size_t n = 0;
+            while (n < len && !in.chunks.empty()
+                    && in.chunks.front().due <= now) {
+                Chunk& c = in.chunks.front();
+                size_t m = min(len - n, c.data.size() - c.pos);
+                memcpy((char*) buf + n, c.data.data() + c.pos, m);
+                c.pos += m;
+                n += m;
+                if (c.pos == c.data.size())
+                    in.chunks.pop_front();
+            }
+            in.buffered -= n;
+            update(end);
+            // room for the other end
+            if (n)
+                updateOutput(1 - end);
+            if (n)
+                return n;
+            if (in.chunks.empty() && in.closed)
+                return 0;
+            errno = EAGAIN;
+            return -1;
+        }
+
+        /** \return the number of bytes due for an end */
+        size_t pending(int end) {
+            boost::mutex::scoped_lock lock(monitor);
+            Direction& in = to[end];
+            uint64_t now = monotonicMicros();
+            size_t n = 0;
+            for (size_t i = 0; i < in.chunks.size()
+                    && in.chunks[i].due <= now; i++)
+                n += in.chunks[i].data.size() - in.chunks[i].pos;
+            return n;
+        }
+
+        /** closes an end: the other end reads the end of the stream
+          after the data sent before, and its sends fail */
+        void close(int end) {
+            boost::mutex::scoped_lock lock(monitor);
+            fds[end] = -1;
+            outputFds[end] = -1;
+            to[end] = Direction();
+            to[end].closed = true;
+            to[1 - end].closed = true;
+            update(1 - end);
+            // its sends fail now
+            updateOutput(1 - end);
+        }
+    };
+
+    MemorySocket::MemorySocket(const boost::shared_ptr<MemoryPipe>& pipe_,
+            int end_, size_t fragment_, Fd fd_, Fd outputFd_)
+        : pipe(pipe_), end(end_), fragment(fragment_), outputFd(outputFd_) {
+        fd = fd_;
+    }
+    Socket::Fd MemorySocket::getOutputFd() const {
+        return outputFd;
+    }
+    string MemorySocket::getInfo() const {
+        return "memory:" + toString(fd);
+    }
+    void MemorySocket::createPair(MemorySocket*& a, MemorySocket*& b,
+            size_t fragment, int latency, size_t capacity) {
+        // a timerfd and an output eventfd for each end
+        int fds[4];
+        for (int i = 0; i < 4; i++) {
+            fds[i] = i < 2
+                ? timerfd_create(CLOCK_MONOTONIC, TFD_NONBLOCK | TFD_CLOEXEC)
+                : eventfd(0, EFD_NONBLOCK | EFD_CLOEXEC);
+            if (fds[i] < 0) {
+                while (i-- > 0)
+                    ::close(fds[i]);
+                throw SocketExcept("timerfd_create or eventfd failed");
+            }
+        }
+        boost::shared_ptr<MemoryPipe> pipe(
+                new MemoryPipe(fds[0], fds[1], fds[2], fds[3], latency,
+                    capacity));
+        a = new MemorySocket(pipe, 0, fragment, fds[0], fds[2]);
+        b = new MemorySocket(pipe, 1, fragment, fds[1], fds[3]);
+    }
+    MemorySocket::~MemorySocket() {
+        MemorySocket::close();
+    }
+    void MemorySocket::connect(const std::string&, int) {
+        throw SocketExcept("MemorySocket cannot connect");
+    }
+    bool MemorySocket::connectAsync(const std::string&, int) {
+        throw SocketExcept("MemorySocket cannot connect");
+    }
+    ssize_t MemorySocket::send(const void* buf, size_t len) {
+        if (!fd) {
+            errno = EBADF;
+            return -1;
+        }
+        return pipe->write(end, buf, len);
+    }
+    ssize_t MemorySocket::recv(void* buf, size_t len) {
+        if (!fd) {
+            errno = EBADF;
+            return -1;
+        }
+        return pipe->read(end, buf, fragment ? min(len, fragment) : len);
+    }
+    size_t MemorySocket::pending() const {
+        return fd ? pipe->pending(end) : 0;
+    }
+    Socket* MemorySocket::accept() {
+        throw SocketExcept("MemorySocket cannot accept");
+    }
+    void MemorySocket::close() {
+        if (!fd)
+            return;
+        // the other end no longer arms the descriptors after this
+        pipe->close(end);
+        ::close(outputFd);
+        outputFd = 0;
+        Socket::close();
+    }
+}
+#endif
@@ -0,0 +1,234 @@
+/** prototls - Portable asynchronous client/server communications C++ library
+
+     See LICENSE for copyright information.
+*/
+#include "prototls.hpp"
+#include <boost/bind.hpp>
+#include <algorithm>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+using namespace std;
+
+namespace prototls {
+    /** appends a metric with its help and type lines */
+    static void metric(string& out, const string& prefix, const char* name,
+            const char* type, const char* help, const string& value) {
+        out += "# HELP " + prefix + "_" + name + " " + help + "\n";
+        out += "# TYPE " + prefix + "_" + name + " " + type + "\n";
+        out += prefix + "_" + name + " " + value + "\n";
+    }
+
+    /** appends an integer metric */
+    static void metric(string& out, const string& prefix, const char* name,
+            const char* type, const char* help, uint64_t value) {
+        metric(out, prefix, name, type, help, toString(value));
+    }
+
+    /** appends the quantiles, sum and count of a histogram to a
+      summary in seconds */
+    static void summary(string& out, const string& name,
+            const string& labels, const Histogram& h) {
+        const char* quantiles[] = { "0.5", "0.9", "0.99", "0.999" };
+        string first = labels.empty() ? "" : labels + ",";
+        string only = labels.empty() ? "" : "{" + labels + "}";
+        char value[32];
+        for (size_t i = 0; i < sizeof(quantiles) / sizeof(quantiles[0]); i++) {
+            snprintf(value, sizeof(value), "%.9f",
+                    h.percentile(atof(quantiles[i])) / 1e9);
+            out += name + "{" + first + "quantile=\"" + quantiles[i]
+                + "\"} " + value + "\n";
+        }
+        snprintf(value, sizeof(value), "%.9f", h.sum() / 1e9);
+        out += name + "_sum" + only + " " + value + "\n";
+        out += name + "_count" + only + " " + toString(h.count()) + "\n";
+    }
+
+    uint64_t Histogram::middle(size_t i) {
+        if (i < 64)
+            return i;
+        int shift = (i - 64) / 32 + 1;
+        uint64_t sub = (i - 64) % 32 + 32;
+        return (sub << shift) + ((1ULL << shift) >> 1);
+    }
+    uint64_t Histogram::percentile(double fraction) const {
+        uint64_t n = total.get();
+        if (!n)
+            return 0;
+        uint64_t rank = std::max<uint64_t>(1, (uint64_t) (fraction * n + 0.5));
+        uint64_t seen = 0;
+        for (size_t i = 0; i < buckets; i++) {
+            seen += counts[i].get();
+            if (seen >= rank)
+                return std::min(middle(i), largest.get());
+        }
+        return largest.get();
+    }
+
+    string ServerTimings::toPrometheus(const string& prefix) const {
+        string out;
+        string name = prefix + "_handler_seconds";
+        out += "# HELP " + name + " Time spent in the handlers of the server.\n";
+        out += "# TYPE " + name + " summary\n";
+        summary(out, name, "handler=\"onPacket\"", onPacket);
+        summary(out, name, "handler=\"onJoin\"", onJoin);
+        summary(out, name, "handler=\"onLeave\"", onLeave);
+        name = prefix + "_serialize_seconds";
+        out += "# HELP " + name + " Time spent serializing messages.\n";
+        out += "# TYPE " + name + " summary\n";
+        summary(out, name, "", serialize);
+        name = prefix + "_phase_seconds";
+        out += "# HELP " + name + " Time spent in the phases of the reactor loop.\n";
+        out += "# TYPE " + name + " summary\n";
+        summary(out, name, "phase=\"poll\"", poll);
+        summary(out, name, "phase=\"wait\"", wait);
+        summary(out, name, "phase=\"timers\"", timers);
+        summary(out, name, "phase=\"accept\"", accept);
+        summary(out, name, "phase=\"join\"", join);
+        summary(out, name, "phase=\"peers\"", peers);
+        summary(out, name, "phase=\"collect\"", collect);
+        return out;
+    }
+
+    ServerStats::ServerStats(const ServerCounters& c) :
+        accepted(c.accepted.get()), joined(c.joined.get()),
+        left(c.left.get()), active(c.active.get()),
+        handshakes(c.handshakes.load(boost::memory_order_relaxed)),
+        handshakeFailures(c.handshakeFailures.load(boost::memory_order_relaxed)),
+        bytesIn(c.bytesIn.get()), bytesOut(c.bytesOut.get()),
+        framesIn(c.framesIn.get()), framesOut(c.framesOut.get()),
+        outputQueued(c.outputQueued.get()), outputPeers(c.outputPeers.get()),
+        buffered(c.buffered.get()), pausedPeers(c.pausedPeers.get()),
+        oversized(c.oversized.get()), loops(c.loops.get()), loopMicros(c.loopMicros.get()) {
+    }
+    string ServerStats::toPrometheus(const string& prefix) const {
+        string out;
+        metric(out, prefix, "peers_accepted_total", "counter",
+                "Connections accepted.", accepted);
+        metric(out, prefix, "peers_joined_total", "counter",
+                "Peers that have joined.", joined);
+        metric(out, prefix, "peers_left_total", "counter",
+                "Peers that have left.", left);
+        metric(out, prefix, "peers_active", "gauge",
+                "Peers connected now.", active);
+        metric(out, prefix, "handshakes_total", "counter",
+                "TLS handshakes that have succeeded.", handshakes);
+        metric(out, prefix, "handshake_failures_total", "counter",
+                "TLS handshakes that have failed.", handshakeFailures);
+        metric(out, prefix, "received_bytes_total", "counter",
+                "Bytes received from peers.", bytesIn);
+        metric(out, prefix, "sent_bytes_total", "counter",
+                "Bytes sent to peers.", bytesOut);
+        metric(out, prefix, "received_frames_total", "counter",
+                "Messages received from peers.", framesIn);
+        metric(out, prefix, "sent_frames_total", "counter",
+                "Messages queued for peers.", framesOut);
+        metric(out, prefix, "output_queued_bytes", "gauge",
+                "Bytes waiting to be sent to peers.", outputQueued);
+        metric(out, prefix, "output_queued_peers", "gauge",
+                "Peers that have bytes waiting to be sent.", outputPeers);
+        metric(out, prefix, "buffered_bytes", "gauge",
+                "Bytes held in the buffers of the peers.", buffered);
+        metric(out, prefix, "paused_peers", "gauge",
+                "Peers not read from because of the memory budget.",
+                pausedPeers);
+        metric(out, prefix, "oversized_peers_total", "counter",
+                "Peers closed for a message larger than their quota.",
+                oversized);
+        metric(out, prefix, "loop_iterations_total", "counter",
+                "Reactor loop iterations.", loops);
+        char seconds[32];
+        snprintf(seconds, sizeof(seconds), "%.6f", loopMicros / 1e6);
+        metric(out, prefix, "loop_busy_seconds_total", "counter",
+                "Time the reactor has spent between waits for the sockets.",
+                seconds);
+        return out;
+    }
+
+    MetricsListener::MetricsListener(const boost::function0<string>& render_)
+        : render(render_), stopped(false) {
+    }
+    MetricsListener::~MetricsListener() {
+        stop();
+    }
+    void MetricsListener::start(int port, const string& addr) {
+        sock.bind(port, false, addr);
+        sock.listen(16);
+        stopped = false;
+        thread.reset(new boost::thread(boost::bind(&MetricsListener::run,
+                        this)));
+    }
+    void MetricsListener::stop() {
+        stopped = true;
+        if (thread) {
+            thread->join();
+            thread.reset();
+        }
+        sock.close();
+    }
+    void MetricsListener::run() {
+        while (!stopped) {
+            // wake up now and then to notice that the listener has
+            // been stopped
+            Select select;
+            select.input(sock.getFd());
+            if (select.select(100) <= 0)
+                continue;
+            try {
+                Socket* s = sock.accept();
+                if (!s)
+                    continue;
+                answer(*s);
+                delete s;
+            } catch (SocketExcept& e) {
+                // the client is gone
+            }
+        }
+    }
+    void MetricsListener::answer(Socket& s) {
+        // a client gets a second to send the request and read the
+        // answer, so that a stuck one does not stop the listener
+        s.setNonBlocking();
+        uint64_t deadline = monotonicMillis() + 1000;
+        string request;
+        char b[1024];
+        while (request.find("\r\n\r\n") == string::npos
+                && request.size() < 8192) {
+            ssize_t result = s.recv(b, sizeof(b));
+            if (result > 0) {
+                request.append(b, result);
+                continue;
+            }
+            if (!s.wouldBlock(result) || monotonicMillis() >= deadline)
+                return;
+            Select select;
+            select.input(s.getFd());
+            select.select(100);
+        }
+        string status, body;
+        if (request.compare(0, 4, "GET ") == 0) {
+            status = "200 OK";
+            body = render();
+        } else {
+            status = "405 Method Not Allowed";
+        }
+        string response = "HTTP/1.0 " + status + "\r\n"
+            "Content-Type: text/plain; version=0.0.4\r\n"
+            "Content-Length: " + toString(body.size()) + "\r\n"
+            "Connection: close\r\n\r\n" + body;
+        size_t sent = 0;
+        while (sent < response.size()) {
+            ssize_t result = s.send(response.data() + sent,
+                    response.size() - sent);
+            if (result > 0) {
+                sent += result;
+                continue;
+            }
+            if (!s.wouldBlock(result) || monotonicMillis() >= deadline)
+                return;
+            Select select;
+            select.output(s.getFd());
+            select.select(100);
+        }
+    }
+}
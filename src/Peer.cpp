@@ -7,52 +7,125 @@
 #include <cstdio>
 using namespace std;
 namespace prototls {
-    Peer::Peer() :  msgSize(0), inBufPos(0) {
+    Peer::Peer() : lastInput(0), lastOutput(0), counters(NULL),
+        capture(NULL), pool(NULL), msgSize(0), inBufPos(0), captureId(0),
+        inputPaused(false) {
 
     }
     void Peer::setup(Socket* s_) {
         sock.reset(s_);
         msgSize = 0;
-        inBuf = "";
+        inBufPos = 0;
+        release(inBuf);
+        release(outBuf);
+        inputPaused = false;
+        lastInput = lastOutput = monotonicMillis();
     }
     void Peer::close() {
+        PROTOTLS_PROBE1(close, sock->getFd());
+        if (capture) {
+            capture->close(captureId);
+            capture = NULL;
+        }
         sock->close();
     }
 
     void Peer::onInput() {
-        char b[1024];
+        char b[16384];
 
-        ssize_t result = sock->recv(b, 1024);
-        if (result <= 0) {
-            close();
-            return;
+        // drop the data taken out already, or the buffer keeps growing
+        // while the reads do not end at message boundaries. Moving the
+        // rest is cheap as it is not larger than what is dropped.
+        if (inBufPos && (size_t) inBufPos >= inBuf.size() - inBufPos) {
+            inBuf.erase(0, inBufPos);
+            inBufPos = 0;
         }
-        inBuf += std::string(b, result);
+        // data buffered by the TLS layer does not make the socket
+        // readable again, so read until it is consumed
+        do {
+            ssize_t result = sock->recv(b, sizeof(b));
+            PROTOTLS_PROBE2(read, sock->getFd(), result);
+            if (result <= 0) {
+                if (!sock->wouldBlock(result))
+                    close();
+                break;
+            }
+            lastInput = monotonicMillis();
+            acquire(inBuf);
+            inBuf.append(b, result);
+            if (counters)
+                counters->bytesIn.add(result);
+        } while (sock->isActive() && sock->pending() > 0);
         if (!msgSize)
             readMessageSize();
     }
     void Peer::readMessageSize() {
 
-        if (!msgSize && inBuf.size() - inBufPos >= 4) {
+        while (!msgSize && inBuf.size() - inBufPos >= 4) {
             msgSize = ntohl(*((uint32_t*) (inBuf.c_str()+inBufPos)));
             inBufPos += 4;
         }
+        if (msgSize)
+            PROTOTLS_PROBE2(frame, sock->getFd(), msgSize);
+        if (!msgSize && inBufPos == inBuf.size()) {
+            inBufPos = 0;
+            release(inBuf);
+        }
     }
     void Peer::send(const google::protobuf::MessageLite& m) {
+        startOutput();
         size_t pos = outBuf.size();
         outBuf += "SIZE";
+        uint64_t start = counters && counters->serialize ? monotonicNanos() : 0;
         if (!m.AppendToString(&outBuf)) {
             throw SocketExcept("Failed to serialize");
         }
+        if (start)
+            counters->serialize->record(monotonicNanos() - start);
         *((uint32_t*) (outBuf.c_str()+pos)) = htonl(outBuf.size()-pos-4);
+        if (counters)
+            counters->framesOut.add();
+    }
+    void Peer::sendFrame(const void* data, size_t size) {
+        uint32_t n = htonl(size);
+        startOutput();
+        outBuf.append((const char*) &n, 4);
+        outBuf.append((const char*) data, size);
+        if (counters)
+            counters->framesOut.add();
+    }
+    void Peer::setCapture(CaptureFile* capture_, uint32_t connection) {
+        capture = capture_;
+        captureId = connection;
+        if (capture)
+            capture->open(captureId);
+    }
+    void Peer::sendHeartbeat() {
+        startOutput();
+        outBuf.append(4, '\0');
     }
     void Peer::flush() {
-        ssize_t result = sock->send(outBuf.c_str(), outBuf.size());
-        if (result < outBuf.size()) {
-            close();
-            return;
-        } 
-        outBuf = "";
+        size_t sent = 0;
+        while (sent < outBuf.size()) {
+            ssize_t result = sock->send(outBuf.c_str() + sent,
+                    outBuf.size() - sent);
+            if (result <= 0) {
+                if (!sock->wouldBlock(result))
+                    close();
+                break;
+            }
+            sent += result;
+        }
+        PROTOTLS_PROBE3(flush, sock->getFd(), sent, outBuf.size() - sent);
+        if (sent) {
+            if (sent == outBuf.size())
+                release(outBuf);
+            else
+                outBuf.erase(0, sent);
+            lastOutput = monotonicMillis();
+            if (counters)
+                counters->bytesOut.add(sent);
+        }
     }
 
 }
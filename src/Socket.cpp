@@ -42,15 +42,17 @@ namespace prototls {
         WSACleanup();
 #endif
     }
-    Socket::Socket(Fd fd_, const Socket& parent, const std::string& info_)
-        : fd(fd_), domain(parent.domain),
+    Socket::Socket(Fd fd_, const Socket& parent, const Address& address_)
+        : fd(fd_), address(address_), domain(parent.domain),
         type(parent.type),
-        protocol(parent.protocol), info(info_) {
+        protocol(parent.protocol) {
         }
     Socket::Socket(int domain_, int type_, int protocol_)
         : fd(0), domain(domain_), type(type_), protocol(protocol_) {
+            memset(&address, 0, sizeof(address));
         } 
     Socket::~Socket() {
+        Socket::close();
     }
     void Socket::close() {
         if (fd) {
@@ -80,12 +82,35 @@ namespace prototls {
 #endif
 
     }
+    void Socket::setNoDelay(bool on) {
+        int optval = on;
+        setsockopt (fd, IPPROTO_TCP, TCP_NODELAY, (char *) &optval,
+                sizeof (int));
+    }
     void Socket::create() {
         if (fd)
             close();
         fd = ::socket(domain, type, protocol);
     }
-    const std::string& Socket::getInfo() const {
+    void Socket::setAddress(const struct sockaddr* addr, socklen_t len) {
+        memset(&address, 0, sizeof(address));
+        memcpy(&address, addr, min((size_t) len, sizeof(address)));
+    }
+    string Socket::getInfo() const {
+        char ipstr[INET6_ADDRSTRLEN];
+        int port;
+        if (address.sa.sa_family == AF_INET) {
+            port = ntohs(address.v4.sin_port);
+            inet_ntop(AF_INET, (void*) &address.v4.sin_addr, ipstr,
+                    sizeof ipstr);
+        } else if (address.sa.sa_family == AF_INET6) {
+            port = ntohs(address.v6.sin6_port);
+            inet_ntop(AF_INET6, (void*) &address.v6.sin6_addr, ipstr,
+                    sizeof ipstr);
+        } else
+            return "";
+        char info[INET6_ADDRSTRLEN + 8];
+        snprintf(info, sizeof info, "%s:%d", ipstr, port);
         return info;
     }
 
@@ -103,7 +128,6 @@ namespace prototls {
         hints.ai_socktype = type;
         hints.ai_flags = 0;
         hints.ai_protocol = protocol;
-        info = addr + ":" + toString(port);
         int s = getaddrinfo(addr.c_str(), toString(port).c_str(), &hints, &result);
         if (s != 0) {
             fprintf(stderr, "getaddrinfo: %s\n", gai_strerror(s));
@@ -111,6 +135,7 @@ namespace prototls {
         }
         if (result) {
             rp = result;
+            setAddress(rp->ai_addr, rp->ai_addrlen);
             if (::connect(fd, rp->ai_addr, rp->ai_addrlen) < 0) {
                 freeaddrinfo(result);
                 throw SocketExcept("Could not connect");
@@ -120,56 +145,130 @@ namespace prototls {
         freeaddrinfo(result);
 
     }
+    bool Socket::connectAsync(const std::string& addr, int port) {
+        if (fd)
+            close();
+        create();
+        setNonBlocking();
+
+        struct addrinfo hints;
+        struct addrinfo* result;
+        memset(&hints, 0, sizeof(struct addrinfo));
+        hints.ai_family = domain;
+        hints.ai_socktype = type;
+        hints.ai_flags = 0;
+        hints.ai_protocol = protocol;
+        int s = getaddrinfo(addr.c_str(), toString(port).c_str(), &hints, &result);
+        if (s != 0 || !result) {
+            fprintf(stderr, "getaddrinfo: %s\n", gai_strerror(s));
+            throw SocketExcept("Could not resolve address");
+        }
+        setAddress(result->ai_addr, result->ai_addrlen);
+        int ret = ::connect(fd, result->ai_addr, result->ai_addrlen);
+#ifdef __linux__
+        bool inProgress = (ret < 0 && errno == EINPROGRESS);
+#endif
+#ifdef WIN32
+        bool inProgress = (ret < 0 && WSAGetLastError() == WSAEWOULDBLOCK);
+#endif
+        freeaddrinfo(result);
+        if (ret == 0)
+            return true;
+        if (!inProgress)
+            throw SocketExcept("Could not connect");
+        return false;
+    }
+    int Socket::finishConnect() {
+        int err = 0;
+        socklen_t len = sizeof(err);
+        if (getsockopt(fd, SOL_SOCKET, SO_ERROR, (char*) &err, &len) < 0)
+            return errno;
+        return err;
+    }
     void Socket::listen(int peers) {
         ::listen(fd, peers);
     }
-    void Socket::bind(int port) {
+    void Socket::bind(int port, bool reusePort, const std::string& addr) {
 
         create();
         struct sockaddr_in servaddr;
         memset(&servaddr, 0, sizeof(servaddr));
         servaddr.sin_family = domain;
-        servaddr.sin_addr.s_addr = htonl(INADDR_ANY);
+        servaddr.sin_addr.s_addr = addr.empty() ? htonl(INADDR_ANY)
+            : inet_addr(addr.c_str());
         servaddr.sin_port = htons(port);
         int optval = 1;
         setsockopt (fd, SOL_SOCKET, SO_REUSEADDR, (char *) &optval,
                 sizeof (int));
+#ifdef SO_REUSEPORT
+        if (reusePort && setsockopt (fd, SOL_SOCKET, SO_REUSEPORT,
+                    (char *) &optval, sizeof (int)))
+            perror("setsockopt SO_REUSEPORT");
+#endif
         if (::bind(fd, (struct sockaddr *) &servaddr, sizeof(servaddr))) {
             perror("bind ");
             throw SocketExcept("Cannot bind");
         }
 
+    }
+    bool Socket::setIncomingCpu(int cpu) {
+#ifdef SO_INCOMING_CPU
+        return !setsockopt (fd, SOL_SOCKET, SO_INCOMING_CPU, (char *) &cpu,
+                sizeof (int));
+#else
+        return false;
+#endif
+    }
+    int Socket::getIncomingCpu() const {
+#ifdef SO_INCOMING_CPU
+        int cpu = -1;
+        socklen_t len = sizeof(cpu);
+        if (getsockopt (fd, SOL_SOCKET, SO_INCOMING_CPU, (char *) &cpu, &len))
+            return -1;
+        return cpu;
+#else
+        return -1;
+#endif
     }
     ssize_t Socket::send(const void* buf, size_t len) {
+#ifdef MSG_NOSIGNAL
+        return ::send(fd, (const char*) buf, len, MSG_NOSIGNAL);
+#else
         return ::send(fd, (const char*) buf, len, 0);
+#endif
     }
     ssize_t Socket::recv(void* buf, size_t len) {
         return ::recv(fd, (char*)buf, len, 0);
     }
+    bool Socket::wouldBlock(ssize_t result) const {
+        if (result >= 0)
+            return false;
+#ifdef WIN32
+        return WSAGetLastError() == WSAEWOULDBLOCK;
+#else
+        return errno == EAGAIN || errno == EWOULDBLOCK || errno == EINTR;
+#endif
+    }
+    size_t Socket::pending() const {
+        return 0;
+    }
     int Socket::handshake() {
         return 0;
     }
-    Socket::Fd Socket::_accept(string& i) {
-        struct sockaddr_storage addr;
-        socklen_t len = sizeof(addr);
-        Fd connFd = ::accept(fd, (struct sockaddr*) &addr, &len);
-        int port;
-        char ipstr[INET6_ADDRSTRLEN];
-        if (addr.ss_family == AF_INET) {
-            struct sockaddr_in *s = (struct sockaddr_in *)&addr;
-            port = ntohs(s->sin_port);
-            inet_ntop(AF_INET, &s->sin_addr, ipstr, sizeof ipstr);
-        } else { // AF_INET6
-            struct sockaddr_in6 *s = (struct sockaddr_in6 *)&addr;
-            port = ntohs(s->sin6_port);
-            inet_ntop(AF_INET6, &s->sin6_addr, ipstr, sizeof ipstr);
-        }
-        i = string(ipstr) + ":" + toString(port);
-        return connFd;
+    int Socket::tryHandshake(bool& wantWrite) {
+        wantWrite = false;
+        return 0;
+    }
+    Socket::Fd Socket::_accept(Address& a) {
+        memset(&a, 0, sizeof(a));
+        socklen_t len = sizeof(a);
+        return ::accept(fd, &a.sa, &len);
     }
     Socket* Socket::accept() {
-        string inf;
+        Address inf;
         Fd connFd = _accept(inf);
+        if (connFd == -1 && wouldBlock(connFd))
+            return NULL;
         if (connFd == -1) {
             perror("accept");
             throw SocketExcept("accept failed");
@@ -182,4 +281,7 @@ namespace prototls {
     Socket::Fd Socket::getFd() const {
         return fd;
     }
+    Socket::Fd Socket::getOutputFd() const {
+        return fd;
+    }
 }
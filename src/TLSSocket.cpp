@@ -13,6 +13,7 @@ namespace prototls {
     gnutls_certificate_credentials_t TLSSocket::xcred;
     gnutls_priority_t TLSSocket::priority_cache;
     gnutls_dh_params_t TLSSocket::dh_params;
+    gnutls_datum_t TLSSocket::ticketKey;
 
     int TLSSocket::verify(VerifyResult& result) {
         const char* hostname = (const char*) gnutls_session_get_ptr (session);
@@ -61,21 +62,38 @@ namespace prototls {
     }
     int TLSSocket::handshake() {
         int ret ;
+        PROTOTLS_PROBE1(handshake__start, fd);
         do {
 
             ret = gnutls_handshake (session);
         } while (ret == GNUTLS_E_AGAIN || ret == GNUTLS_E_INTERRUPTED );
 
+        PROTOTLS_PROBE2(handshake__done, fd, ret);
         if (ret < 0) {
             gnutls_perror(ret);
             Socket::close();
         }
         return ret;
     }
+    int TLSSocket::tryHandshake(bool& wantWrite) {
+        int ret = gnutls_handshake (session);
+        if (ret == GNUTLS_E_AGAIN || ret == GNUTLS_E_INTERRUPTED) {
+            wantWrite = gnutls_record_get_direction(session) == 1;
+            return 1;
+        }
+        PROTOTLS_PROBE2(handshake__done, fd, ret);
+        if (ret < 0) {
+            gnutls_perror(ret);
+            Socket::close();
+            return ret;
+        }
+        return 0;
+    }
     void TLSSocket::init(const std::string& caPath,
             const std::string& crlPath,
             const std::string& certPath,
-            const std::string& keyPath) {
+            const std::string& keyPath,
+            const std::string& priority) {
         gcry_control(GCRYCTL_SET_THREAD_CBS, &gcry_threads_pthread);
         gnutls_global_init();    	
         gnutls_certificate_allocate_credentials(&xcred);
@@ -91,44 +109,79 @@ namespace prototls {
                     crlPath.c_str(), 
                     GNUTLS_X509_FMT_PEM);
         }
-        gnutls_certificate_set_x509_key_file(xcred,
-                certPath.c_str(),
-                keyPath.c_str(),
-                GNUTLS_X509_FMT_PEM);
+        if (!certPath.empty() && gnutls_certificate_set_x509_key_file(xcred,
+                    certPath.c_str(),
+                    keyPath.c_str(),
+                    GNUTLS_X509_FMT_PEM) < 0)
+            throw SocketExcept("Cannot load certificate or key");
         gnutls_dh_params_init(&dh_params);
         gnutls_dh_params_generate2(dh_params, 1024);
-        gnutls_priority_init(&priority_cache, "NORMAL", NULL);
+        if (gnutls_priority_init(&priority_cache, priority.c_str(), NULL) < 0)
+            throw SocketExcept("Invalid priority string");
         gnutls_certificate_set_dh_params(xcred, dh_params);
+        gnutls_session_ticket_key_generate(&ticketKey);
 
     }
     void TLSSocket::deinit() {
+        gnutls_free(ticketKey.data);
+        ticketKey.data = NULL;
+        gnutls_priority_deinit(priority_cache);
+        gnutls_dh_params_deinit(dh_params);
         gnutls_certificate_free_credentials(xcred); 
         gnutls_global_deinit();
     }
-    TLSSocket::TLSSocket(Fd fd_, const TLSSocket& parent, const std::string& info) : Socket(fd_, parent, info) {
-        gnutls_init(&session, GNUTLS_SERVER);
+    TLSSocket::TLSSocket(Fd fd_, const TLSSocket& parent, const Address& address) : Socket(fd_, parent, address), session(NULL) {
+        gnutls_init(&session, GNUTLS_SERVER | GNUTLS_NO_SIGNAL);
 
         gnutls_priority_set(session, priority_cache);
         gnutls_credentials_set(session, GNUTLS_CRD_CERTIFICATE, xcred);
+        gnutls_session_ticket_enable_server(session, &ticketKey);
         gnutls_transport_set_ptr (session, 
                 (gnutls_transport_ptr_t) fd);
 
 
     }
     TLSSocket::~TLSSocket() {
+        if (session)
+            gnutls_deinit(session);
     }
 
-    void TLSSocket::connect(const std::string& addr, int port) {
-        gnutls_init(&session, GNUTLS_CLIENT);
+    void TLSSocket::initClient(const std::string& addr) {
+        if (session)
+            gnutls_deinit(session);
+        gnutls_init(&session, GNUTLS_CLIENT | GNUTLS_NO_SIGNAL);
 
         gnutls_priority_set(session, priority_cache);
         gnutls_credentials_set(session, GNUTLS_CRD_CERTIFICATE, xcred);
+        hostname = addr;
+        gnutls_session_set_ptr(session, (void*)hostname.c_str());
+        gnutls_transport_set_int(session, fd);
+    }
+    void TLSSocket::connect(const std::string& addr, int port) {
         Socket::connect(addr, port);
-        gnutls_session_set_ptr(session, (void*)getInfo().c_str());
-        gnutls_transport_set_ptr (session, 
-                (gnutls_transport_ptr_t) fd);
+        initClient(addr);
+    }
+    bool TLSSocket::connectAsync(const std::string& addr, int port) {
+        bool connected = Socket::connectAsync(addr, port);
+        initClient(addr);
+        return connected;
+    }
+    TLSSocket::TLSSocket() : session(NULL) {
     }
-    TLSSocket::TLSSocket() {
+    std::string TLSSocket::getSessionData() const {
+        gnutls_datum_t data;
+        if (!session || gnutls_session_get_data2(session, &data) < 0)
+            return "";
+        std::string s((const char*) data.data, data.size);
+        gnutls_free(data.data);
+        return s;
+    }
+    bool TLSSocket::setSessionData(const std::string& data) {
+        return session && !gnutls_session_set_data(session, data.data(),
+                data.size());
+    }
+    bool TLSSocket::isResumed() const {
+        return session && gnutls_session_is_resumed(session);
     }
     ssize_t TLSSocket::send(const void* buf, size_t len) {
         return gnutls_record_send(session, buf, len);
@@ -136,13 +189,22 @@ namespace prototls {
     ssize_t TLSSocket::recv(void* buf, size_t len) {
         return gnutls_record_recv(session, buf, len);
     }
+    bool TLSSocket::wouldBlock(ssize_t result) const {
+        return result == GNUTLS_E_AGAIN || result == GNUTLS_E_INTERRUPTED;
+    }
+    size_t TLSSocket::pending() const {
+        return session ? gnutls_record_check_pending(session) : 0;
+    }
     void TLSSocket::close() {
-        gnutls_bye (session, GNUTLS_SHUT_RDWR);
+        if (session)
+            gnutls_bye (session, GNUTLS_SHUT_RDWR);
         Socket::close();
     }
     Socket* TLSSocket::accept() {
-        string inf;
+        Address inf;
         Fd connFd = _accept(inf);
+        if (connFd == -1 && Socket::wouldBlock(connFd))
+            return NULL;
         if (connFd == -1)
             throw SocketExcept("accept failed");
 
@@ -0,0 +1,9 @@
+/** prototls - Portable asynchronous client/server communications C++ library
+
+     See LICENSE for copyright information.
+*/
+
+/* The test sources are linked into one executable; this one
+   defines its entry point. */
+#define BOOST_TEST_MODULE prototls
+#include <boost/test/included/unit_test.hpp>
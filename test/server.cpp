@@ -0,0 +1,342 @@
+/** prototls - Portable asynchronous client/server communications C++ library
+
+     See LICENSE for copyright information.
+*/
+
+/* Tests of Server with peers connected through MemorySocket pairs or
+   over the loopback interface: framing, idle deadlines and the memory
+   budget. The test thread plays the remote ends with raw frames while
+   Server::serve runs in a thread of its own. */
+#include <boost/test/unit_test.hpp>
+#include "prototls.hpp"
+#include <boost/thread.hpp>
+#include <boost/bind.hpp>
+
+using namespace prototls;
+
+/** a message that keeps the bytes of a frame as they are */
+struct RawMessage {
+    std::string data;
+
+    bool ParseFromArray(const void* d, int size) {
+        data.assign((const char*) d, size);
+        return true;
+    }
+};
+
+/** records the frames its peers receive, and answers each with
+  'reply' if set */
+class RecordingServer : public Server<Peer> {
+        mutable boost::mutex monitor;
+        std::vector<std::string> frames;
+        size_t joined;
+        size_t left;
+    public:
+        /** the frame sent back for every frame received, or empty */
+        std::string reply;
+
+        RecordingServer() : Server<Peer>(1), joined(0), left(0) {}
+
+        void onPacket(Peer& p) {
+            RawMessage m;
+            p.recv(m);
+            if (!reply.empty()) {
+                p.sendFrame(reply.data(), reply.size());
+                p.flush();
+            }
+            boost::mutex::scoped_lock lock(monitor);
+            frames.push_back(m.data);
+        }
+        void onJoin(Peer&) {
+            boost::mutex::scoped_lock lock(monitor);
+            joined++;
+        }
+        void onLeave(Peer&) {
+            boost::mutex::scoped_lock lock(monitor);
+            left++;
+        }
+
+        /** \return the frames received so far */
+        std::vector<std::string> getFrames() const {
+            boost::mutex::scoped_lock lock(monitor);
+            return frames;
+        }
+        size_t getFrameCount() const {
+            boost::mutex::scoped_lock lock(monitor);
+            return frames.size();
+        }
+        size_t getJoined() const {
+            boost::mutex::scoped_lock lock(monitor);
+            return joined;
+        }
+        size_t getLeft() const {
+            boost::mutex::scoped_lock lock(monitor);
+            return left;
+        }
+        size_t getPausedPeers() const {
+            return getStats().pausedPeers;
+        }
+};
+
+/** runs Server::serve in a thread for the lifetime of the object */
+class Serving {
+        boost::function0<void> close;
+        boost::thread thread;
+    public:
+        /** \param port the port to listen at, or -1 for peers added
+          with Server::addPeer only */
+        template <class ServerT>
+        Serving(ServerT& server, int port = -1) :
+            close(boost::bind(&ServerT::close, &server)),
+            thread(boost::bind(&ServerT::serve, &server, false, port, 16)) {}
+
+        ~Serving() {
+            close();
+            thread.join();
+        }
+};
+
+void sleepMillis(int msecs) {
+    boost::this_thread::sleep(boost::posix_time::milliseconds(msecs));
+}
+
+/** connects to the server listening at 'port' of this host, retrying
+  while it starts
+ \return the socket, to be deleted by the caller */
+Socket* connect(int port) {
+    for (int attempt = 0; ; attempt++) {
+        Socket* s = new Socket();
+        try {
+            s->connect("127.0.0.1", port);
+            return s;
+        } catch (SocketExcept&) {
+            delete s;
+            if (attempt == 100)
+                throw;
+            sleepMillis(10);
+        }
+    }
+}
+
+/** connects an end of a new pair to the server, see
+  MemorySocket::createPair
+ \return the other end, to be deleted by the caller */
+MemorySocket* connect(RecordingServer& server, size_t fragment = 0,
+        size_t capacity = 1024 * 1024) {
+    MemorySocket* mine;
+    MemorySocket* theirs;
+    MemorySocket::createPair(mine, theirs, fragment, 0, capacity);
+    server.addPeer(theirs);
+    return mine;
+}
+
+/** \return a frame: the payload after its size */
+std::string frame(const std::string& payload) {
+    uint32_t size = htonl(payload.size());
+    return std::string((const char*) &size, 4) + payload;
+}
+
+/** sends all of 'data' */
+void sendAll(Socket& s, const std::string& data) {
+    for (size_t sent = 0; sent < data.size(); ) {
+        ssize_t n = s.send(data.data() + sent, data.size() - sent);
+        BOOST_REQUIRE(n > 0);
+        sent += n;
+    }
+}
+
+/** waits until a count of the server reaches 'n'
+ \return false if it has not within 'msecs' */
+bool waitFor(const boost::function0<size_t>& count, size_t n,
+        int msecs = 2000) {
+    uint64_t deadline = monotonicMillis() + msecs;
+    while (count() < n) {
+        if (monotonicMillis() > deadline)
+            return false;
+        sleepMillis(2);
+    }
+    return true;
+}
+
+BOOST_AUTO_TEST_SUITE(framing)
+
+BOOST_AUTO_TEST_CASE(short_messages_are_delivered_once) {
+    // short buffers keep their data inline, also when given to the pool
+    RecordingServer server;
+    Serving serving(server);
+    boost::scoped_ptr<MemorySocket> s(connect(server));
+    sendAll(*s, frame("x"));
+    BOOST_REQUIRE(waitFor(boost::bind(&RecordingServer::getFrameCount,
+                    &server), 1));
+    sendAll(*s, frame("12345678"));
+    BOOST_REQUIRE(waitFor(boost::bind(&RecordingServer::getFrameCount,
+                    &server), 2));
+    sleepMillis(100);
+    std::vector<std::string> frames = server.getFrames();
+    BOOST_REQUIRE_EQUAL(frames.size(), 2u);
+    BOOST_CHECK_EQUAL(frames[0], "x");
+    BOOST_CHECK_EQUAL(frames[1], "12345678");
+}
+
+BOOST_AUTO_TEST_CASE(frames_arriving_in_pieces_are_joined) {
+    RecordingServer server;
+    Serving serving(server);
+    // the server receives at most 7 bytes at once
+    boost::scoped_ptr<MemorySocket> s(connect(server, 7));
+    std::string large(20000, 'l');
+    sendAll(*s, frame("a") + frame("") + frame(large) + frame("b"));
+    BOOST_REQUIRE(waitFor(boost::bind(&RecordingServer::getFrameCount,
+                    &server), 3));
+    sleepMillis(50);
+    // the empty frame is a heartbeat, not a packet
+    std::vector<std::string> frames = server.getFrames();
+    BOOST_REQUIRE_EQUAL(frames.size(), 3u);
+    BOOST_CHECK_EQUAL(frames[0], "a");
+    BOOST_CHECK(frames[1] == large);
+    BOOST_CHECK_EQUAL(frames[2], "b");
+}
+
+BOOST_AUTO_TEST_SUITE_END()
+
+BOOST_AUTO_TEST_SUITE(timeouts)
+
+BOOST_AUTO_TEST_CASE(silent_peer_is_closed) {
+    RecordingServer server;
+    server.setTimeouts(100, 0, 0);
+    Serving serving(server, 27351);
+    boost::scoped_ptr<Socket> s(connect(27351));
+    uint64_t start = monotonicMillis();
+    BOOST_REQUIRE(waitFor(boost::bind(&RecordingServer::getJoined,
+                    &server), 1));
+    BOOST_REQUIRE(waitFor(boost::bind(&RecordingServer::getLeft, &server),
+                1));
+    BOOST_CHECK_GE(monotonicMillis() - start, 100u);
+}
+
+BOOST_AUTO_TEST_CASE(heartbeats_keep_peer_open) {
+    RecordingServer server;
+    server.setTimeouts(150, 0, 0);
+    Serving serving(server, 27352);
+    boost::scoped_ptr<Socket> s(connect(27352));
+    BOOST_REQUIRE(waitFor(boost::bind(&RecordingServer::getJoined,
+                    &server), 1));
+    for (int i = 0; i < 10; i++) {
+        sendAll(*s, frame(""));
+        sleepMillis(40);
+    }
+    BOOST_CHECK_EQUAL(server.getLeft(), 0u);
+    BOOST_CHECK_EQUAL(server.getFrameCount(), 0u);
+}
+
+BOOST_AUTO_TEST_CASE(peer_not_reading_output_queued_later_is_closed) {
+    // only a write timeout, and no output when the peer joins
+    RecordingServer server;
+    server.setTimeouts(0, 100, 0);
+    server.reply = std::string(64 * 1024, 'r');
+    Serving serving(server);
+    boost::scoped_ptr<MemorySocket> s(connect(server, 0, 4096));
+    BOOST_REQUIRE(waitFor(boost::bind(&RecordingServer::getJoined,
+                    &server), 1));
+    sleepMillis(200);
+    uint64_t start = monotonicMillis();
+    sendAll(*s, frame("request"));
+    BOOST_REQUIRE(waitFor(boost::bind(&RecordingServer::getLeft, &server),
+                1));
+    BOOST_CHECK_GE(monotonicMillis() - start, 100u);
+}
+
+BOOST_AUTO_TEST_SUITE_END()
+
+/** a server watching its sockets with EPoll, whose reactor is kept
+  busy for a while by a frame "block" */
+class BlockingServer : public Server<Peer, EPoll> {
+        mutable boost::mutex monitor;
+        std::vector<std::string> frames;
+    public:
+        BlockingServer() : Server<Peer, EPoll>(1) {}
+
+        void onPacket(Peer& p) {
+            RawMessage m;
+            p.recv(m);
+            if (m.data == "block")
+                sleepMillis(400);
+            boost::mutex::scoped_lock lock(monitor);
+            frames.push_back(m.data);
+        }
+        void onJoin(Peer&) {}
+        void onLeave(Peer&) {}
+
+        /** \return the frames received so far */
+        std::vector<std::string> getFrames() const {
+            boost::mutex::scoped_lock lock(monitor);
+            return frames;
+        }
+        size_t getFrameCount() const {
+            boost::mutex::scoped_lock lock(monitor);
+            return frames.size();
+        }
+};
+
+BOOST_AUTO_TEST_SUITE(pollers)
+
+BOOST_AUTO_TEST_CASE(epoll_watches_descriptor_reused_in_the_same_pass) {
+    BlockingServer server;
+    server.setTimeouts(150, 0, 0);
+    Serving serving(server, 27353);
+    boost::scoped_ptr<Socket> a(connect(27353));
+    sendAll(*a, frame("block"));
+    // while the reactor is blocked, the read timeout of 'a' passes and
+    // 'b' connects: the next pass closes 'a' and accepts 'b', which may
+    // get the descriptor of 'a'
+    sleepMillis(50);
+    boost::scoped_ptr<Socket> b(connect(27353));
+    sendAll(*b, frame("hello"));
+    BOOST_REQUIRE(waitFor(boost::bind(&BlockingServer::getFrameCount,
+                    &server), 2));
+    BOOST_CHECK_EQUAL(server.getFrames()[1], "hello");
+}
+
+BOOST_AUTO_TEST_SUITE_END()
+
+BOOST_AUTO_TEST_SUITE(memory_budget)
+
+BOOST_AUTO_TEST_CASE(message_larger_than_quota_closes_peer) {
+    RecordingServer server;
+    server.setMemoryBudget(0, 1024);
+    Serving serving(server);
+    boost::scoped_ptr<MemorySocket> s(connect(server));
+    sendAll(*s, frame(std::string(4096, 'o')).substr(0, 100));
+    BOOST_REQUIRE(waitFor(boost::bind(&RecordingServer::getLeft, &server),
+                1));
+    BOOST_CHECK_EQUAL(server.getStats().oversized, 1u);
+    BOOST_CHECK_EQUAL(server.getFrameCount(), 0u);
+}
+
+BOOST_AUTO_TEST_CASE(peers_pause_until_partial_message_completes) {
+    RecordingServer server;
+    server.setMemoryBudget(4096, 0);
+    Serving serving(server);
+    boost::scoped_ptr<MemorySocket> a(connect(server));
+    boost::scoped_ptr<MemorySocket> b(connect(server));
+    BOOST_REQUIRE(waitFor(boost::bind(&RecordingServer::getJoined,
+                    &server), 2));
+
+    // a partial message takes the whole budget: its peer keeps reading
+    // to complete it, the other one pauses
+    std::string large = frame(std::string(8192, 'a'));
+    sendAll(*a, large.substr(0, 6000));
+    BOOST_REQUIRE(waitFor(boost::bind(&RecordingServer::getPausedPeers,
+                    &server), 1));
+    sendAll(*b, frame("b"));
+    sleepMillis(100);
+    BOOST_CHECK_EQUAL(server.getFrameCount(), 0u);
+
+    sendAll(*a, large.substr(6000));
+    BOOST_REQUIRE(waitFor(boost::bind(&RecordingServer::getFrameCount,
+                    &server), 2));
+    std::vector<std::string> frames = server.getFrames();
+    BOOST_CHECK_EQUAL(frames[0].size(), 8192u);
+    BOOST_CHECK_EQUAL(frames[1], "b");
+}
+
+BOOST_AUTO_TEST_SUITE_END()
@@ -0,0 +1,170 @@
+/** prototls - Portable asynchronous client/server communications C++ library
+
+     See LICENSE for copyright information.
+*/
+
+/* Tests of the threadpool parts the server relies on: waiting for
+   batches of tasks, adaptive sizing and deadlines, and waiting for the
+   work-stealing pool. */
+#include <boost/test/unit_test.hpp>
+#include <boost/threadpool.hpp>
+#include <boost/atomic.hpp>
+#include <vector>
+
+using namespace boost::threadpool;
+
+namespace {
+    boost::atomic<int> counted(0);
+
+    void count() {
+        counted++;
+    }
+
+    void sleepMillis(int msecs) {
+        boost::this_thread::sleep(boost::posix_time::milliseconds(msecs));
+    }
+
+    /** blocks until 'released' is set */
+    boost::atomic<bool> released(false);
+
+    void blockUntilReleased() {
+        while (!released)
+            sleepMillis(1);
+    }
+
+    /** schedules a task counting to the pool, as a parent task */
+    void scheduleCount(work_stealing_pool* pool) {
+        pool->schedule(&count);
+    }
+
+    boost::atomic<uint64_t> startedAt(0);
+
+    void recordStart() {
+        startedAt = detail::monotonic_millis();
+    }
+
+    boost::atomic<int> dropped(0);
+
+    void countDropped() {
+        dropped++;
+    }
+}
+
+BOOST_AUTO_TEST_SUITE(batches)
+
+BOOST_AUTO_TEST_CASE(wait_returns_when_all_tasks_finished) {
+    fifo_pool pool(2);
+    std::vector<task_func> tasks(100, &count);
+    counted = 0;
+    task_batch batch;
+    BOOST_CHECK_EQUAL(schedule_bulk(pool, tasks.begin(), tasks.end(), batch),
+            100u);
+    batch.wait();
+    BOOST_CHECK(batch.ready());
+    BOOST_CHECK_EQUAL(counted.load(), 100);
+}
+
+BOOST_AUTO_TEST_CASE(timed_wait_times_out_while_a_task_runs) {
+    fifo_pool pool(1);
+    std::vector<task_func> tasks(1, &blockUntilReleased);
+    released = false;
+    task_batch batch;
+    schedule_bulk(pool, tasks.begin(), tasks.end(), batch);
+    BOOST_CHECK(!batch.timed_wait(50));
+    BOOST_CHECK_EQUAL(batch.pending(), 1u);
+    released = true;
+    BOOST_CHECK(batch.timed_wait(2000));
+}
+
+BOOST_AUTO_TEST_CASE(batch_goes_out_of_scope_after_wait) {
+    // the task finishing last must not touch the batch after waking
+    // the waiter, which destroys it
+    fifo_pool pool(4);
+    std::vector<task_func> tasks(4, &count);
+    counted = 0;
+    for (int i = 0; i < 2000; i++) {
+        task_batch batch;
+        schedule_bulk(pool, tasks.begin(), tasks.end(), batch);
+        batch.wait();
+    }
+    pool.wait();
+    BOOST_CHECK_EQUAL(counted.load(), 8000);
+}
+
+BOOST_AUTO_TEST_SUITE_END()
+
+BOOST_AUTO_TEST_SUITE(sizing)
+
+BOOST_AUTO_TEST_CASE(adaptive_pool_grows_when_tasks_wait_too_long) {
+    adaptive_pool pool(0);
+    pool.size_controller().set_limits(1, 2);
+    pool.size_controller().resize(1);
+    released = false;
+    counted = 0;
+    pool.schedule(&blockUntilReleased);
+    sleepMillis(20);
+    // the next task waits behind the busy worker past the target wait
+    pool.schedule(&count);
+    sleepMillis(20);
+    pool.schedule(&count);
+    for (int i = 0; i < 1000 && counted < 2; i++)
+        sleepMillis(1);
+    BOOST_CHECK_EQUAL(counted.load(), 2);
+    BOOST_CHECK_EQUAL(pool.size(), 2u);
+    released = true;
+    pool.wait();
+}
+
+BOOST_AUTO_TEST_CASE(adaptive_pool_grows_while_its_worker_is_blocked) {
+    // no further task is scheduled or finished to trigger the growth
+    adaptive_pool pool(0);
+    pool.size_controller().set_limits(1, 2);
+    pool.size_controller().resize(1);
+    released = false;
+    startedAt = 0;
+    pool.schedule(&blockUntilReleased);
+    sleepMillis(20);
+    uint64_t scheduled = detail::monotonic_millis();
+    pool.schedule(&recordStart);
+    for (int i = 0; i < 1000 && !startedAt; i++)
+        sleepMillis(1);
+    released = true;
+    pool.wait();
+    BOOST_REQUIRE(startedAt != 0);
+    BOOST_CHECK_LT(startedAt - scheduled, 500u);
+    BOOST_CHECK_EQUAL(pool.size(), 2u);
+}
+
+BOOST_AUTO_TEST_CASE(late_deadline_tasks_are_dropped) {
+    edf_pool pool(1);
+    pool.enable_stats();
+    released = false;
+    counted = 0;
+    dropped = 0;
+    pool.schedule(deadline_task_func(10000, &blockUntilReleased));
+    sleepMillis(20);
+    pool.schedule(deadline_task_func(10, &count, &countDropped));
+    pool.schedule(deadline_task_func(10000, &count, &countDropped));
+    sleepMillis(50);
+    released = true;
+    pool.wait();
+    BOOST_CHECK_EQUAL(counted.load(), 1);
+    BOOST_CHECK_EQUAL(dropped.load(), 1);
+    BOOST_CHECK_EQUAL(pool.stats().expired, 1u);
+}
+
+BOOST_AUTO_TEST_SUITE_END()
+
+BOOST_AUTO_TEST_SUITE(work_stealing)
+
+BOOST_AUTO_TEST_CASE(wait_covers_tasks_scheduled_by_tasks) {
+    work_stealing_pool pool(2);
+    counted = 0;
+    for (int i = 0; i < 1000; i++) {
+        pool.schedule(boost::bind(&scheduleCount, &pool));
+        pool.wait();
+        BOOST_REQUIRE_EQUAL(counted.load(), i + 1);
+    }
+}
+
+BOOST_AUTO_TEST_SUITE_END()
@@ -19,6 +19,13 @@
 
 #include "./threadpool/future.hpp"
 #include "./threadpool/pool.hpp"
+#include "./threadpool/work_stealing_pool.hpp"
+#include "./threadpool/inplace_task.hpp"
+#include "./threadpool/task_batch.hpp"
+#include "./threadpool/parallel.hpp"
+#include "./threadpool/timer_queue.hpp"
+#include "./threadpool/affinity.hpp"
+#include "./threadpool/stats.hpp"
 
 #include "./threadpool/pool_adaptors.hpp"
 #include "./threadpool/task_adaptors.hpp"
@@ -0,0 +1,127 @@
+/*! \file
+* \brief CPU affinity.
+*
+* This file contains functions to bind threads to sets of CPUs and a
+* worker initialization function which binds the workers of a pool.
+* Memory which a bound thread allocates and touches first is placed on
+* the NUMA node of its CPUs by the operating system.
+*
+* Use, modification, and distribution are  subject to the
+* Boost Software License, Version 1.0. (See accompanying  file
+* LICENSE_1_0.txt or copy at http://www.boost.org/LICENSE_1_0.txt)
+*
+* http://threadpool.sourceforge.net
+*
+*/
+
+
+#ifndef THREADPOOL_AFFINITY_HPP_INCLUDED
+#define THREADPOOL_AFFINITY_HPP_INCLUDED
+
+
+#include <boost/atomic.hpp>
+#include <boost/smart_ptr.hpp>
+
+#include <vector>
+
+#if defined(__linux__)
+#include <pthread.h>
+#include <sched.h>
+#elif defined(_WIN32)
+#include <windows.h>
+#endif
+
+
+namespace boost { namespace threadpool
+{
+
+  /*! Binds the calling thread to a set of CPUs.
+  * \param cpus The numbers of the CPUs the thread may run on.
+  * \return true if the thread has been bound, false if the set is empty or binding is not supported.
+  */
+  inline bool bind_current_thread(std::vector<int> const & cpus)
+  {
+    if(cpus.empty()) return false;
+
+#if defined(__linux__)
+    cpu_set_t set;
+    CPU_ZERO(&set);
+    for(size_t i = 0; i < cpus.size(); i++)
+    {
+      CPU_SET(cpus[i], &set);
+    }
+    return pthread_setaffinity_np(pthread_self(), sizeof(set), &set) == 0;
+#elif defined(_WIN32)
+    DWORD_PTR mask = 0;
+    for(size_t i = 0; i < cpus.size(); i++)
+    {
+      mask |= static_cast<DWORD_PTR>(1) << cpus[i];
+    }
+    return SetThreadAffinityMask(GetCurrentThread(), mask) != 0;
+#else
+    return false;
+#endif
+  }
+
+
+  /*! Gets the CPU the calling thread is running on.
+  * \return The number of the CPU or -1 if it is not known.
+  */
+  inline int current_cpu()
+  {
+#if defined(__linux__)
+    return sched_getcpu();
+#elif defined(_WIN32)
+    return static_cast<int>(GetCurrentProcessorNumber());
+#else
+    return -1;
+#endif
+  }
+
+
+  /*! \brief Worker initialization function which binds the workers to CPUs.
+  *
+  * Either each worker is bound to the whole set of CPUs, or the workers are
+  * spread over the set, one CPU each, in the order they are created.
+  *
+  * \see thread_pool::set_worker_init
+  */
+  class cpu_affinity
+  {
+    std::vector<int>            m_cpus;
+    bool                        m_spread;
+    shared_ptr<atomic<size_t> > m_next;   //!< The next CPU when spreading. Shared by the copies.
+
+  public:
+    typedef void result_type; //!< Indicates the functor's result type.
+
+    /*! Constructor.
+    * \param cpus The numbers of the CPUs.
+    * \param spread Bind each worker to a single CPU, round robin.
+    */
+    cpu_affinity(std::vector<int> const & cpus, bool spread = false)
+    : m_cpus(cpus)
+    , m_spread(spread)
+    , m_next(new atomic<size_t>(0))
+    {
+    }
+
+    /*! Binds the calling thread.
+    */
+    void operator() (void) const
+    {
+      if(m_spread && !m_cpus.empty())
+      {
+        bind_current_thread(std::vector<int>(1, m_cpus[(*m_next)++ % m_cpus.size()]));
+      }
+      else
+      {
+        bind_current_thread(m_cpus);
+      }
+    }
+  };
+
+
+} } // namespace boost::threadpool
+
+#endif // THREADPOOL_AFFINITY_HPP_INCLUDED
@@ -0,0 +1,134 @@
+/*! \file
+* \brief Recycling allocator for task objects.
+*
+* Memory blocks of a few size classes are kept on free lists after
+* deallocation and handed out again, so that tasks which do not fit into
+* an inline buffer cause no heap allocations once the lists are warm.
+*
+* Use, modification, and distribution are  subject to the
+* Boost Software License, Version 1.0. (See accompanying  file
+* LICENSE_1_0.txt or copy at http://www.boost.org/LICENSE_1_0.txt)
+*
+* http://threadpool.sourceforge.net
+*
+*/
+
+
+#ifndef THREADPOOL_DETAIL_BLOCK_POOL_HPP_INCLUDED
+#define THREADPOOL_DETAIL_BLOCK_POOL_HPP_INCLUDED
+
+
+#include <boost/thread/mutex.hpp>
+#include <boost/utility.hpp>
+
+#include <cstddef>
+#include <new>
+#include <vector>
+
+
+namespace boost { namespace threadpool { namespace detail
+{
+
+  /*! \brief Recycling allocator for memory blocks.
+  *
+  * Requests are rounded up to a power of two between min_block and
+  * max_block bytes. Freed blocks of a size class are kept on its free list
+  * (at most max_free of them) and reused by the next allocation of the same
+  * size class. Larger requests are passed to operator new.
+  *
+  * \remarks The allocator is thread-safe.
+  */
+  class block_pool
+  : private noncopyable
+  {
+  public:
+    static std::size_t const min_block = 128;   //!< Size of the smallest size class.
+    static std::size_t const max_block = 4096;  //!< Size of the largest size class.
+    static std::size_t const max_free  = 1024;  //!< Maximum number of free blocks kept per size class.
+
+    /*! Allocates a memory block.
+    * \param size The number of bytes required.
+    * \return Pointer to the block which is suitably aligned for any object type.
+    */
+    static void* allocate(std::size_t const size)
+    {
+      size_class* sc = get_class(size);
+      if(sc)
+      {
+        mutex::scoped_lock lock(sc->m_mutex);
+        if(!sc->m_free.empty())
+        {
+          void* block = sc->m_free.back();
+          sc->m_free.pop_back();
+          return block;
+        }
+        return ::operator new(sc->m_size);
+      }
+      return ::operator new(size);
+    }
+
+    /*! Releases a memory block.
+    * \param block Pointer to the block returned by allocate.
+    * \param size The number of bytes passed to allocate.
+    */
+    static void deallocate(void* const block, std::size_t const size)
+    {
+      size_class* sc = get_class(size);
+      if(sc)
+      {
+        mutex::scoped_lock lock(sc->m_mutex);
+        if(sc->m_free.size() < max_free)
+        {
+          sc->m_free.push_back(block);
+          return;
+        }
+      }
+      ::operator delete(block);
+    }
+
+  private:
+    struct size_class
+    {
+      mutex               m_mutex;
+      std::size_t         m_size;   //!< Size of the blocks in bytes.
+      std::vector<void*>  m_free;   //!< Free blocks.
+
+      ~size_class()
+      {
+        for(std::size_t i = 0; i < m_free.size(); i++)
+        {
+          ::operator delete(m_free[i]);
+        }
+      }
+    };
+
+    /*! Gets the size class for a request or 0 if it is too large. */
+    static size_class* get_class(std::size_t const size)
+    {
+      static size_class classes[6];   // 128 .. 4096 bytes
+      static bool initialized = init_classes(classes);
+      (void) initialized;
+
+      std::size_t index = 0;
+      for(std::size_t block = min_block; block < size; block <<= 1)
+      {
+        if(++index == sizeof(classes) / sizeof(classes[0])) return 0;
+      }
+      return &classes[index];
+    }
+
+    static bool init_classes(size_class* classes)
+    {
+      std::size_t block = min_block;
+      for(std::size_t i = 0; block <= max_block; i++, block <<= 1)
+      {
+        classes[i].m_size = block;
+      }
+      return true;
+    }
+  };
+
+
+} } } // namespace boost::threadpool::detail
+
+#endif // THREADPOOL_DETAIL_BLOCK_POOL_HPP_INCLUDED
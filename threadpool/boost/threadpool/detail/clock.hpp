@@ -0,0 +1,68 @@
+/*! \file
+* \brief Monotonic clock.
+*
+* Time stamps for measuring intervals, e.g. how long tasks have been
+* waiting. They are not affected by changes of the system time.
+*
+* Use, modification, and distribution are  subject to the
+* Boost Software License, Version 1.0. (See accompanying  file
+* LICENSE_1_0.txt or copy at http://www.boost.org/LICENSE_1_0.txt)
+*
+* http://threadpool.sourceforge.net
+*
+*/
+
+
+#ifndef THREADPOOL_DETAIL_CLOCK_HPP_INCLUDED
+#define THREADPOOL_DETAIL_CLOCK_HPP_INCLUDED
+
+
+#include <boost/cstdint.hpp>
+
+#ifdef _WIN32
+#include <windows.h>
+#else
+#include <time.h>
+#endif
+
+
+namespace boost { namespace threadpool { namespace detail
+{
+
+  /*! Gets the time of a monotonic clock.
+  * \return Milliseconds since an unspecified point in the past.
+  */
+  inline uint64_t monotonic_millis()
+  {
+#ifdef _WIN32
+    return GetTickCount64();
+#else
+    timespec ts;
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+    return static_cast<uint64_t>(ts.tv_sec) * 1000 + ts.tv_nsec / 1000000;
+#endif
+  }
+
+
+  /*! Gets the time of a monotonic clock in microseconds.
+  * \return Microseconds since an unspecified point in the past.
+  */
+  inline uint64_t monotonic_micros()
+  {
+#ifdef _WIN32
+    LARGE_INTEGER frequency, counter;
+    QueryPerformanceFrequency(&frequency);
+    QueryPerformanceCounter(&counter);
+    return static_cast<uint64_t>(counter.QuadPart / frequency.QuadPart) * 1000000
+      + static_cast<uint64_t>(counter.QuadPart % frequency.QuadPart) * 1000000 / frequency.QuadPart;
+#else
+    timespec ts;
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+    return static_cast<uint64_t>(ts.tv_sec) * 1000000 + ts.tv_nsec / 1000;
+#endif
+  }
+
+
+} } } // namespace boost::threadpool::detail
+
+#endif // THREADPOOL_DETAIL_CLOCK_HPP_INCLUDED
@@ -1,7 +1,9 @@
 /*! \file
-* \brief TODO.
+* \brief Shared state of futures.
 *
-* TODO. 
+* The result of an asynchronous task and the continuations waiting
+* for it. Completing and querying a future is based on atomics; a mutex
+* is only locked if a thread blocks waiting for the result.
 *
 * Copyright (c) 2005-2007 Philipp Henkel
 *
@@ -18,145 +20,368 @@
 #define THREADPOOL_DETAIL_FUTURE_IMPL_HPP_INCLUDED
 
 
-#include "locking_ptr.hpp"
-
+#include <boost/atomic.hpp>
+#include <boost/exception_ptr.hpp>
 #include <boost/smart_ptr.hpp>
 #include <boost/optional.hpp>
 #include <boost/thread/mutex.hpp>
 #include <boost/thread/condition.hpp>
 #include <boost/thread/xtime.hpp>
+#include <boost/utility.hpp>
 #include <boost/utility/result_of.hpp>
 #include <boost/static_assert.hpp>
 #include <boost/type_traits.hpp>
 
-namespace boost { namespace threadpool { namespace detail 
+#include <exception>
+
+
+namespace boost { namespace threadpool
 {
 
-template<class Result> 
-class future_impl
+  /*! \brief Exception which is stored in a future whose task has been cancelled
+  * or could not be scheduled.
+  */
+  class future_cancelled
+  : public std::exception
+  {
+  public:
+    char const * what() const throw()
+    {
+      return "boost::threadpool::future_cancelled";
+    }
+  };
+
+
+namespace detail
+{
+
+/*! \brief Callback which is run once, when a future is completed. */
+class future_continuation
+: private noncopyable
 {
 public:
-  typedef Result const & result_type; //!< Indicates the functor's result type.
+  future_continuation* m_next;  //!< The next continuation of the same future.
 
-  typedef Result future_result_type; //!< Indicates the future's result type.
-  typedef future_impl<future_result_type> future_type;
+  future_continuation()
+  : m_next(0)
+  {
+  }
 
-private:
-    volatile bool m_ready;
-    volatile future_result_type m_result;
+  virtual ~future_continuation()
+  {
+  }
 
-    mutable mutex m_monitor;
-    mutable condition m_condition_ready;	
+  virtual void run() = 0;
+};
 
-    volatile bool m_is_cancelled;
-    volatile bool m_executing;
 
-public:
+/*! \brief Result independent part of a future's shared state.
+*
+* A future is pending until its task starts executing. It is completed
+* exactly once, by setting a result or an exception, and the completing
+* thread runs the continuations registered so far. Continuations which are
+* added later are run immediately.
+*/
+class future_base
+: private noncopyable
+{
+  enum state
+  {
+    pending,
+    executing,
+    completing,   //!< The result is being stored.
+    completed
+  };
 
+  atomic<int>                     m_state;
+  atomic<future_continuation*>    m_continuations;  //!< Stack of continuations, or closed() once completed.
+  atomic<unsigned>                m_waiters;        //!< The number of threads blocked in wait().
+  exception_ptr                   m_exception;
 
-public:
+  mutable mutex                   m_monitor;
+  mutable condition               m_condition_ready;
 
-  future_impl()
-  : m_ready(false)
-  , m_is_cancelled(false)
+  static future_continuation* closed()
   {
+    static char marker;
+    return reinterpret_cast<future_continuation*>(&marker);
   }
 
-  bool ready() const volatile
+protected:
+  future_base()
+  : m_state(pending)
+  , m_continuations(0)
+  , m_waiters(0)
   {
-    return m_ready; 
   }
 
-  void wait() const volatile
+  ~future_base()
   {
-    const future_type* self = const_cast<const future_type*>(this);
-    mutex::scoped_lock lock(self->m_monitor);
-
-    while(!m_ready)
+    future_continuation* c = m_continuations.load(memory_order_acquire);
+    while(c && c != closed())
     {
-      self->m_condition_ready.wait(lock);
+      future_continuation* next = c->m_next;
+      delete c;
+      c = next;
     }
   }
 
+  /*! Reserves the right to store the result.
+  * \return true if the future has not been completed or cancelled yet.
+  */
+  bool claim()
+  {
+    int s = m_state.load(memory_order_acquire);
+    while(s == pending || s == executing)
+    {
+      if(m_state.compare_exchange_weak(s, completing, memory_order_acq_rel))
+      {
+        return true;
+      }
+    }
+    return false;
+  }
 
-  bool timed_wait(boost::xtime const & timestamp) const
+  /*! Publishes the stored result, wakes the waiting threads and runs the continuations. */
+  void complete()
   {
-    const future_type* self = const_cast<const future_type*>(this);
-    mutex::scoped_lock lock(self->m_monitor);
+    m_state.store(completed);
+    if(m_waiters.load() > 0)
+    {
+      mutex::scoped_lock lock(m_monitor);
+      m_condition_ready.notify_all();
+    }
 
-    while(!m_ready)
+    // Run the continuations in the order they have been added.
+    future_continuation* c = m_continuations.exchange(closed(), memory_order_acq_rel);
+    future_continuation* ordered = 0;
+    while(c)
     {
-      if(!self->m_condition_ready.timed_wait(lock, timestamp)) return false;
+      future_continuation* next = c->m_next;
+      c->m_next = ordered;
+      ordered = c;
+      c = next;
     }
+    while(ordered)
+    {
+      future_continuation* next = ordered->m_next;
+      ordered->run();
+      delete ordered;
+      ordered = next;
+    }
+  }
 
-    return true;
+  /*! Rethrows the stored exception, if any. The future must be completed. */
+  void rethrow() const
+  {
+    if(m_exception)
+    {
+      rethrow_exception(m_exception);
+    }
   }
 
+public:
+  /*! Marks the future executing, unless it has been cancelled.
+  * \return true if the task should execute.
+  */
+  bool start()
+  {
+    int expected = pending;
+    return m_state.compare_exchange_strong(expected, executing, memory_order_acq_rel);
+  }
 
-  result_type operator()() const volatile
+  void set_exception(exception_ptr const & e)
   {
-    wait();
-/*
-    if( throw_exception_ != 0 )
+    if(claim())
     {
-      throw_exception_( this );
+      m_exception = e;
+      complete();
     }
-*/
- 
-    return *(const_cast<const future_result_type*>(&m_result));
   }
 
+  bool ready() const
+  {
+    return m_state.load(memory_order_acquire) == completed;
+  }
+
+  bool has_exception() const
+  {
+    return ready() && m_exception;
+  }
 
-  void set_value(future_result_type const & r) volatile
+  void wait() const
   {
-    locking_ptr<future_type, mutex> lockedThis(*this, m_monitor);
-    if(!m_ready && !m_is_cancelled)
+    if(ready()) return;
+
+    future_base* self = const_cast<future_base*>(this);
+    ++self->m_waiters;
     {
-      lockedThis->m_result = r;
-      lockedThis->m_ready = true;
-      lockedThis->m_condition_ready.notify_all();
+      mutex::scoped_lock lock(m_monitor);
+      while(!ready())
+      {
+        m_condition_ready.wait(lock);
+      }
+    }
+    --self->m_waiters;
+  }
+
+  bool timed_wait(boost::xtime const & timestamp) const
+  {
+    if(ready()) return true;
+
+    future_base* self = const_cast<future_base*>(this);
+    ++self->m_waiters;
+    {
+      mutex::scoped_lock lock(m_monitor);
+      while(!ready())
+      {
+        if(!m_condition_ready.timed_wait(lock, timestamp)) break;
+      }
     }
+    --self->m_waiters;
+    return ready();
   }
-/*
-  template<class E> void set_exception() // throw()
+
+  /*! Cancels the task unless it has started. The future is completed with future_cancelled.
+  * \return true if the task has been cancelled.
+  */
+  bool cancel()
   {
-    m_impl->template set_exception<E>();
+    int expected = pending;
+    if(m_state.compare_exchange_strong(expected, completing, memory_order_acq_rel))
+    {
+      m_exception = copy_exception(future_cancelled());
+      complete();
+      return true;
+    }
+    return false;
   }
 
-  template<class E> void set_exception( char const * what ) // throw()
+  bool is_cancelled() const
   {
-    m_impl->template set_exception<E>( what );
+    if(!has_exception()) return false;
+    try
+    {
+      rethrow_exception(m_exception);
+    }
+    catch(future_cancelled const &)
+    {
+      return true;
+    }
+    catch(...)
+    {
+    }
+    return false;
   }
+
+  /*! Adds a continuation which is run when the future is completed, or now if it is.
+  * \param continuation The continuation. The future takes ownership of it.
   */
+  void add_continuation(future_continuation* continuation)
+  {
+    future_continuation* head = m_continuations.load(memory_order_acquire);
+    do
+    {
+      if(head == closed())
+      {
+        continuation->run();
+        delete continuation;
+        return;
+      }
+      continuation->m_next = head;
+    }
+    while(!m_continuations.compare_exchange_weak(head, continuation, memory_order_acq_rel));
+  }
+};
 
 
-   bool cancel() volatile
-   {
-     if(!m_ready || m_executing)
-     {
-        m_is_cancelled = true;
-        return true;
-     }
-     else
-     {
-       return false;
-     }
-   }
+template<class Result>
+class future_impl
+: public future_base
+{
+public:
+  typedef Result const & result_type; //!< Indicates the functor's result type.
+
+  typedef Result future_result_type; //!< Indicates the future's result type.
+  typedef future_impl<future_result_type> future_type;
+
+private:
+  optional<future_result_type> m_result;
+
+public:
+  result_type operator()() const
+  {
+    wait();
+    rethrow();
+    return *m_result;
+  }
+
+  void set_value(future_result_type const & r)
+  {
+    if(claim())
+    {
+      m_result = r;
+      complete();
+    }
+  }
+};
 
 
-   bool is_cancelled() const volatile
-   {
-     return m_is_cancelled;
-   }
+template<>
+class future_impl<void>
+: public future_base
+{
+public:
+  typedef void result_type; //!< Indicates the functor's result type.
 
+  typedef void future_result_type; //!< Indicates the future's result type.
+  typedef future_impl<future_result_type> future_type;
 
-   void set_execution_status(bool executing) volatile
-   {
-     m_executing = executing;
-   }
+  void operator()() const
+  {
+    wait();
+    rethrow();
+  }
+
+  void set_value()
+  {
+    if(claim())
+    {
+      complete();
+    }
+  }
 };
 
 
+/*! Executes a function and completes a future with its result or exception. */
+template<class Result, class Function>
+inline void execute_into(future_impl<Result>& future, Function& function)
+{
+  try
+  {
+    future.set_value(function());
+  }
+  catch(...)
+  {
+    future.set_exception(current_exception());
+  }
+}
+
+template<class Function>
+inline void execute_into(future_impl<void>& future, Function& function)
+{
+  try
+  {
+    function();
+    future.set_value();
+  }
+  catch(...)
+  {
+    future.set_exception(current_exception());
+  }
+}
+
+
 template<
   template <typename> class Future,
   typename Function
@@ -174,9 +399,6 @@ public:
   // The task is required to be a nullary function.
   BOOST_STATIC_ASSERT(function_traits<function_type()>::arity == 0);
 
-  // The task function's result type is required not to be void.
-  BOOST_STATIC_ASSERT(!is_void<future_result_type>::value);
-
 private:
   function_type             m_function;
   shared_ptr<future_type>   m_future;
@@ -190,15 +412,9 @@ public:
 
   void operator()()
   {
-    if(m_function)
+    if(m_future->start())
     {
-      m_future->set_execution_status(true);
-      if(!m_future->is_cancelled())
-      {
-        // TODO future exeception handling 
-        m_future->set_value(m_function());
-      }
-      m_future->set_execution_status(false); // TODO consider exceptions
+      execute_into(*m_future, m_function);
     }
   }
 
@@ -211,5 +427,3 @@ public:
 } } } // namespace boost::threadpool::detail
 
 #endif // THREADPOOL_DETAIL_FUTURE_IMPL_HPP_INCLUDED
-
-
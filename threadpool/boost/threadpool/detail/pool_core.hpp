@@ -26,10 +26,16 @@
 
 
 #include "locking_ptr.hpp"
+#include "spin.hpp"
 #include "worker_thread.hpp"
 
+#include "../stats.hpp"
 #include "../task_adaptors.hpp"
 
+#include <boost/atomic.hpp>
+#include <boost/circular_buffer.hpp>
+#include <boost/move/move.hpp>
+#include <boost/optional.hpp>
 #include <boost/thread.hpp>
 #include <boost/thread/exceptions.hpp>
 #include <boost/thread/mutex.hpp>
@@ -39,6 +45,7 @@
 #include <boost/static_assert.hpp>
 #include <boost/type_traits.hpp>
 
+#include <algorithm>
 #include <vector>
 
 
@@ -64,6 +71,33 @@ namespace boost { namespace threadpool { namespace detail
   * \see Tasks: task_func, prio_task_func
   * \see Scheduling policies: fifo_scheduler, lifo_scheduler, prio_scheduler
   */ 
+  /*! Executes a task function object.
+  * \return false if the task has been dropped instead of being executed.
+  */
+  template <typename Task>
+  inline bool invoke_task(Task& task)
+  {
+    task();
+    return true;
+  }
+
+  /*! Executes a task function unless it is empty. */
+  inline bool invoke_task(function0<void>& task)
+  {
+    if(task)
+    {
+      task();
+    }
+    return true;
+  }
+
+  /*! Executes a task function unless its deadline has passed. */
+  inline bool invoke_task(deadline_task_func& task)
+  {
+    return task.invoke();
+  }
+
+
   template <
     typename Task, 
 
@@ -117,12 +151,33 @@ namespace boost { namespace threadpool { namespace detail
     volatile size_t m_worker_count;	
     volatile size_t m_target_worker_count;	
     volatile size_t m_active_worker_count;
+    volatile size_t m_helper_count;   // Threads outside the pool executing a task with try_execute_one.
+    volatile size_t m_waiter_count;   // Threads waiting for m_worker_idle_or_terminated_event.
+    volatile size_t m_spinning_count; // Idle workers spinning before they park.
+    atomic<unsigned> m_idle_spin;     // Iterations an idle worker spins before it parks.
+    atomic<unsigned> m_idle_epoch;    // Changed when a task is scheduled or workers have to terminate, so spinning workers stop.
+    atomic<bool>    m_stats_enabled;
       
 
 
   private: // The following members are accessed only by _one_ thread at the same time:
+    /*! An idle worker parked on its own condition, so that it can be woken up alone. */
+    struct parked_worker
+    {
+      condition m_wakeup_event;
+      bool      m_woken;
+    };
+
     scheduler_type  m_scheduler;
+    std::vector<parked_worker*> m_parked;       // Parked workers, the most recently parked last.
+
+    circular_buffer<uint64_t> m_schedule_times; // Times when the pending tasks were scheduled, oldest first, while statistics are enabled or the size policy measures the queue wait.
+    std::vector<detail::worker_stats*> m_worker_stats; // Counters of the current workers.
+    detail::worker_stats m_helper_stats;        // Counters of the threads calling try_execute_one.
+    pool_stats      m_retired_stats;            // Totals of the workers which have terminated.
+    uint64_t        m_stats_started;
     scoped_ptr<size_policy_type> m_size_policy; // is never null
+    function0<void> m_worker_init;              // Called by each new worker before it executes tasks.
     
     bool  m_terminate_all_workers;								// Indicates if termination of all workers was triggered.
     std::vector<shared_ptr<worker_type> > m_terminated_workers; // List of workers which are terminated but not fully destructed.
@@ -130,7 +185,6 @@ namespace boost { namespace threadpool { namespace detail
   private: // The following members are implemented thread-safe:
     mutable recursive_mutex  m_monitor;
     mutable condition m_worker_idle_or_terminated_event;	// A worker is idle or was terminated.
-    mutable condition m_task_or_terminate_workers_event;  // Task is available OR total worker count should be reduced.
 
   public:
     /// Constructor.
@@ -138,6 +192,14 @@ namespace boost { namespace threadpool { namespace detail
       : m_worker_count(0) 
       , m_target_worker_count(0)
       , m_active_worker_count(0)
+      , m_helper_count(0)
+      , m_waiter_count(0)
+      , m_spinning_count(0)
+      , m_idle_spin(thread::hardware_concurrency() > 1 ? 2000 : 0)
+      , m_idle_epoch(0)
+      , m_stats_enabled(false)
+      , m_schedule_times(64)
+      , m_stats_started(0)
       , m_terminate_all_workers(false)
     {
       pool_type volatile & self_ref = *this;
@@ -150,6 +212,7 @@ namespace boost { namespace threadpool { namespace detail
     /// Destructor.
     ~pool_core()
     {
+      m_size_policy.reset();    // a size policy's own thread may still lock the pool
     }
 
     /*! Gets the size controller which manages the number of threads in the pool. 
@@ -175,6 +238,71 @@ namespace boost { namespace threadpool { namespace detail
       ShutdownPolicy<pool_type>::shutdown(*this);
     }
 
+    /*! Sets the function which each worker created afterwards calls in its thread before executing tasks.
+    * \param init The function, e.g. a cpu_affinity. Its exceptions are ignored.
+    */
+    void set_worker_init(function0<void> const & init) volatile
+    {
+      locking_ptr<pool_type, recursive_mutex> lockedThis(*this, m_monitor);
+      lockedThis->m_worker_init = init;
+    }
+
+    /*! Sets how long idle workers spin before they park. A spinning worker takes a task 
+    * without a context switch, but keeps its CPU busy.
+    * \param spins The number of iterations, 0 to park at once. The default is 2000 on 
+    * multiprocessor systems and 0 otherwise.
+    */
+    void set_idle_spin(unsigned const spins) volatile
+    {
+      const_cast<pool_type*>(this)->m_idle_spin = spins;
+    }
+
+    /*! Enables or disables recording statistics. Enabling restarts them.
+    * \param enabled Indicates if statistics are recorded.
+    */
+    void enable_stats(bool const enabled) volatile
+    {
+      locking_ptr<pool_type, recursive_mutex> lockedThis(*this, m_monitor);
+      if(enabled)
+      {
+        lockedThis->m_retired_stats = pool_stats();
+        lockedThis->m_helper_stats.reset();
+        for(size_t i = 0; i < lockedThis->m_worker_stats.size(); i++)
+        {
+          lockedThis->m_worker_stats[i]->reset();
+        }
+        lockedThis->m_stats_started = detail::monotonic_micros();
+      }
+      // tasks scheduled before are not timed, unless their times are recorded anyway
+      if(!lockedThis->m_size_policy->measures_queue_wait())
+      {
+        lockedThis->m_schedule_times.clear();
+      }
+      lockedThis->m_stats_enabled = enabled;
+    }
+
+    /*! Gets a snapshot of the statistics.
+    * \return The statistics since they have been enabled.
+    */
+    pool_stats stats() const volatile
+    {
+      locking_ptr<const pool_type, recursive_mutex> lockedThis(*this, m_monitor);
+      uint64_t const now = detail::monotonic_micros();
+
+      pool_stats stats = lockedThis->m_retired_stats;
+      lockedThis->m_helper_stats.add_to(stats);
+      for(size_t i = 0; i < lockedThis->m_worker_stats.size(); i++)
+      {
+        lockedThis->m_worker_stats[i]->add_to(stats);
+        stats.worker.push_back(lockedThis->m_worker_stats[i]->snapshot(now));
+      }
+      stats.uptime_usecs = lockedThis->m_stats_enabled && now > lockedThis->m_stats_started ? now - lockedThis->m_stats_started : 0;
+      stats.workers = m_worker_count;
+      stats.active = m_active_worker_count + m_helper_count;
+      stats.pending = lockedThis->m_scheduler.size();
+      return stats;
+    }
+
     /*! Schedules a task for asynchronous execution. The task will be executed once only.
     * \param task The task function object. It should not throw execeptions.
     * \return true, if the task could be scheduled and false otherwise. 
@@ -185,22 +313,82 @@ namespace boost { namespace threadpool { namespace detail
       
       if(lockedThis->m_scheduler.push(task))
       {
-        lockedThis->m_task_or_terminate_workers_event.notify_one();
+        lockedThis->task_scheduled();
+        lockedThis->wake_workers(1);
         return true;
       }
       else
       {
+        lockedThis->task_rejected();
         return false;
       }
     }	
 
+#ifndef BOOST_NO_CXX11_RVALUE_REFERENCES
+    /*! Schedules a task for asynchronous execution by moving it into the scheduler.
+    * The task will be executed once only.
+    * \param task The task function object. It should not throw execeptions.
+    * \return true, if the task could be scheduled and false otherwise. 
+    */  
+    bool schedule(task_type && task) volatile
+    {	
+      locking_ptr<pool_type, recursive_mutex> lockedThis(*this, m_monitor); 
+      
+      if(lockedThis->m_scheduler.push(boost::move(task)))
+      {
+        lockedThis->task_scheduled();
+        lockedThis->wake_workers(1);
+        return true;
+      }
+      else
+      {
+        lockedThis->task_rejected();
+        return false;
+      }
+    }	
+#endif
+
+
+    /*! Schedules a range of tasks for asynchronous execution under one lock. Each task 
+    * will be executed once only. At most as many workers are woken up as there are 
+    * tasks, and none of the busy or spinning ones are.
+    * \param first Iterator to the first task function object.
+    * \param last Iterator past the last task function object.
+    * \return The number of tasks which could be scheduled.
+    */  
+    template <typename InputIterator>
+    size_t schedule_bulk(InputIterator first, InputIterator const last) volatile
+    {	
+      locking_ptr<pool_type, recursive_mutex> lockedThis(*this, m_monitor); 
+
+      size_t scheduled = 0;
+      for(; first != last; ++first)
+      {
+        if(lockedThis->m_scheduler.push(*first))
+        {
+          lockedThis->task_scheduled();
+          scheduled++;
+        }
+        else
+        {
+          lockedThis->task_rejected();
+        }
+      }
+
+      if(scheduled > 0)
+      {
+        lockedThis->wake_workers(scheduled);
+      }
+      return scheduled;
+    }	
+
 
     /*! Returns the number of tasks which are currently executed.
     * \return The number of active tasks. 
     */  
     size_t active() const volatile
     {
-      return m_active_worker_count;
+      return m_active_worker_count + m_helper_count;
     }
 
 
@@ -220,6 +408,7 @@ namespace boost { namespace threadpool { namespace detail
     { 
       locking_ptr<pool_type, recursive_mutex> lockedThis(*this, m_monitor);
       lockedThis->m_scheduler.clear();
+      lockedThis->m_schedule_times.clear();
     }    
 
 
@@ -240,19 +429,20 @@ namespace boost { namespace threadpool { namespace detail
     */     
     void wait(size_t const task_threshold = 0) const volatile
     {
-      const pool_type* self = const_cast<const pool_type*>(this);
+      pool_type* self = const_cast<pool_type*>(this);
       recursive_mutex::scoped_lock lock(self->m_monitor);
+      waiter_guard waiter(*self);
 
       if(0 == task_threshold)
       {
-        while(0 != self->m_active_worker_count || !self->m_scheduler.empty())
+        while(0 != self->m_active_worker_count + self->m_helper_count || !self->m_scheduler.empty())
         { 
           self->m_worker_idle_or_terminated_event.wait(lock);
         }
       }
       else
       {
-        while(task_threshold < self->m_active_worker_count + self->m_scheduler.size())
+        while(task_threshold < self->m_active_worker_count + self->m_helper_count + self->m_scheduler.size())
         { 
           self->m_worker_idle_or_terminated_event.wait(lock);
         }
@@ -268,19 +458,20 @@ namespace boost { namespace threadpool { namespace detail
     */       
     bool wait(xtime const & timestamp, size_t const task_threshold = 0) const volatile
     {
-      const pool_type* self = const_cast<const pool_type*>(this);
+      pool_type* self = const_cast<pool_type*>(this);
       recursive_mutex::scoped_lock lock(self->m_monitor);
+      waiter_guard waiter(*self);
 
       if(0 == task_threshold)
       {
-        while(0 != self->m_active_worker_count || !self->m_scheduler.empty())
+        while(0 != self->m_active_worker_count + self->m_helper_count || !self->m_scheduler.empty())
         { 
           if(!self->m_worker_idle_or_terminated_event.timed_wait(lock, timestamp)) return false;
         }
       }
       else
       {
-        while(task_threshold < self->m_active_worker_count + self->m_scheduler.size())
+        while(task_threshold < self->m_active_worker_count + self->m_helper_count + self->m_scheduler.size())
         { 
           if(!self->m_worker_idle_or_terminated_event.timed_wait(lock, timestamp)) return false;
         }
@@ -290,8 +481,79 @@ namespace boost { namespace threadpool { namespace detail
     }
 
 
+    /*! Executes the next pending task in the calling thread, if there is one. 
+    * A thread which waits for tasks of the pool can help instead of blocking.
+    * \return true if a task has been executed.
+    */     
+    bool try_execute_one() volatile
+    {
+      optional<task_type> task;
+      uint64_t scheduled = 0;
+
+      { // fetch task
+        pool_type* lockedThis = const_cast<pool_type*>(this);
+        recursive_mutex::scoped_lock lock(lockedThis->m_monitor);
+        if(lockedThis->m_scheduler.empty()) return false;
+
+        scheduled = lockedThis->pop_schedule_time();
+        task = boost::move(lockedThis->m_scheduler.top());
+        lockedThis->m_scheduler.pop();
+        lockedThis->m_size_policy->task_finished(lockedThis->m_scheduler.size());
+        m_helper_count++;
+      }
+
+      bool const timed = m_stats_enabled;
+      uint64_t const started = timed ? detail::monotonic_micros() : 0;
+      bool executed;
+      try
+      {
+        executed = invoke_task(*task);
+      }
+      catch(...)
+      {
+        helper_finished();
+        throw;
+      }
+      if(timed)
+      {
+        const_cast<pool_type*>(this)->m_helper_stats.record(scheduled, started, detail::monotonic_micros(), executed);
+      }
+      helper_finished();
+      return true;
+    }
+
+
   private:	
 
+    /*! Lets the size policy check the pending tasks, e.g. from its own thread. Does 
+    * nothing once the workers are terminating.
+    */
+    void check_size() volatile
+    {
+      locking_ptr<pool_type, recursive_mutex> lockedThis(*this, m_monitor);
+      if(!m_terminate_all_workers)
+      {
+        lockedThis->m_size_policy->check();
+      }
+    }
+
+    /*! Gets the time when the oldest pending task was scheduled, for the size policy.
+    * \return The time in microseconds, or 0 if no task is pending or its time is not known.
+    */
+    uint64_t oldest_schedule_time() const volatile
+    {
+      locking_ptr<const pool_type, recursive_mutex> lockedThis(*this, m_monitor);
+      if(lockedThis->m_scheduler.empty() || lockedThis->m_schedule_times.size() < lockedThis->m_scheduler.size()) return 0;
+      return lockedThis->m_schedule_times.front();
+    }
+
+    void helper_finished() volatile
+    {
+      locking_ptr<pool_type, recursive_mutex> lockedThis(*this, m_monitor);
+      m_helper_count--;
+      lockedThis->notify_idle();
+    }
+
 
     void terminate_all_workers(bool const wait) volatile
     {
@@ -301,10 +563,11 @@ namespace boost { namespace threadpool { namespace detail
       self->m_terminate_all_workers = true;
 
       m_target_worker_count = 0;
-      self->m_task_or_terminate_workers_event.notify_all();
+      self->wake_terminating_workers();
 
       if(wait)
       {
+        waiter_guard waiter(*self);
         while(m_active_worker_count > 0)
         {
           self->m_worker_idle_or_terminated_event.wait(lock);
@@ -358,7 +621,7 @@ namespace boost { namespace threadpool { namespace detail
       }
       else
       { // decrease worker count
-        lockedThis->m_task_or_terminate_workers_event.notify_all();   // TODO: Optimize number of notified workers
+        lockedThis->wake_terminating_workers();
       }
 
       return true;
@@ -369,10 +632,11 @@ namespace boost { namespace threadpool { namespace detail
     void worker_died_unexpectedly(shared_ptr<worker_type> worker) volatile
     {
       locking_ptr<pool_type, recursive_mutex> lockedThis(*this, m_monitor);
+      lockedThis->retire_stats(worker->stats());
 
       m_worker_count--;
       m_active_worker_count--;
-      lockedThis->m_worker_idle_or_terminated_event.notify_all();	
+      lockedThis->notify_idle();
 
       if(m_terminate_all_workers)
       {
@@ -384,12 +648,34 @@ namespace boost { namespace threadpool { namespace detail
       }
     }
 
+    // worker started, initialize its thread
+    void init_worker(detail::worker_stats& stats) volatile
+    {
+      function0<void> init;
+      {
+        locking_ptr<pool_type, recursive_mutex> lockedThis(*this, m_monitor);
+        init = lockedThis->m_worker_init;
+        lockedThis->m_worker_stats.push_back(&stats);
+      }
+      if(init)
+      {
+        try
+        {
+          init();
+        }
+        catch(...)
+        {
+        }
+      }
+    }
+
+    // worker left its run loop, it has already been subtracted from m_worker_count
     void worker_destructed(shared_ptr<worker_type> worker) volatile
     {
       locking_ptr<pool_type, recursive_mutex> lockedThis(*this, m_monitor);
-      m_worker_count--;
+      lockedThis->retire_stats(worker->stats());
       m_active_worker_count--;
-      lockedThis->m_worker_idle_or_terminated_event.notify_all();	
+      lockedThis->notify_idle();
 
       if(m_terminate_all_workers)
       {
@@ -398,17 +684,194 @@ namespace boost { namespace threadpool { namespace detail
     }
 
 
-    bool execute_task() volatile
+    /*! Counts a scheduled task and records when it has been scheduled. Requires the lock. */
+    void task_scheduled()
+    {
+      if(m_stats_enabled || m_size_policy->measures_queue_wait())
+      {
+        if(m_schedule_times.full())
+        {
+          m_schedule_times.set_capacity(2 * m_schedule_times.capacity());
+        }
+        m_schedule_times.push_back(detail::monotonic_micros());
+      }
+      if(m_stats_enabled)
+      {
+        m_retired_stats.scheduled++;
+      }
+      m_size_policy->task_scheduled(m_scheduler.size());
+    }
+
+    /*! Counts a task the scheduler has not accepted. Requires the lock. */
+    void task_rejected()
+    {
+      if(m_stats_enabled)
+      {
+        m_retired_stats.rejected++;
+      }
+    }
+
+    /*! Gets the time when the task which is popped next was scheduled. For tasks 
+    * scheduled before statistics have been enabled no time is known. Requires the lock.
+    * \return The time in microseconds or 0.
+    */
+    uint64_t pop_schedule_time()
+    {
+      if(m_schedule_times.empty() || m_schedule_times.size() < m_scheduler.size()) return 0;
+      uint64_t const scheduled = m_schedule_times.front();
+      m_schedule_times.pop_front();
+      return scheduled;
+    }
+
+    /*! Adds the counters of a terminating worker to the totals. Requires the lock. */
+    void retire_stats(detail::worker_stats& stats)
+    {
+      typename std::vector<detail::worker_stats*>::iterator it = std::find(m_worker_stats.begin(), m_worker_stats.end(), &stats);
+      if(it != m_worker_stats.end())
+      {
+        m_worker_stats.erase(it);
+        stats.add_to(m_retired_stats);
+      }
+    }
+
+    /*! Counts a thread waiting for m_worker_idle_or_terminated_event. Requires the lock. */
+    struct waiter_guard
+    {
+      pool_type& m_pool;
+      waiter_guard(pool_type& pool) : m_pool(pool) { m_pool.m_waiter_count++; }
+      ~waiter_guard() { m_pool.m_waiter_count--; }
+    };
+
+    /*! Wakes the threads waiting for workers to become idle or terminate, if there are any. Requires the lock. */
+    void notify_idle()
+    {
+      if(m_waiter_count > 0)
+      {
+        m_worker_idle_or_terminated_event.notify_all();
+      }
+    }
+
+    /*! Wakes one parked worker. Requires the lock.
+    * \return false if no worker is parked.
+    */
+    bool wake_one()
+    {
+      if(m_parked.empty()) return false;
+      parked_worker* worker = m_parked.back();    // the most recently parked one has the warmest cache
+      m_parked.pop_back();
+      worker->m_woken = true;
+      worker->m_wakeup_event.notify_one();
+      return true;
+    }
+
+    /*! Wakes parked workers for new tasks. Spinning workers take tasks 
+    * without being woken up. Requires the lock.
+    * \param tasks The number of new tasks.
+    */
+    void wake_workers(size_t const tasks)
+    {
+      m_idle_epoch++;
+      size_t const pending = m_scheduler.size();
+      for(size_t i = 0; i < tasks && pending - i > m_spinning_count; i++)
+      {
+        if(!wake_one()) break;
+      }
+    }
+
+    /*! Wakes as many parked workers as have to terminate. Requires the lock. */
+    void wake_terminating_workers()
+    {
+      m_idle_epoch++;
+      for(size_t i = m_target_worker_count; i < m_worker_count; i++)
+      {
+        if(!wake_one()) break;
+      }
+    }
+
+    /*! Spins without the lock until a task may be available or workers have to terminate.
+    * \param lock The locked lock of the monitor.
+    * \return true if the worker should check for a task again.
+    */
+    bool spin(recursive_mutex::scoped_lock& lock)
+    {
+      unsigned const spins = m_idle_spin;
+      if(spins == 0) return false;
+
+      unsigned const epoch = m_idle_epoch;
+      m_spinning_count++;
+      lock.unlock();
+      bool changed = false;
+      for(unsigned i = 0; i < spins && !changed; i++)
+      {
+        cpu_relax();
+        changed = m_idle_epoch.load(memory_order_relaxed) != epoch;
+      }
+      lock.lock();
+      m_spinning_count--;
+      return changed || !m_scheduler.empty();
+    }
+
+    /*! Blocks the worker until it is woken up or the size policy's idle timeout elapses.
+    * \param lock The locked lock of the monitor.
+    * \return false if the idle timeout has elapsed.
+    */
+    bool park(recursive_mutex::scoped_lock& lock)
+    {
+      parked_worker self;
+      self.m_woken = false;
+      m_parked.push_back(&self);
+
+      unsigned const idle_timeout = m_size_policy->idle_timeout();
+      uint64_t const deadline = detail::monotonic_millis() + idle_timeout;
+      while(!self.m_woken)
+      {
+        if(idle_timeout == 0)
+        {
+          self.m_wakeup_event.wait(lock);
+          continue;
+        }
+        uint64_t const now = detail::monotonic_millis();
+        if(now >= deadline)
+        {
+          break;
+        }
+        // a relative timeout is measured on the monotonic clock, unlike a system_time
+        self.m_wakeup_event.timed_wait(lock, posix_time::milliseconds(deadline - now));
+      }
+
+      if(!self.m_woken)
+      {
+        m_parked.erase(std::find(m_parked.begin(), m_parked.end(), &self));
+        return false;
+      }
+      return true;
+    }
+
+
+    /*! Fetches and executes the next task. Waits if no task is pending.
+    * \param task_finished Indicates that the calling worker has finished a task since its last call.
+    * \param stats The calling worker's counters.
+    * \return false if the worker has to terminate.
+    */
+    bool execute_task(bool const task_finished, detail::worker_stats& stats) volatile
     {
-      function0<void> task;
+      optional<task_type> task;
+      uint64_t scheduled = 0;
 
       { // fetch task
         pool_type* lockedThis = const_cast<pool_type*>(this);
         recursive_mutex::scoped_lock lock(lockedThis->m_monitor);
 
+        // the size policy learns about finished tasks here to save a lock per task
+        if(task_finished)
+        {
+          lockedThis->m_size_policy->task_finished(lockedThis->m_scheduler.size());
+        }
+
         // decrease number of threads if necessary
         if(m_worker_count > m_target_worker_count)
         {	
+          m_worker_count--;   // counted down now, so that no other worker terminates for it
           return false;	// terminate worker
         }
 
@@ -419,25 +882,50 @@ namespace boost { namespace threadpool { namespace detail
           // decrease number of workers if necessary
           if(m_worker_count > m_target_worker_count)
           {	
+            m_worker_count--;
             return false;	// terminate worker
           }
           else
           {
             m_active_worker_count--;
-            lockedThis->m_worker_idle_or_terminated_event.notify_all();	
-            lockedThis->m_task_or_terminate_workers_event.wait(lock);
+            lockedThis->notify_idle();
+
+            bool idle_timed_out = false;
+            if(!lockedThis->spin(lock))
+            {
+              idle_timed_out = !lockedThis->park(lock);
+            }
             m_active_worker_count++;
+
+            // retire the worker if the size policy does not need it any more
+            if(idle_timed_out 
+              && lockedThis->m_scheduler.empty() 
+              && !m_terminate_all_workers
+              && lockedThis->m_size_policy->retire_idle_worker())
+            {
+              m_worker_count--;
+              m_target_worker_count = m_worker_count;
+              return false;	// terminate worker
+            }
           }
         }
 
-        task = lockedThis->m_scheduler.top();
+        // move the task out of the scheduler instead of copying it
+        scheduled = lockedThis->pop_schedule_time();
+        task = boost::move(lockedThis->m_scheduler.top());
         lockedThis->m_scheduler.pop();
       }
 
       // call task function
-      if(task)
+      if(m_stats_enabled)
+      {
+        uint64_t const started = detail::monotonic_micros();
+        bool const executed = invoke_task(*task);
+        stats.record(scheduled, started, detail::monotonic_micros(), executed);
+      }
+      else
       {
-        task();
+        invoke_task(*task);
       }
  
       //guard->disable();
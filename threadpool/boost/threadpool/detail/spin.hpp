@@ -0,0 +1,43 @@
+/*! \file
+* \brief Busy waiting.
+*
+* The pause hint for spin loops, which lets the other hardware thread of
+* the core run and saves power while a thread polls for work.
+*
+* Use, modification, and distribution are  subject to the
+* Boost Software License, Version 1.0. (See accompanying  file
+* LICENSE_1_0.txt or copy at http://www.boost.org/LICENSE_1_0.txt)
+*
+* http://threadpool.sourceforge.net
+*
+*/
+
+
+#ifndef THREADPOOL_DETAIL_SPIN_HPP_INCLUDED
+#define THREADPOOL_DETAIL_SPIN_HPP_INCLUDED
+
+
+#if defined(_MSC_VER) && (defined(_M_IX86) || defined(_M_X64))
+#include <intrin.h>
+#endif
+
+
+namespace boost { namespace threadpool { namespace detail
+{
+
+  /*! Tells the processor that the calling thread is spinning. */
+  inline void cpu_relax()
+  {
+#if defined(__GNUC__) && (defined(__i386__) || defined(__x86_64__))
+    __builtin_ia32_pause();
+#elif defined(__GNUC__) && defined(__aarch64__)
+    __asm__ __volatile__("yield");
+#elif defined(_MSC_VER) && (defined(_M_IX86) || defined(_M_X64))
+    _mm_pause();
+#endif
+  }
+
+
+} } } // namespace boost::threadpool::detail
+
+#endif // THREADPOOL_DETAIL_SPIN_HPP_INCLUDED
@@ -19,6 +19,7 @@
 
 
 #include "scope_guard.hpp"
+#include "../stats.hpp"
 
 #include <boost/smart_ptr.hpp>
 #include <boost/thread.hpp>
@@ -51,6 +52,7 @@ namespace boost { namespace threadpool { namespace detail
   private:
     shared_ptr<pool_type>      m_pool;     //!< Pointer to the pool which created the worker.
     shared_ptr<boost::thread>  m_thread;   //!< Pointer to the thread which executes the run loop.
+    worker_stats               m_stats;    //!< Counters of the tasks executed by the worker.
 
     
     /*! Constructs a new worker. 
@@ -77,15 +79,28 @@ namespace boost { namespace threadpool { namespace detail
 	  */
 	  void run()
 	  { 
+		  m_pool->init_worker(m_stats);
+
 		  scope_guard notify_exception(bind(&worker_thread::died_unexpectedly, this));
 
-		  while(m_pool->execute_task()) {}
+		  if(m_pool->execute_task(false, m_stats))
+		  {
+			  while(m_pool->execute_task(true, m_stats)) {}
+		  }
 
 		  notify_exception.disable();
 		  m_pool->worker_destructed(this->shared_from_this());
 	  }
 
 
+	  /*! Gets the counters of the tasks executed by the worker.
+	  */
+	  worker_stats& stats()
+	  {
+		  return m_stats;
+	  }
+
+
 	  /*! Joins the worker's thread.
 	  */
 	  void join()
@@ -1,7 +1,9 @@
 /*! \file
-* \brief TODO.
+* \brief Futures.
 *
-* TODO. 
+* This file contains the future returned when a function with a result
+* is scheduled, continuations which are scheduled onto a pool when a future
+* is completed, and the when_all and when_any combinators.
 *
 * Copyright (c) 2005-2007 Philipp Henkel
 *
@@ -17,36 +19,41 @@
 #define THREADPOOL_FUTURE_HPP_INCLUDED
 
 
-  
+
 #include "./detail/future.hpp"
 #include <boost/utility/enable_if.hpp>
 
-//#include "pool.hpp"
-//#include <boost/utility.hpp>
-
-//#include <boost/thread/mutex.hpp>
+#include <iterator>
+#include <stdexcept>
+#include <vector>
 
 
 namespace boost { namespace threadpool
 {
 
-  /*! \brief Experimental. Do not use in production code. TODO. 
+  /*! \brief The result of an asynchronous function.
   *
-  * TODO Future
+  * A future refers to the shared state which is completed by the task, either
+  * with the function's result or with the exception it has thrown. Copies of a
+  * future refer to the same state. Getting the result blocks until the state is
+  * completed and rethrows the exception, if any.
   *
-  * \see TODO
+  * Instead of blocking, a continuation can be attached with then(). It is
+  * scheduled onto a pool when the future is completed.
   *
-  */ 
+  * \see schedule, when_all, when_any
+  *
+  */
 
 
-template<class Result> 
+template<class Result>
 class future
 {
 private:
   shared_ptr<detail::future_impl<Result> > m_impl;
 
 public:
-    typedef Result const & result_type; //!< Indicates the functor's result type.
+    typedef typename detail::future_impl<Result>::result_type result_type; //!< Indicates the functor's result type.
     typedef Result future_result_type; //!< Indicates the future's result type.
 
 
@@ -68,6 +75,14 @@ public:
     return m_impl->ready();
   }
 
+  /*! Indicates that the function has thrown an exception or has been cancelled.
+  * \return true if the future is ready and getting the result throws.
+  */
+  bool has_exception() const
+  {
+    return m_impl->has_exception();
+  }
+
   void wait() const
   {
     m_impl->wait();
@@ -78,16 +93,19 @@ public:
     return m_impl->timed_wait(timestamp);
   }
 
-   result_type operator()() // throw( thread::cancelation_exception, ... )
+   result_type operator()() const // throws the function's exception or future_cancelled
    {
      return (*m_impl)();
    }
 
-   result_type get() // throw( thread::cancelation_exception, ... )
+   result_type get() const // throws the function's exception or future_cancelled
    {
      return (*m_impl)();
    }
 
+   /*! Cancels the task unless it has started. Getting the result of a cancelled future throws future_cancelled.
+   * \return true if the task has been cancelled.
+   */
    bool cancel()
    {
      return m_impl->cancel();
@@ -97,14 +115,224 @@ public:
    {
      return m_impl->is_cancelled();
    }
+
+  /*! Schedules a function onto a pool when this future is completed.
+  * \param pool The pool which executes the function. It must exist until the function has been scheduled.
+  * \param function The function object. It is called with this future, which is ready then.
+  * \return The future of the function's result. It is completed with future_cancelled if the function could not be scheduled.
+  */
+  template<class Pool, class Function>
+  future<typename result_of<Function(future)>::type> then(Pool& pool, Function const & function) const;
+
+  // only for internal usage
+  void add_continuation(detail::future_continuation* continuation) const
+  {
+    m_impl->add_continuation(continuation);
+  }
 };
 
 
+namespace detail
+{
+  /*! \brief Task which calls a continuation function with the completed future. */
+  template<class Function, class Source>
+  class then_task_func
+  {
+  public:
+    typedef void result_type;
+    typedef typename result_of<Function(Source)>::type future_result_type;
+
+  private:
+    Function                                      m_function;
+    Source                                        m_source;
+    shared_ptr<future_impl<future_result_type> >  m_future;
+
+    struct call
+    {
+      then_task_func& m_task;
+      typedef future_result_type result_type;
+      call(then_task_func& task) : m_task(task) {}
+      result_type operator()() { return m_task.m_function(m_task.m_source); }
+    };
+
+  public:
+    then_task_func(Function const & function, Source const & source, shared_ptr<future_impl<future_result_type> > const & future)
+    : m_function(function)
+    , m_source(source)
+    , m_future(future)
+    {
+    }
+
+    void operator()()
+    {
+      if(m_future->start())
+      {
+        call c(*this);
+        execute_into(*m_future, c);
+      }
+    }
+
+    /*! Completes the future with future_cancelled instead of executing. */
+    void cancel()
+    {
+      m_future->cancel();
+    }
+  };
+
+
+  /*! \brief Continuation which schedules a then_task_func. */
+  template<class Pool, class Function, class Source>
+  class then_continuation
+  : public future_continuation
+  {
+    typedef then_task_func<Function, Source> task_type;
+
+    Pool*       m_pool;
+    task_type   m_task;
+
+  public:
+    then_continuation(Pool& pool, task_type const & task)
+    : m_pool(&pool)
+    , m_task(task)
+    {
+    }
+
+    void run()
+    {
+      if(!m_pool->schedule(m_task))
+      {
+        m_task.cancel();
+      }
+    }
+  };
+
+
+  /*! \brief State of a when_all combination. */
+  template<class Future>
+  struct when_all_state
+  {
+    atomic<size_t>                                    m_remaining;
+    std::vector<Future>                               m_futures;
+    shared_ptr<future_impl<std::vector<Future> > >    m_result;
+  };
+
+  template<class Future>
+  class when_all_continuation
+  : public future_continuation
+  {
+    shared_ptr<when_all_state<Future> > m_state;
+
+  public:
+    when_all_continuation(shared_ptr<when_all_state<Future> > const & state)
+    : m_state(state)
+    {
+    }
+
+    void run()
+    {
+      if(--m_state->m_remaining == 0)
+      {
+        m_state->m_result->set_value(m_state->m_futures);
+      }
+    }
+  };
+
+
+  /*! \brief Continuation of a when_any combination. */
+  class when_any_continuation
+  : public future_continuation
+  {
+    shared_ptr<future_impl<size_t> > m_result;
+    size_t                           m_index;
+
+  public:
+    when_any_continuation(shared_ptr<future_impl<size_t> > const & result, size_t index)
+    : m_result(result)
+    , m_index(index)
+    {
+    }
+
+    void run()
+    {
+      m_result->set_value(m_index);   // only the first one is stored
+    }
+  };
 
+} // namespace detail
 
 
+template<class Result>
 template<class Pool, class Function>
-typename disable_if < 
+future<typename result_of<Function(future<Result>)>::type> future<Result>::then(Pool& pool, Function const & function) const
+{
+  typedef detail::then_task_func<Function, future> task_type;
+  typedef typename task_type::future_result_type future_result_type;
+
+  shared_ptr<detail::future_impl<future_result_type> > impl(new detail::future_impl<future_result_type>);
+  add_continuation(new detail::then_continuation<Pool, Function, future>(pool, task_type(function, *this, impl)));
+  return future<future_result_type>(impl);
+}
+
+
+/*! Combines futures into one which is completed when all of them are.
+* \param first Iterator to the first future.
+* \param last Iterator past the last future.
+* \return The future of the combined futures, which are all ready when it is.
+*/
+template<class InputIterator>
+future<std::vector<typename std::iterator_traits<InputIterator>::value_type> >
+when_all(InputIterator first, InputIterator last)
+{
+  typedef typename std::iterator_traits<InputIterator>::value_type future_type;
+  typedef std::vector<future_type> result_type;
+
+  shared_ptr<detail::when_all_state<future_type> > state(new detail::when_all_state<future_type>);
+  state->m_futures.assign(first, last);
+  state->m_result.reset(new detail::future_impl<result_type>);
+  future<result_type> res(state->m_result);
+
+  // one extra count, so that the result is not set before all continuations are added
+  state->m_remaining = state->m_futures.size() + 1;
+  for(size_t i = 0; i < state->m_futures.size(); i++)
+  {
+    state->m_futures[i].add_continuation(new detail::when_all_continuation<future_type>(state));
+  }
+  if(--state->m_remaining == 0)
+  {
+    state->m_result->set_value(state->m_futures);
+  }
+  return res;
+}
+
+
+/*! Combines futures into one which is completed when any of them is.
+* \param first Iterator to the first future.
+* \param last Iterator past the last future.
+* \return The future of the index of the first completed future. It is completed with std::invalid_argument if the range is empty.
+*/
+template<class InputIterator>
+future<size_t> when_any(InputIterator first, InputIterator last)
+{
+  shared_ptr<detail::future_impl<size_t> > impl(new detail::future_impl<size_t>);
+  future<size_t> res(impl);
+
+  size_t index = 0;
+  for(; first != last; ++first, ++index)
+  {
+    first->add_continuation(new detail::when_any_continuation(impl, index));
+  }
+  if(index == 0)
+  {
+    impl->set_exception(copy_exception(std::invalid_argument("when_any of no futures")));
+  }
+  return res;
+}
+
+
+
+
+template<class Pool, class Function>
+typename disable_if <
   is_void< typename result_of< Function() >::type >,
   future< typename result_of< Function() >::type >
 >::type
@@ -117,23 +345,13 @@ schedule(Pool& pool, const Function& task)
   future <future_result_type> res(impl);
 
   // schedule future impl
-  pool.schedule(detail::future_impl_task_func<detail::future_impl, Function>(task, impl));
+  if(!pool.schedule(detail::future_impl_task_func<detail::future_impl, Function>(task, impl)))
+  {
+    impl->cancel();
+  }
 
   // return future
   return res;
-
-/*
- TODO
-  if(pool->schedule(bind(&Future::run, future)))
-  {
-    return future;
-  }
-  else
-  {
-    // construct empty future
-    return error_future;
-  }
-  */
 }
 
 
@@ -141,4 +359,3 @@ schedule(Pool& pool, const Function& task)
 } } // namespace boost::threadpool
 
 #endif // THREADPOOL_FUTURE_HPP_INCLUDED
-
@@ -0,0 +1,282 @@
+/*! \file
+* \brief Allocation-free task function object.
+*
+* This file contains a move-only task type which stores the wrapped
+* function object in an inline buffer instead of on the heap.
+*
+* Use, modification, and distribution are  subject to the
+* Boost Software License, Version 1.0. (See accompanying  file
+* LICENSE_1_0.txt or copy at http://www.boost.org/LICENSE_1_0.txt)
+*
+* http://threadpool.sourceforge.net
+*
+*/
+
+
+#ifndef THREADPOOL_INPLACE_TASK_HPP_INCLUDED
+#define THREADPOOL_INPLACE_TASK_HPP_INCLUDED
+
+
+#include "./detail/block_pool.hpp"
+
+#include <boost/move/move.hpp>
+#include <boost/static_assert.hpp>
+#include <boost/type_traits.hpp>
+#include <boost/utility/enable_if.hpp>
+
+#include <cstddef>
+#include <new>
+
+
+/*! Size of the inline buffer of inplace_task in bytes. */
+#ifndef BOOST_THREADPOOL_INPLACE_TASK_SIZE
+#define BOOST_THREADPOOL_INPLACE_TASK_SIZE 64
+#endif
+
+
+namespace boost { namespace threadpool
+{
+
+  /*! \brief Move-only task function object with an inline buffer.
+  *
+  * This function object wraps a nullary function which returns void, like
+  * task_func. Function objects of up to Capacity bytes (with a non-throwing
+  * copy constructor) are stored inside the task, larger ones in a block taken
+  * from detail::block_pool. Creating, scheduling and executing the task
+  * therefore performs no heap allocations in the steady state.
+  *
+  * The task is movable but not copyable. Pools need rvalue references to
+  * schedule it.
+  *
+  * \param Capacity Size of the inline buffer in bytes.
+  *
+  * \see inplace_pool
+  */
+  template <std::size_t Capacity>
+  class basic_inplace_task
+  {
+    BOOST_MOVABLE_BUT_NOT_COPYABLE(basic_inplace_task)
+
+  public:
+    typedef void result_type; //!< Indicates the functor's result type.
+
+  private:
+    typedef typename type_with_alignment<alignment_of<long double>::value>::type align_type;
+
+    /*! Operations on the stored function object. */
+    struct operations
+    {
+      void (*invoke)(void* storage);
+      void (*move)(void* to, void* from);   //!< Moves the function to empty storage and destroys the source.
+      void (*destroy)(void* storage);
+    };
+
+    /*! Operations on a function object stored in the inline buffer. */
+    template <typename Function>
+    struct inline_operations
+    {
+      static void invoke(void* storage)
+      {
+        (*static_cast<Function*>(storage))();
+      }
+
+      static void move(void* to, void* from)
+      {
+        Function* f = static_cast<Function*>(from);
+        new (to) Function(boost::move(*f));
+        f->~Function();
+      }
+
+      static void destroy(void* storage)
+      {
+        static_cast<Function*>(storage)->~Function();
+      }
+
+      static operations const * get()
+      {
+        static operations const ops = { &invoke, &move, &destroy };
+        return &ops;
+      }
+    };
+
+    /*! Operations on a function object stored in a pooled block. */
+    template <typename Function>
+    struct pooled_operations
+    {
+      static Function*& target(void* storage)
+      {
+        return *static_cast<Function**>(storage);
+      }
+
+      static void invoke(void* storage)
+      {
+        (*target(storage))();
+      }
+
+      static void move(void* to, void* from)
+      {
+        new (to) Function*(target(from));
+      }
+
+      static void destroy(void* storage)
+      {
+        Function* f = target(storage);
+        f->~Function();
+        detail::block_pool::deallocate(f, sizeof(Function));
+      }
+
+      static operations const * get()
+      {
+        static operations const ops = { &invoke, &move, &destroy };
+        return &ops;
+      }
+    };
+
+    union
+    {
+      char        m_buffer[Capacity];
+      align_type  m_align;
+    };
+    operations const * m_operations;  //!< Operations on the stored function or 0 if empty.
+
+    BOOST_STATIC_ASSERT(Capacity >= sizeof(void*));
+
+    /*! Indicates whether a function object can be stored in the inline buffer. */
+    template <typename Function>
+    struct fits_inline
+    {
+      static bool const value = sizeof(Function) <= Capacity
+        && alignment_of<Function>::value <= alignment_of<align_type>::value
+        && has_nothrow_copy<Function>::value;
+    };
+
+    template <typename Function>
+    void store(Function const & function, typename enable_if_c<fits_inline<Function>::value>::type* = 0)
+    {
+      new (m_buffer) Function(function);
+      m_operations = inline_operations<Function>::get();
+    }
+
+    template <typename Function>
+    void store(Function const & function, typename disable_if_c<fits_inline<Function>::value>::type* = 0)
+    {
+      void* block = detail::block_pool::allocate(sizeof(Function));
+      try
+      {
+        new (m_buffer) Function*(new (block) Function(function));
+      }
+      catch(...)
+      {
+        detail::block_pool::deallocate(block, sizeof(Function));
+        throw;
+      }
+      m_operations = pooled_operations<Function>::get();
+    }
+
+    void reset()
+    {
+      if(m_operations)
+      {
+        m_operations->destroy(m_buffer);
+        m_operations = 0;
+      }
+    }
+
+  public:
+    /*! Constructs an empty task which does nothing when executed.
+    */
+    basic_inplace_task()
+    : m_operations(0)
+    {
+    }
+
+    /*! Constructor.
+    * \param function The task's function object. It is copied into the task.
+    */
+    template <typename Function>
+    basic_inplace_task(Function const & function,
+      typename disable_if<is_same<Function, basic_inplace_task> >::type* = 0)
+    : m_operations(0)
+    {
+      store(function);
+    }
+
+    /*! Constructs a task from a plain function.
+    * \param function Pointer to the task's function.
+    */
+    basic_inplace_task(void (*function)())
+    : m_operations(0)
+    {
+      if(function)
+      {
+        store(function);
+      }
+    }
+
+    /*! Move constructor. The source task is left empty.
+    */
+    basic_inplace_task(BOOST_RV_REF(basic_inplace_task) other) BOOST_NOEXCEPT
+    : m_operations(other.m_operations)
+    {
+      if(m_operations)
+      {
+        m_operations->move(m_buffer, other.m_buffer);
+        other.m_operations = 0;
+      }
+    }
+
+    /*! Move assignment. The source task is left empty.
+    */
+    basic_inplace_task& operator=(BOOST_RV_REF(basic_inplace_task) other) BOOST_NOEXCEPT
+    {
+      if(this != &other)
+      {
+        reset();
+        if(other.m_operations)
+        {
+          other.m_operations->move(m_buffer, other.m_buffer);
+          m_operations = other.m_operations;
+          other.m_operations = 0;
+        }
+      }
+      return *this;
+    }
+
+    /*! Destructor.
+    */
+    ~basic_inplace_task()
+    {
+      reset();
+    }
+
+    /*! Executes the task function. Does nothing if the task is empty.
+    */
+    void operator() (void)
+    {
+      if(m_operations)
+      {
+        m_operations->invoke(m_buffer);
+      }
+    }
+
+    /*! Indicates that the task has no function.
+    * \return true if the task is empty.
+    */
+    bool empty() const
+    {
+      return m_operations == 0;
+    }
+  };
+
+
+  /*! \brief Allocation-free task function object.
+  *
+  * A move-only task with an inline buffer of BOOST_THREADPOOL_INPLACE_TASK_SIZE bytes.
+  *
+  */
+  typedef basic_inplace_task<BOOST_THREADPOOL_INPLACE_TASK_SIZE> inplace_task;
+
+
+} } // namespace boost::threadpool
+
+#endif // THREADPOOL_INPLACE_TASK_HPP_INCLUDED
@@ -0,0 +1,223 @@
+/*! \file
+* \brief Fork-join algorithms.
+*
+* This file contains parallel_invoke, parallel_for and parallel_sort, which
+* split their work into tasks of a pool and wait for them. A waiting thread
+* executes pending tasks of the pool instead of blocking, so the algorithms
+* can be nested and called from tasks of the same pool.
+*
+* Use, modification, and distribution are  subject to the
+* Boost Software License, Version 1.0. (See accompanying  file
+* LICENSE_1_0.txt or copy at http://www.boost.org/LICENSE_1_0.txt)
+*
+* http://threadpool.sourceforge.net
+*
+*/
+
+
+#ifndef THREADPOOL_PARALLEL_HPP_INCLUDED
+#define THREADPOOL_PARALLEL_HPP_INCLUDED
+
+
+#include "./task_batch.hpp"
+
+#include <boost/bind.hpp>
+#include <boost/ref.hpp>
+
+#include <algorithm>
+#include <functional>
+#include <iterator>
+
+
+namespace boost { namespace threadpool
+{
+
+  /*! Waits until all tasks of a batch have finished and executes pending tasks
+  * of the pool meanwhile. The thread blocks only when the pool has no pending
+  * tasks, i.e. when the batch's tasks are being executed by other threads.
+  * \param pool The pool the batch's tasks have been scheduled to.
+  * \param batch The batch.
+  */
+  template <typename Pool>
+  void help_wait(Pool& pool, task_batch const & batch)
+  {
+    while(!batch.ready())
+    {
+      if(!pool.try_execute_one())
+      {
+        // Tasks which are forked later by the batch's tasks are helped with, too.
+        batch.timed_wait(1);
+      }
+    }
+  }
+
+
+  namespace detail
+  {
+    /*! \brief Calls a function object by reference. */
+    template <typename Function>
+    struct ref_task_func
+    {
+      typedef void result_type;
+      Function* m_function;
+
+      explicit ref_task_func(Function& function)
+      : m_function(&function)
+      {
+      }
+
+      void operator() (void) const
+      {
+        (*m_function)();
+      }
+    };
+
+    /*! Forks a task of a fork-join algorithm. It is executed in the calling thread
+    * if the pool does not take it. */
+    template <typename Pool, typename Function>
+    void fork(Pool& pool, Function const & function, task_batch& batch)
+    {
+      batch.add(1);
+      if(!pool.schedule(batch_task_func<Function>(function, batch)))
+      {
+        function();
+        batch.done();
+      }
+    }
+
+    template <typename Pool, typename Index, typename Body>
+    void parallel_for_range(Pool* pool, Index first, Index last, Body const * body, Index grain)
+    {
+      task_batch batch;
+      // Keep the first half and fork the second one, until the range is small enough.
+      // The largest pieces are forked first, so an idle worker takes a large piece.
+      while(last - first > grain)
+      {
+        Index const mid = first + (last - first) / 2;
+        fork(*pool, bind(&parallel_for_range<Pool, Index, Body>, pool, mid, last, body, grain), batch);
+        last = mid;
+      }
+      for(; first != last; ++first)
+      {
+        (*body)(first);
+      }
+      help_wait(*pool, batch);
+    }
+
+    template <typename Pool, typename RandomAccessIterator, typename Compare>
+    void parallel_merge_sort(Pool* pool, RandomAccessIterator first, RandomAccessIterator last,
+      Compare const * comp, size_t cutoff)
+    {
+      if(static_cast<size_t>(last - first) <= cutoff)
+      {
+        std::sort(first, last, *comp);
+        return;
+      }
+
+      RandomAccessIterator const mid = first + (last - first) / 2;
+      task_batch batch;
+      fork(*pool, bind(&parallel_merge_sort<Pool, RandomAccessIterator, Compare>, pool, mid, last, comp, cutoff), batch);
+      parallel_merge_sort(pool, first, mid, comp, cutoff);
+      help_wait(*pool, batch);
+      std::inplace_merge(first, mid, last, *comp);
+    }
+
+  } // namespace detail
+
+
+  /*! Calls two function objects in parallel. The first one is called in the
+  * calling thread. Returns when both have returned.
+  * \param pool The pool which executes the other function objects. Its tasks must be constructible from function objects, e.g. task_func.
+  * \param f1 The first function object. It must not throw exceptions.
+  * \param f2 The second function object. It must not throw exceptions.
+  */
+  template <typename Pool, typename F1, typename F2>
+  void parallel_invoke(Pool& pool, F1 f1, F2 f2)
+  {
+    task_batch batch;
+    detail::fork(pool, detail::ref_task_func<F2>(f2), batch);
+    f1();
+    help_wait(pool, batch);
+  }
+
+  /*! Calls three function objects in parallel, see parallel_invoke.
+  */
+  template <typename Pool, typename F1, typename F2, typename F3>
+  void parallel_invoke(Pool& pool, F1 f1, F2 f2, F3 f3)
+  {
+    task_batch batch;
+    detail::fork(pool, detail::ref_task_func<F3>(f3), batch);
+    detail::fork(pool, detail::ref_task_func<F2>(f2), batch);
+    f1();
+    help_wait(pool, batch);
+  }
+
+  /*! Calls four function objects in parallel, see parallel_invoke.
+  */
+  template <typename Pool, typename F1, typename F2, typename F3, typename F4>
+  void parallel_invoke(Pool& pool, F1 f1, F2 f2, F3 f3, F4 f4)
+  {
+    task_batch batch;
+    detail::fork(pool, detail::ref_task_func<F4>(f4), batch);
+    detail::fork(pool, detail::ref_task_func<F3>(f3), batch);
+    detail::fork(pool, detail::ref_task_func<F2>(f2), batch);
+    f1();
+    help_wait(pool, batch);
+  }
+
+
+  /*! Calls a function object for each index of a range in parallel. The range is
+  * split in halves recursively until the pieces are not larger than the grain size.
+  * \param pool The pool which executes the pieces. Its tasks must be constructible from function objects, e.g. task_func.
+  * \param first The first index.
+  * \param last The index past the last one.
+  * \param body The function object which is called with each index. It must not throw exceptions.
+  * \param grain The maximum number of indices of a piece, or 0 to split the range into about eight pieces per thread of the pool.
+  */
+  template <typename Pool, typename Index, typename Body>
+  void parallel_for(Pool& pool, Index const first, Index const last, Body const & body, Index grain = 0)
+  {
+    if(!(first < last)) return;
+    if(grain == 0)
+    {
+      grain = static_cast<Index>((last - first) / (8 * (std::max)(pool.size(), static_cast<size_t>(1))));
+      if(grain == 0) grain = 1;
+    }
+    detail::parallel_for_range(&pool, first, last, &body, grain);
+  }
+
+
+  /*! Sorts a range in parallel. The range is split in halves which are sorted
+  * in parallel and merged, until the pieces are not larger than the cutoff and
+  * sorted with std::sort.
+  * \param pool The pool which executes the pieces. Its tasks must be constructible from function objects, e.g. task_func.
+  * \param first Iterator to the first element.
+  * \param last Iterator past the last element.
+  * \param comp The ordering. It must not throw exceptions.
+  * \param cutoff The maximum number of elements which are sorted by one task, or 0 to 
+  * split the range into about eight pieces per thread of the pool, of at least 2048 elements.
+  */
+  template <typename Pool, typename RandomAccessIterator, typename Compare>
+  void parallel_sort(Pool& pool, RandomAccessIterator first, RandomAccessIterator last, Compare comp, size_t cutoff = 0)
+  {
+    if(cutoff == 0)
+    {
+      cutoff = (std::max)(static_cast<size_t>(last - first) / (8 * (std::max)(pool.size(), static_cast<size_t>(1))), 
+        static_cast<size_t>(2048));
+    }
+    if(cutoff < 2) cutoff = 2;
+    detail::parallel_merge_sort(&pool, first, last, &comp, cutoff);
+  }
+
+  /*! Sorts a range in ascending order in parallel, see parallel_sort.
+  */
+  template <typename Pool, typename RandomAccessIterator>
+  void parallel_sort(Pool& pool, RandomAccessIterator first, RandomAccessIterator last)
+  {
+    parallel_sort(pool, first, last, std::less<typename std::iterator_traits<RandomAccessIterator>::value_type>());
+  }
+
+
+} } // namespace boost::threadpool
+
+#endif // THREADPOOL_PARALLEL_HPP_INCLUDED
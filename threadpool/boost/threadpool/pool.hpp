@@ -27,6 +27,7 @@
 #include "./detail/pool_core.hpp"
 
 #include "task_adaptors.hpp"
+#include "inplace_task.hpp"
 
 #include "./detail/locking_ptr.hpp"
 
@@ -104,6 +105,29 @@ namespace boost { namespace threadpool
     }
 
 
+    /*! Constructor.
+     * \param initial_threads The pool is immediately resized to set the specified number of threads. The pool's actual number threads depends on the SizePolicy.
+     * \param worker_init Function which each worker calls in its thread before executing tasks, e.g. a cpu_affinity.
+     */
+    thread_pool(size_t initial_threads, task_func const & worker_init)
+    : m_core(new pool_core_type)
+    , m_shutdown_controller(static_cast<void*>(0), bind(&pool_core_type::shutdown, m_core))
+    {
+      m_core->set_worker_init(worker_init);
+      size_policy_type::init(*m_core, initial_threads);
+    }
+
+
+    /*! Sets the function which each worker calls in its thread before executing tasks.
+     * Only workers which are created afterwards call it.
+     * \param worker_init The function, e.g. a cpu_affinity. Its exceptions are ignored.
+     */
+    void set_worker_init(task_func const & worker_init)
+    {
+      m_core->set_worker_init(worker_init);
+    }
+
+
     /*! Gets the size controller which manages the number of threads in the pool. 
     * \return The size controller.
     * \see SizePolicy
@@ -132,6 +156,76 @@ namespace boost { namespace threadpool
        return m_core->schedule(task);
      }
 
+#ifndef BOOST_NO_CXX11_RVALUE_REFERENCES
+     /*! Schedules a task for asynchronous execution by moving it into the pool.
+     * The task will be executed once only.
+     * \param task The task function object. It should not throw execeptions.
+     * \return true, if the task could be scheduled and false otherwise. 
+     */  
+     bool schedule(task_type && task)
+     {	
+       return m_core->schedule(boost::move(task));
+     }
+#endif
+
+
+     /*! Schedules a range of tasks for asynchronous execution. The tasks are put to the 
+     * scheduler under one lock and at most as many idle workers are woken up as there are tasks.
+     * Each task will be executed once only.
+     * \param first Iterator to the first task function object. Use move iterators to move the tasks.
+     * \param last Iterator past the last task function object.
+     * \return The number of tasks which could be scheduled.
+     * \see task_batch
+     */  
+     template <typename InputIterator>
+     size_t schedule_bulk(InputIterator first, InputIterator last)
+     {	
+       return m_core->schedule_bulk(first, last);
+     }
+
+
+    /*! Sets how long idle workers spin before they park. A spinning worker takes a 
+    * new task without a context switch, but keeps its CPU busy meanwhile.
+    * \param spins The number of iterations, 0 to park at once. The default is 2000 
+    * on multiprocessor systems and 0 otherwise.
+    */   
+    void set_idle_spin(unsigned const spins)
+    {
+      m_core->set_idle_spin(spins);
+    }
+
+
+    /*! Enables or disables recording statistics: queue wait and execution time 
+    * histograms, throughput and per-worker utilization. Enabling restarts them.
+    * Recording costs reading the clock three times per task.
+    * \param enabled Indicates if statistics are recorded. They are disabled initially.
+    */   
+    void enable_stats(bool const enabled = true)
+    {
+      m_core->enable_stats(enabled);
+    }
+
+
+    /*! Gets a snapshot of the statistics.
+    * \return The statistics since they have been enabled.
+    * \see enable_stats
+    */   
+    pool_stats stats() const
+    {
+      return m_core->stats();
+    }
+
+
+    /*! Executes the next pending task in the calling thread, if there is one. 
+    * A thread which waits for tasks of the pool, e.g. a task waiting for its subtasks, 
+    * can help executing them instead of blocking.
+    * \return true if a task has been executed.
+    */   
+    bool try_execute_one()
+    {
+      return m_core->try_execute_one();
+    }
+
 
     /*! Returns the number of tasks which are currently executed.
     * \return The number of active tasks. 
@@ -218,6 +312,44 @@ namespace boost { namespace threadpool
   typedef thread_pool<prio_task_func, prio_scheduler, static_size, resize_controller, wait_for_all_tasks> prio_pool;
 
 
+  /*! \brief Pool for tasks with deadlines.
+  *
+  * The pool's tasks are deadline_task_func functors, scheduled earliest deadline first.
+  * Tasks which start after their deadline are dropped.
+  *
+  */ 
+  typedef thread_pool<deadline_task_func, edf_scheduler, static_size, resize_controller, wait_for_all_tasks> edf_pool;
+
+
+  /*! \brief Allocation-free pool.
+  *
+  * The pool's tasks are fifo scheduled inplace_task functors, which are moved
+  * through the pool instead of being copied. Requires rvalue references.
+  *
+  */ 
+  typedef thread_pool<inplace_task, fifo_scheduler, static_size, resize_controller, wait_for_all_tasks> inplace_pool;
+
+
+  /*! \brief Adaptive pool.
+  *
+  * The pool's tasks are fifo scheduled task_func functors. The number of threads
+  * adapts to the queue latency.
+  *
+  * \see adaptive_size
+  */ 
+  typedef thread_pool<task_func, fifo_scheduler, adaptive_size, adaptive_controller, wait_for_all_tasks> adaptive_pool;
+
+
+  /*! \brief Allocation-free adaptive pool.
+  *
+  * The pool's tasks are fifo scheduled inplace_task functors. The number of threads
+  * adapts to the queue latency.
+  *
+  * \see adaptive_size, inplace_pool
+  */ 
+  typedef thread_pool<inplace_task, fifo_scheduler, adaptive_size, adaptive_controller, wait_for_all_tasks> adaptive_inplace_pool;
+
+
   /*! \brief A standard pool.
   *
   * The pool's tasks are fifo scheduled task_func functors.
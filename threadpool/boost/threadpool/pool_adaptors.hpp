@@ -19,6 +19,7 @@
 #define THREADPOOL_POOL_ADAPTORS_HPP_INCLUDED
 
 #include <boost/smart_ptr.hpp>
+#include <boost/move/move.hpp>
 
 
 namespace boost { namespace threadpool
@@ -52,6 +53,23 @@ namespace boost { namespace threadpool
     }	
 
 
+#ifndef BOOST_NO_CXX11_RVALUE_REFERENCES
+    /*! Schedules a task for asynchronous execution by moving it into the pool.
+    * The task will be executed once only.
+    * \param task The task function object.
+    */  
+    template<typename Pool>
+    typename enable_if < 
+      is_void< typename result_of< typename Pool::task_type() >::type >,
+      bool
+    >::type
+    schedule(Pool& pool, typename Pool::task_type && task)
+    {	
+      return pool.schedule(boost::move(task));
+    }	
+#endif
+
+
     template<typename Pool>
     typename enable_if < 
       is_void< typename result_of< typename Pool::task_type() >::type >,
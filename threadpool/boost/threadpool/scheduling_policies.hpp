@@ -26,6 +26,9 @@
 #include <queue>
 #include <deque>
 
+#include <boost/circular_buffer.hpp>
+#include <boost/move/move.hpp>
+
 #include "task_adaptors.hpp"
 
 namespace boost { namespace threadpool
@@ -48,8 +51,16 @@ namespace boost { namespace threadpool
     typedef Task task_type; //!< Indicates the scheduler's task type.
 
   protected:
-    std::deque<task_type> m_container;  //!< Internal task container.	
+    circular_buffer<task_type> m_container;  //!< Internal task container. Grows when full and never shrinks, so that pushing and popping do not allocate in the steady state.
 
+    /*! Makes room for one more task. */
+    void reserve()
+    {
+      if(m_container.full())
+      {
+        m_container.set_capacity(m_container.capacity() < 16 ? 16 : 2 * m_container.capacity());
+      }
+    }
 
   public:
     /*! Adds a new task to the scheduler.
@@ -58,10 +69,24 @@ namespace boost { namespace threadpool
     */
     bool push(task_type const & task)
     {
+      reserve();
       m_container.push_back(task);
       return true;
     }
 
+#ifndef BOOST_NO_CXX11_RVALUE_REFERENCES
+    /*! Adds a new task to the scheduler by moving it.
+    * \param task The task object.
+    * \return true, if the task could be scheduled and false otherwise. 
+    */
+    bool push(task_type && task)
+    {
+      reserve();
+      m_container.push_back(boost::move(task));
+      return true;
+    }
+#endif
+
     /*! Removes the task which should be executed next.
     */
     void pop()
@@ -77,6 +102,14 @@ namespace boost { namespace threadpool
       return m_container.front();
     }
 
+    /*! Gets the task which should be executed next, e.g. to move it out before pop().
+    *  \return The task object to be executed.
+    */
+    task_type & top()
+    {
+      return m_container.front();
+    }
+
     /*! Gets the current number of tasks in the scheduler.
     *  \return The number of tasks.
     *  \remarks Prefer empty() to size() == 0 to check if the scheduler is empty.
@@ -121,7 +154,16 @@ namespace boost { namespace threadpool
     typedef Task task_type;  //!< Indicates the scheduler's task type.
 
   protected:
-    std::deque<task_type> m_container;  //!< Internal task container.	
+    circular_buffer<task_type> m_container;  //!< Internal task container. Grows when full and never shrinks.
+
+    /*! Makes room for one more task. */
+    void reserve()
+    {
+      if(m_container.full())
+      {
+        m_container.set_capacity(m_container.capacity() < 16 ? 16 : 2 * m_container.capacity());
+      }
+    }
 
   public:
     /*! Adds a new task to the scheduler.
@@ -130,10 +172,24 @@ namespace boost { namespace threadpool
     */
     bool push(task_type const & task)
     {
+      reserve();
       m_container.push_front(task);
       return true;
     }
 
+#ifndef BOOST_NO_CXX11_RVALUE_REFERENCES
+    /*! Adds a new task to the scheduler by moving it.
+    * \param task The task object.
+    * \return true, if the task could be scheduled and false otherwise. 
+    */
+    bool push(task_type && task)
+    {
+      reserve();
+      m_container.push_front(boost::move(task));
+      return true;
+    }
+#endif
+
     /*! Removes the task which should be executed next.
     */
     void pop()
@@ -149,6 +205,14 @@ namespace boost { namespace threadpool
       return m_container.front();
     }
 
+    /*! Gets the task which should be executed next, e.g. to move it out before pop().
+    *  \return The task object to be executed.
+    */
+    task_type & top()
+    {
+      return m_container.front();
+    }
+
     /*! Gets the current number of tasks in the scheduler.
     *  \return The number of tasks.
     *  \remarks Prefer empty() to size() == 0 to check if the scheduler is empty.
@@ -210,6 +274,18 @@ namespace boost { namespace threadpool
       return true;
     }
 
+#ifndef BOOST_NO_CXX11_RVALUE_REFERENCES
+    /*! Adds a new task to the scheduler by moving it.
+    * \param task The task object.
+    * \return true, if the task could be scheduled and false otherwise. 
+    */
+    bool push(task_type && task)
+    {
+      m_container.push(boost::move(task));
+      return true;
+    }
+#endif
+
     /*! Removes the task which should be executed next.
     */
     void pop()
@@ -225,6 +301,17 @@ namespace boost { namespace threadpool
       return m_container.top();
     }
 
+    /*! Gets the task which should be executed next, e.g. to move it out before pop().
+    *  \return The task object to be executed.
+    *  \remarks The task must not be modified in a way that changes its ordering.
+    *  Moving it out is safe if pop() follows, because pop() moves the top task
+    *  to the end of the heap without comparing it.
+    */
+    task_type & top()
+    {
+      return const_cast<task_type &>(m_container.top());
+    }
+
     /*! Gets the current number of tasks in the scheduler.
     *  \return The number of tasks.
     *  \remarks Prefer empty() to size() == 0 to check if the scheduler is empty.
@@ -255,6 +342,28 @@ namespace boost { namespace threadpool
   };
 
 
+
+
+  /*! \brief SchedulingPolicy which implements earliest deadline first ordering. 
+  *
+  * This container implements an earliest deadline first scheduling policy.
+  * The task with the earliest deadline will be the first to be removed.
+  * Tasks whose deadline has passed when they are removed are dropped by 
+  * the deadline_task_func itself, so that an overloaded pool does not spend 
+  * time on tasks which are too late anyway. The pool counts them in 
+  * pool_stats::expired and runs their expiry functions.
+  *
+  * \param Task A function object which implements the operator() and the operator <. operator < must be a partial ordering in which the task with the earliest deadline is the greatest.
+  *
+  * \see deadline_task_func
+  */ 
+  template <typename Task = deadline_task_func>  
+  class edf_scheduler
+  : public prio_scheduler<Task>
+  {
+  };
+
+
 } } // namespace boost::threadpool
 
 
@@ -19,6 +19,17 @@
 #define THREADPOOL_SIZE_POLICIES_HPP_INCLUDED
 
 
+#include "./detail/clock.hpp"
+
+#include <boost/atomic.hpp>
+#include <boost/bind.hpp>
+#include <boost/scoped_ptr.hpp>
+#include <boost/thread/condition_variable.hpp>
+#include <boost/thread/mutex.hpp>
+#include <boost/thread/thread.hpp>
+
+#include <algorithm>
+
 
 /// The namespace threadpool contains a thread pool and related utility classes.
 namespace boost { namespace threadpool
@@ -89,9 +100,274 @@ namespace boost { namespace threadpool
       m_pool.get().resize(new_worker_count + 1);
     }
 
-    // TODO this functions are not called yet
-    void task_scheduled() {}
-    void task_finished() {}
+    unsigned idle_timeout() const
+    {
+      return 0;
+    }
+
+    bool retire_idle_worker()
+    {
+      return false;
+    }
+
+    bool measures_queue_wait() const
+    {
+      return false;
+    }
+
+    void task_scheduled(size_t const) {}
+    void task_finished(size_t const) {}
+  };
+
+
+  /*! \brief SizePolicyController which allows resizing and configuring an adaptive_size policy.
+  *
+  * \param Pool The pool's core type.
+  */ 
+  template< typename Pool >
+  class adaptive_controller
+  {
+    typedef typename Pool::size_policy_type size_policy_type;
+    reference_wrapper<size_policy_type> m_policy;
+    shared_ptr<Pool> m_pool;                           //!< to make sure that the pool is alive (the policy pointer is valid) as long as the controller exists
+
+  public:
+    adaptive_controller(size_policy_type& policy, shared_ptr<Pool> pool)
+      : m_policy(policy)
+      , m_pool(pool)
+    {
+    }
+
+    bool resize(size_t worker_count)
+    {
+      return m_policy.get().resize(worker_count);
+    }
+
+    /*! Sets the range of the thread count.
+    * \param min_threads The minimum number of threads. Idle workers are not retired below it.
+    * \param max_threads The maximum number of threads. The pool does not grow beyond it.
+    */
+    void set_limits(size_t min_threads, size_t max_threads)
+    {
+      m_policy.get().set_limits(min_threads, max_threads);
+    }
+
+    /*! Sets the time a queued task may wait for a worker before the pool grows.
+    * \param msecs The target wait time in milliseconds.
+    */
+    void set_target_wait(unsigned msecs)
+    {
+      m_policy.get().set_target_wait(msecs);
+    }
+
+    /*! Sets the time after which an idle worker is retired.
+    * \param msecs The idle timeout in milliseconds or 0 to keep idle workers.
+    */
+    void set_idle_timeout(unsigned msecs)
+    {
+      m_policy.get().set_idle_timeout(msecs);
+    }
+  };
+
+
+  /*! \brief SizePolicy which adapts the thread count to the queue latency.
+  *
+  * The pool grows by one thread when the oldest pending task has waited longer 
+  * than the target wait time and no worker is idle, at most once per target wait time. 
+  * Workers which have been idle for the idle timeout are retired. The thread count 
+  * stays between the minimum and maximum set with adaptive_controller; the default 
+  * range is 1 to four times the number of hardware threads.
+  *
+  * The wait times are measured in the order the tasks were scheduled, which is exact 
+  * for the fifo_scheduler and an approximation for other schedulers. The pool records 
+  * the times when the tasks were scheduled for the policy, as it does for its statistics.
+  *
+  * The pool checks the wait times when tasks are scheduled and finished. While tasks 
+  * wait and all workers are busy, e.g. blocked, a watcher thread started on demand 
+  * checks them every target wait time as well, so that the pool grows without either.
+  *
+  * \param Pool The pool's core type.
+  */ 
+  template<typename Pool>
+  class adaptive_size
+  {
+    reference_wrapper<Pool volatile> m_pool;
+
+    atomic<size_t>    m_min_threads;
+    atomic<size_t>    m_max_threads;
+    atomic<unsigned>  m_target_wait;   //!< Milliseconds a pending task may wait before the pool grows.
+    atomic<unsigned>  m_idle_timeout;  //!< Milliseconds after which an idle worker is retired.
+
+    // The following members are accessed only while the pool is locked:
+    uint64_t          m_last_growth;   //!< Time when the pool has grown last.
+    scoped_ptr<thread> m_watcher;      //!< Checks the wait times while tasks wait for busy workers, or null until needed.
+
+    // The following members are protected by m_watch_monitor, which is never held while locking the pool:
+    mutex             m_watch_monitor;
+    condition_variable m_watch_event;  //!< Watching is needed or has to stop.
+    bool              m_watch_needed;  //!< Tasks wait for busy workers.
+    bool              m_watch_stopped;
+
+    /*! Adds a thread if pending tasks have waited too long. */
+    void adapt(uint64_t const now)
+    {
+      Pool volatile & pool = m_pool.get();
+      size_t const workers = pool.size();
+      if(workers < m_min_threads)
+      {
+        pool.resize(m_min_threads);
+        return;
+      }
+
+      uint64_t const scheduled = pool.oldest_schedule_time() / 1000;
+      if(workers >= m_max_threads 
+        || scheduled == 0
+        || pool.active() < workers)   // an idle worker will take the task
+      {
+        return;
+      }
+
+      unsigned const target = m_target_wait;
+      if(now - scheduled > target && now - m_last_growth > target)
+      {
+        m_last_growth = now;
+        pool.resize(workers + 1);
+      }
+
+      // no worker may finish in time, so check again after the target wait time
+      start_watching();
+    }
+
+    /*! Makes the watcher check the wait times after the target wait time. Requires the pool lock. */
+    void start_watching()
+    {
+      {
+        mutex::scoped_lock lock(m_watch_monitor);
+        if(m_watch_needed) return;
+        m_watch_needed = true;
+        m_watch_event.notify_one();
+      }
+
+      if(!m_watcher)
+      {
+        try
+        {
+          m_watcher.reset(new thread(bind(&adaptive_size::watch, this)));
+        }
+        catch(thread_resource_error const &)
+        {
+        }
+      }
+    }
+
+    /*! Runs the watcher until the policy is destroyed. */
+    void watch()
+    {
+      mutex::scoped_lock lock(m_watch_monitor);
+      while(!m_watch_stopped)
+      {
+        if(!m_watch_needed)
+        {
+          m_watch_event.wait(lock);
+          continue;
+        }
+
+        m_watch_event.timed_wait(lock, posix_time::milliseconds(m_target_wait.load()));
+        if(m_watch_stopped) break;
+
+        m_watch_needed = false;   // adapt() starts watching again while tasks still wait
+        lock.unlock();
+        m_pool.get().check_size();
+        lock.lock();
+      }
+    }
+
+  public:
+    static void init(Pool& pool, size_t const worker_count)
+    {
+      pool.resize(worker_count);
+    }
+
+    adaptive_size(Pool volatile & pool)
+      : m_pool(pool)
+      , m_min_threads(1)
+      , m_max_threads((std::max)(thread::hardware_concurrency(), 1u) * 4)
+      , m_target_wait(10)
+      , m_idle_timeout(60000)
+      , m_last_growth(0)
+      , m_watch_needed(false)
+      , m_watch_stopped(false)
+    {}
+
+    ~adaptive_size()
+    {
+      if(m_watcher)
+      {
+        {
+          mutex::scoped_lock lock(m_watch_monitor);
+          m_watch_stopped = true;
+          m_watch_event.notify_one();
+        }
+        m_watcher->join();
+      }
+    }
+
+    bool resize(size_t const worker_count)
+    {
+      return m_pool.get().resize(worker_count);
+    }
+
+    void set_limits(size_t const min_threads, size_t const max_threads)
+    {
+      m_min_threads = min_threads;
+      m_max_threads = (std::max)(min_threads, max_threads);
+    }
+
+    void set_target_wait(unsigned const msecs)
+    {
+      m_target_wait = msecs;
+    }
+
+    void set_idle_timeout(unsigned const msecs)
+    {
+      m_idle_timeout = msecs;
+    }
+
+    void worker_died_unexpectedly(size_t const new_worker_count)
+    {
+      m_pool.get().resize(new_worker_count + 1);
+    }
+
+    unsigned idle_timeout() const
+    {
+      return m_idle_timeout;
+    }
+
+    bool retire_idle_worker()
+    {
+      return m_pool.get().size() > m_min_threads;
+    }
+
+    bool measures_queue_wait() const
+    {
+      return true;
+    }
+
+    void task_scheduled(size_t const)
+    {
+      adapt(detail::monotonic_millis());
+    }
+
+    void task_finished(size_t const)
+    {
+      adapt(detail::monotonic_millis());
+    }
+
+    /*! Checks the wait times without a task having been scheduled or finished. */
+    void check()
+    {
+      adapt(detail::monotonic_millis());
+    }
   };
 
 } } // namespace boost::threadpool
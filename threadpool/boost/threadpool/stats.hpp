@@ -0,0 +1,368 @@
+/*! \file
+* \brief Pool statistics.
+*
+* This file contains the latency histograms and counters a pool records
+* while statistics are enabled, and the snapshot returned by its stats()
+* function. The counters are written without locks; each worker records
+* to its own counters, so the workers do not contend for cache lines.
+*
+* Use, modification, and distribution are  subject to the
+* Boost Software License, Version 1.0. (See accompanying  file
+* LICENSE_1_0.txt or copy at http://www.boost.org/LICENSE_1_0.txt)
+*
+* http://threadpool.sourceforge.net
+*
+*/
+
+
+#ifndef THREADPOOL_STATS_HPP_INCLUDED
+#define THREADPOOL_STATS_HPP_INCLUDED
+
+
+#include "./detail/clock.hpp"
+
+#include <boost/atomic.hpp>
+#include <boost/cstdint.hpp>
+#include <boost/utility.hpp>
+
+#include <vector>
+
+
+namespace boost { namespace threadpool
+{
+
+  /*! \brief Histogram of durations.
+  *
+  * The durations are counted in buckets whose bounds are powers of two
+  * microseconds: bucket 0 counts durations below 1 us, bucket i durations
+  * of at least 2^(i-1) and less than 2^i us. Percentiles are thus accurate
+  * within a factor of two.
+  */
+  class histogram_snapshot
+  {
+  public:
+    static size_t const bucket_count = 40;  //!< The number of buckets. The last one counts all longer durations.
+
+  private:
+    std::vector<uint64_t> m_buckets;
+    uint64_t              m_sum;
+
+  public:
+    /*! Constructs an empty histogram.
+    */
+    histogram_snapshot()
+    : m_buckets(bucket_count)
+    , m_sum(0)
+    {
+    }
+
+    /*! Gets the bucket of a duration.
+    * \param usecs The duration in microseconds.
+    * \return The index of the bucket.
+    */
+    static size_t bucket(uint64_t usecs)
+    {
+      size_t index = 0;
+      while(usecs != 0 && index < bucket_count - 1)
+      {
+        usecs >>= 1;
+        index++;
+      }
+      return index;
+    }
+
+    /*! Gets the upper bound of a bucket.
+    * \param index The index of the bucket.
+    * \return The upper bound in microseconds.
+    */
+    static uint64_t upper_bound(size_t const index)
+    {
+      return static_cast<uint64_t>(1) << index;
+    }
+
+    /*! Adds durations to a bucket.
+    * \param index The index of the bucket.
+    * \param count The number of durations.
+    * \param sum The sum of the durations in microseconds.
+    */
+    void add(size_t const index, uint64_t const count, uint64_t const sum)
+    {
+      m_buckets[index] += count;
+      m_sum += sum;
+    }
+
+    /*! Adds the durations of another histogram.
+    * \param other The histogram.
+    */
+    void merge(histogram_snapshot const & other)
+    {
+      for(size_t i = 0; i < bucket_count; i++)
+      {
+        m_buckets[i] += other.m_buckets[i];
+      }
+      m_sum += other.m_sum;
+    }
+
+    /*! Gets the durations counted in a bucket.
+    * \param index The index of the bucket.
+    * \return The number of durations.
+    */
+    uint64_t operator[](size_t const index) const
+    {
+      return m_buckets[index];
+    }
+
+    /*! Gets the number of durations.
+    * \return The number of durations.
+    */
+    uint64_t count() const
+    {
+      uint64_t count = 0;
+      for(size_t i = 0; i < bucket_count; i++)
+      {
+        count += m_buckets[i];
+      }
+      return count;
+    }
+
+    /*! Gets the sum of the durations.
+    * \return The sum in microseconds.
+    */
+    uint64_t sum() const
+    {
+      return m_sum;
+    }
+
+    /*! Gets the mean duration.
+    * \return The mean in microseconds, 0 if the histogram is empty.
+    */
+    double mean() const
+    {
+      uint64_t const n = count();
+      return n == 0 ? 0.0 : static_cast<double>(m_sum) / n;
+    }
+
+    /*! Gets a percentile.
+    * \param fraction The fraction of durations which are not longer than the percentile, e.g. 0.99.
+    * \return The upper bound of the bucket containing the percentile in microseconds, 0 if the histogram is empty.
+    */
+    uint64_t percentile(double const fraction) const
+    {
+      uint64_t const n = count();
+      if(n == 0) return 0;
+
+      uint64_t const rank = static_cast<uint64_t>(fraction * n + 0.5);
+      uint64_t seen = 0;
+      for(size_t i = 0; i < bucket_count; i++)
+      {
+        seen += m_buckets[i];
+        if(seen >= rank && seen > 0) return upper_bound(i);
+      }
+      return upper_bound(bucket_count - 1);
+    }
+  };
+
+
+  /*! \brief Statistics of a worker thread.
+  */
+  struct worker_stats_snapshot
+  {
+    uint64_t executed;        //!< The number of tasks the worker has executed.
+    uint64_t busy_usecs;      //!< The time the worker has spent executing tasks.
+    uint64_t lifetime_usecs;  //!< The time since the worker has been started, or since statistics have been enabled.
+
+    /*! Gets the fraction of its lifetime the worker has been busy.
+    * \return The utilization between 0 and 1.
+    */
+    double utilization() const
+    {
+      return lifetime_usecs == 0 ? 0.0 : static_cast<double>(busy_usecs) / lifetime_usecs;
+    }
+  };
+
+
+  /*! \brief Statistics of a pool.
+  *
+  * The histograms and counters cover the time since statistics have been enabled,
+  * including workers which have terminated meanwhile. Tasks executed by threads
+  * outside the pool with try_execute_one are counted, but not as a worker.
+  */
+  struct pool_stats
+  {
+    uint64_t scheduled;       //!< The number of tasks which have been scheduled.
+    uint64_t rejected;        //!< The number of tasks the scheduler has not accepted.
+    uint64_t executed;        //!< The number of tasks which have been executed.
+    uint64_t expired;         //!< The number of tasks which have been dropped because they started after their deadline, see deadline_task_func.
+    uint64_t uptime_usecs;    //!< The time since statistics have been enabled.
+
+    size_t   workers;         //!< The current number of worker threads.
+    size_t   active;          //!< The current number of tasks being executed.
+    size_t   pending;         //!< The current number of tasks waiting to be executed.
+
+    histogram_snapshot queue_wait;    //!< Times from scheduling tasks to starting them. Exact for fifo schedulers, approximate for others.
+    histogram_snapshot execution;     //!< Execution times of the tasks.
+
+    std::vector<worker_stats_snapshot> worker;  //!< The current workers.
+
+    /*! Constructs empty statistics.
+    */
+    pool_stats()
+    : scheduled(0)
+    , rejected(0)
+    , executed(0)
+    , expired(0)
+    , uptime_usecs(0)
+    , workers(0)
+    , active(0)
+    , pending(0)
+    {
+    }
+
+    /*! Gets the average throughput.
+    * \return The executed tasks per second.
+    */
+    double throughput() const
+    {
+      return uptime_usecs == 0 ? 0.0 : executed * 1e6 / uptime_usecs;
+    }
+
+    /*! Gets the average utilization of the current workers.
+    * \return The utilization between 0 and 1.
+    */
+    double utilization() const
+    {
+      if(worker.empty()) return 0.0;
+      double sum = 0.0;
+      for(size_t i = 0; i < worker.size(); i++)
+      {
+        sum += worker[i].utilization();
+      }
+      return sum / worker.size();
+    }
+  };
+
+
+  namespace detail
+  {
+
+    /*! \brief Histogram of durations with atomic buckets. */
+    class latency_histogram
+    : private noncopyable
+    {
+      atomic<uint64_t> m_buckets[histogram_snapshot::bucket_count];
+      atomic<uint64_t> m_sum;
+
+    public:
+      latency_histogram()
+      : m_sum(0)
+      {
+        for(size_t i = 0; i < histogram_snapshot::bucket_count; i++)
+        {
+          m_buckets[i] = 0;
+        }
+      }
+
+      void record(uint64_t const usecs)
+      {
+        m_buckets[histogram_snapshot::bucket(usecs)].fetch_add(1, memory_order_relaxed);
+        m_sum.fetch_add(usecs, memory_order_relaxed);
+      }
+
+      void reset()
+      {
+        for(size_t i = 0; i < histogram_snapshot::bucket_count; i++)
+        {
+          m_buckets[i].store(0, memory_order_relaxed);
+        }
+        m_sum.store(0, memory_order_relaxed);
+      }
+
+      void add_to(histogram_snapshot& snapshot) const
+      {
+        for(size_t i = 0; i < histogram_snapshot::bucket_count; i++)
+        {
+          snapshot.add(i, m_buckets[i].load(memory_order_relaxed), 0);
+        }
+        snapshot.add(0, 0, m_sum.load(memory_order_relaxed));
+      }
+    };
+
+
+    /*! \brief Counters of a worker, or of the threads helping a pool. */
+    class worker_stats
+    : private noncopyable
+    {
+    public:
+      atomic<uint64_t>  m_executed;
+      atomic<uint64_t>  m_expired;      //!< Tasks dropped after their deadline, also counted as executed.
+      atomic<uint64_t>  m_busy_usecs;
+      atomic<uint64_t>  m_started;      //!< Start of the worker's lifetime in microseconds.
+      latency_histogram m_queue_wait;
+      latency_histogram m_execution;
+
+      worker_stats()
+      : m_executed(0)
+      , m_expired(0)
+      , m_busy_usecs(0)
+      , m_started(monotonic_micros())
+      {
+      }
+
+      /*! Records a task.
+      * \param scheduled Time when the task was scheduled, or 0 if unknown.
+      * \param started Time when the task was started.
+      * \param finished Time when the task was finished.
+      * \param executed false if the task has been dropped after its deadline.
+      */
+      void record(uint64_t const scheduled, uint64_t const started, uint64_t const finished, bool const executed = true)
+      {
+        if(!executed)
+        {
+          m_expired.fetch_add(1, memory_order_relaxed);
+        }
+        if(scheduled != 0)
+        {
+          m_queue_wait.record(started > scheduled ? started - scheduled : 0);
+        }
+        uint64_t const busy = finished > started ? finished - started : 0;
+        m_execution.record(busy);
+        m_busy_usecs.fetch_add(busy, memory_order_relaxed);
+        m_executed.fetch_add(1, memory_order_relaxed);
+      }
+
+      /*! Restarts counting. Tasks recorded meanwhile may be lost. */
+      void reset()
+      {
+        m_executed.store(0, memory_order_relaxed);
+        m_expired.store(0, memory_order_relaxed);
+        m_busy_usecs.store(0, memory_order_relaxed);
+        m_started.store(monotonic_micros(), memory_order_relaxed);
+        m_queue_wait.reset();
+        m_execution.reset();
+      }
+
+      void add_to(pool_stats& stats) const
+      {
+        m_queue_wait.add_to(stats.queue_wait);
+        m_execution.add_to(stats.execution);
+        stats.executed += m_executed.load(memory_order_relaxed);
+        stats.expired += m_expired.load(memory_order_relaxed);
+      }
+
+      worker_stats_snapshot snapshot(uint64_t const now) const
+      {
+        worker_stats_snapshot s;
+        uint64_t const started = m_started.load(memory_order_relaxed);
+        s.executed = m_executed.load(memory_order_relaxed);
+        s.busy_usecs = m_busy_usecs.load(memory_order_relaxed);
+        s.lifetime_usecs = now > started ? now - started : 0;
+        return s;
+      }
+    };
+
+  } // namespace detail
+
+
+} } // namespace boost::threadpool
+
+#endif // THREADPOOL_STATS_HPP_INCLUDED
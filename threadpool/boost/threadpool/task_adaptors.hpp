@@ -22,6 +22,8 @@
 #include <boost/function.hpp>
 #include <boost/thread.hpp>
 
+#include "./detail/clock.hpp"
+
 
 namespace boost { namespace threadpool
 {
@@ -91,6 +93,91 @@ namespace boost { namespace threadpool
 
 
 
+
+  /*! \brief Task function object with a deadline. 
+  *
+  * This function object wraps a task_func object and binds an absolute deadline to it.
+  * deadline_task_funcs can be compared using the operator < which orders them by their
+  * deadlines: the task with the earliest deadline is the greatest.
+  * The wrapped task function is invoked by calling the operator () if the deadline has 
+  * not passed yet. Otherwise the task is dropped and its expiry function, if any, is 
+  * invoked instead to report it. A pool counts the dropped tasks in pool_stats::expired.
+  *
+  * \see edf_scheduler
+  *
+  */ 
+  class deadline_task_func
+  {
+  private:
+    uint64_t  m_deadline;   //!< The deadline in milliseconds of detail::monotonic_millis().
+    task_func m_function;   //!< The task's function.
+    task_func m_expired;    //!< The function invoked instead if the deadline has passed.
+
+  public:
+    typedef void result_type; //!< Indicates the functor's result type.
+
+  public:
+    /*! Constructor.
+    * \param timeout The time in milliseconds from now within which the task has to start.
+    * \param function The task's function object.
+    * \param expired The function object which is invoked instead if the task starts too late.
+    */
+    deadline_task_func(unsigned int const timeout, task_func const & function, task_func const & expired = task_func())
+      : m_deadline(detail::monotonic_millis() + timeout)
+      , m_function(function)
+      , m_expired(expired)
+    {
+    }
+
+    /*! Executes the task function, or the expiry function if the deadline has passed.
+    */
+    void operator() (void) const
+    {
+      invoke();
+    }
+
+    /*! Executes the task function, or the expiry function if the deadline has passed.
+    * \return false if the task has been dropped because the deadline has passed.
+    */
+    bool invoke() const
+    {
+      if(detail::monotonic_millis() > m_deadline)
+      {
+        if(m_expired)
+        {
+          m_expired();
+        }
+        return false;
+      }
+
+      if(m_function)
+      {
+        m_function();
+      }
+      return true;
+    }
+
+    /*! Gets the deadline.
+    * \return The deadline in milliseconds of detail::monotonic_millis().
+    */
+    uint64_t deadline() const
+    {
+      return m_deadline;
+    }
+
+    /*! Comparison operator which realises a partial ordering based on deadlines.
+    * \param rhs The object to compare with.
+    * \return true if the deadline of *this is later than right hand side's deadline, false otherwise.
+    */
+    bool operator< (const deadline_task_func& rhs) const
+    {
+      return m_deadline > rhs.m_deadline; 
+    }
+
+  };  // deadline_task_func
+
+
+
  
 
 
@@ -103,6 +190,8 @@ namespace boost { namespace threadpool
   * time intervals until false is returned. The interval length may be zero.
   * Please note that a pool's thread is engaged as long as the task is looped.
   *
+  * \see timer_queue and timer_thread for periodic tasks which do not engage a thread between their executions.
+  *
   */ 
   class looped_task_func
   {
@@ -0,0 +1,261 @@
+/*! \file
+* \brief Batched scheduling and waiting.
+*
+* This file contains a countdown for waiting on a batch of tasks and
+* the schedule_bulk adaptor which schedules a batch with one lock.
+*
+* Use, modification, and distribution are  subject to the
+* Boost Software License, Version 1.0. (See accompanying  file
+* LICENSE_1_0.txt or copy at http://www.boost.org/LICENSE_1_0.txt)
+*
+* http://threadpool.sourceforge.net
+*
+*/
+
+
+#ifndef THREADPOOL_TASK_BATCH_HPP_INCLUDED
+#define THREADPOOL_TASK_BATCH_HPP_INCLUDED
+
+
+#include "./detail/clock.hpp"
+
+#include <boost/atomic.hpp>
+#include <boost/iterator/transform_iterator.hpp>
+#include <boost/thread/condition.hpp>
+#include <boost/thread/mutex.hpp>
+#include <boost/date_time/posix_time/posix_time_types.hpp>
+#include <boost/thread/xtime.hpp>
+#include <boost/utility.hpp>
+
+#include <iterator>
+
+
+namespace boost { namespace threadpool
+{
+
+  /*! \brief Countdown of the outstanding tasks of a batch.
+  *
+  * A batch counts the tasks which have been scheduled with it and not
+  * finished yet. Waiting on a batch blocks until its own tasks have been
+  * executed, independently of other tasks in the pool. The waiting thread
+  * is woken up once, by the task finishing last, instead of on every
+  * idle worker like pool::wait.
+  *
+  * A batch can be reused after it has become ready.
+  *
+  * \remarks The tasks of a batch must not throw exceptions.
+  *
+  * \see schedule_bulk
+  */
+  class task_batch
+  : private noncopyable
+  {
+    atomic<size_t>      m_pending;  //!< The number of tasks which have not finished.
+    mutable mutex       m_monitor;
+    mutable condition   m_done_event;
+
+  public:
+    /*! Constructs an empty batch.
+    */
+    task_batch()
+    : m_pending(0)
+    {
+    }
+
+    /*! Destructor. Waits until the task finishing last has released the batch,
+    * so that a batch on the waiting thread's stack can go out of scope as soon
+    * as it is ready.
+    */
+    ~task_batch()
+    {
+      mutex::scoped_lock lock(m_monitor);
+    }
+
+    /*! Adds tasks to the batch. Must be called before the tasks are scheduled.
+    * \param count The number of tasks.
+    */
+    void add(size_t const count)
+    {
+      m_pending += count;
+    }
+
+    /*! Marks one task of the batch finished.
+    */
+    void done()
+    {
+      size_t pending = m_pending;
+      while(pending > 1)
+      {
+        if(m_pending.compare_exchange_weak(pending, pending - 1)) return;
+      }
+
+      // The last task counts down under the lock, see the destructor.
+      mutex::scoped_lock lock(m_monitor);
+      if(--m_pending == 0)
+      {
+        m_done_event.notify_all();
+      }
+    }
+
+    /*! Returns the number of tasks which have not finished yet.
+    * \return The number of pending tasks.
+    */
+    size_t pending() const
+    {
+      return m_pending;
+    }
+
+    /*! Indicates that all tasks of the batch have finished.
+    * \return true if no tasks are pending.
+    */
+    bool ready() const
+    {
+      return m_pending == 0;
+    }
+
+    /*! Blocks the current thread until all tasks of the batch have finished.
+    */
+    void wait() const
+    {
+      if(m_pending == 0) return;
+
+      mutex::scoped_lock lock(m_monitor);
+      while(m_pending != 0)
+      {
+        m_done_event.wait(lock);
+      }
+    }
+
+    /*! Blocks the current thread until all tasks of the batch have finished or the timestamp is met.
+    * \param timestamp The time when waiting times out.
+    * \return true if all tasks have finished.
+    */
+    bool wait(xtime const & timestamp) const
+    {
+      if(m_pending == 0) return true;
+
+      mutex::scoped_lock lock(m_monitor);
+      while(m_pending != 0)
+      {
+        if(!m_done_event.timed_wait(lock, timestamp)) return m_pending == 0;
+      }
+      return true;
+    }
+
+    /*! Blocks the current thread until all tasks of the batch have finished or the time has elapsed.
+    * \param msecs The maximum time to wait in milliseconds.
+    * \return true if all tasks have finished.
+    */
+    bool timed_wait(unsigned const msecs) const
+    {
+      if(m_pending == 0) return true;
+
+      uint64_t const deadline = detail::monotonic_millis() + msecs;
+      mutex::scoped_lock lock(m_monitor);
+      while(m_pending != 0)
+      {
+        uint64_t const now = detail::monotonic_millis();
+        if(now >= deadline) return false;
+        // a relative timeout is measured on the monotonic clock, unlike a system_time
+        m_done_event.timed_wait(lock, posix_time::milliseconds(deadline - now));
+      }
+      return true;
+    }
+  };
+
+
+  namespace detail
+  {
+    /*! \brief Function object which executes a task and counts it down in its batch. */
+    template <typename Function>
+    class batch_task_func
+    {
+      Function      m_function;
+      task_batch*   m_batch;
+
+    public:
+      typedef void result_type;
+
+      batch_task_func(Function const & function, task_batch& batch)
+      : m_function(function)
+      , m_batch(&batch)
+      {
+      }
+
+      void operator() (void)
+      {
+        m_function();
+        m_batch->done();
+      }
+    };
+
+    /*! \brief Wraps the function objects of a range into batch tasks. */
+    template <typename Function>
+    class batch_wrapper
+    {
+      task_batch* m_batch;
+
+    public:
+      typedef batch_task_func<Function> result_type;
+
+      explicit batch_wrapper(task_batch& batch)
+      : m_batch(&batch)
+      {
+      }
+
+      result_type operator() (Function const & function) const
+      {
+        return result_type(function, *m_batch);
+      }
+    };
+
+  } // namespace detail
+
+
+  /*! Schedules a range of tasks as one batch. The tasks are put to the pool's
+  * scheduler under one lock and at most as many idle workers as tasks are woken up.
+  * \param pool The pool.
+  * \param first Iterator to the first function object. Must be a forward iterator.
+  * \param last Iterator past the last function object.
+  * \param batch The batch which counts the scheduled tasks down as they finish.
+  * \return The number of tasks which could be scheduled.
+  */
+  template <typename Pool, typename ForwardIterator>
+  size_t schedule_bulk(Pool& pool, ForwardIterator first, ForwardIterator last, task_batch& batch)
+  {
+    typedef typename std::iterator_traits<ForwardIterator>::value_type function_type;
+    typedef detail::batch_wrapper<function_type> wrapper_type;
+
+    size_t const count = std::distance(first, last);
+    batch.add(count);
+
+    wrapper_type wrapper(batch);
+    size_t const scheduled = pool.schedule_bulk(
+      make_transform_iterator(first, wrapper), make_transform_iterator(last, wrapper));
+
+    // Tasks the scheduler has rejected will never count down.
+    for(size_t i = scheduled; i < count; i++)
+    {
+      batch.done();
+    }
+    return scheduled;
+  }
+
+
+  /*! Schedules a range of tasks for asynchronous execution. The tasks are put to
+  * the pool's scheduler under one lock and at most as many idle workers as tasks are woken up.
+  * \param pool The pool.
+  * \param first Iterator to the first task function object.
+  * \param last Iterator past the last task function object.
+  * \return The number of tasks which could be scheduled.
+  */
+  template <typename Pool, typename InputIterator>
+  size_t schedule_bulk(Pool& pool, InputIterator first, InputIterator last)
+  {
+    return pool.schedule_bulk(first, last);
+  }
+
+
+} } // namespace boost::threadpool
+
+#endif // THREADPOOL_TASK_BATCH_HPP_INCLUDED
@@ -0,0 +1,356 @@
+/*! \file
+* \brief Timers.
+*
+* This file contains a queue of one-shot and periodic timers and a timer
+* thread which fires them onto a pool. Unlike looped_task_func, waiting for
+* a timer does not occupy a worker of the pool.
+*
+* Use, modification, and distribution are  subject to the
+* Boost Software License, Version 1.0. (See accompanying  file
+* LICENSE_1_0.txt or copy at http://www.boost.org/LICENSE_1_0.txt)
+*
+* http://threadpool.sourceforge.net
+*
+*/
+
+
+#ifndef THREADPOOL_TIMER_QUEUE_HPP_INCLUDED
+#define THREADPOOL_TIMER_QUEUE_HPP_INCLUDED
+
+
+#include "./detail/clock.hpp"
+#include "./task_adaptors.hpp"
+
+#include <boost/bind.hpp>
+#include <boost/thread.hpp>
+#include <boost/thread/condition.hpp>
+#include <boost/thread/mutex.hpp>
+#include <boost/utility.hpp>
+
+#include <algorithm>
+#include <functional>
+#include <map>
+#include <vector>
+
+
+namespace boost { namespace threadpool
+{
+
+  /*! \brief Queue of one-shot and periodic timers.
+  *
+  * The timers are kept in a binary heap ordered by their deadlines. The queue
+  * does not fire timers by itself: the owner calls dispatch() when the time
+  * returned by next_timeout() has elapsed, e.g. from a reactor loop, or blocks
+  * in wait() until a timer is due. Both can be combined with schedule() of a
+  * pool to execute the callbacks there, see timer_thread.
+  *
+  * A periodic timer is rescheduled an interval after its previous deadline,
+  * so it does not drift; intervals which have been missed entirely are skipped.
+  *
+  * \remarks The timer_queue is thread-safe. Callbacks are invoked without the
+  * queue being locked, so they may schedule and cancel timers.
+  */
+  class timer_queue
+  : private noncopyable
+  {
+  public:
+    typedef uint64_t timer_id;  //!< Identifies a timer. 0 is never used.
+
+  private:
+    struct timer
+    {
+      task_func   m_function;
+      unsigned    m_interval;   //!< Period in milliseconds or 0 for a one-shot timer.
+      uint64_t    m_deadline;
+    };
+
+    struct entry
+    {
+      uint64_t  m_deadline;
+      timer_id  m_id;
+
+      bool operator< (entry const & rhs) const
+      {
+        return m_deadline > rhs.m_deadline || (m_deadline == rhs.m_deadline && m_id > rhs.m_id);
+      }
+    };
+
+    mutable mutex                 m_monitor;
+    mutable condition             m_changed_event;  //!< A timer with an earlier deadline was added or waiting was interrupted.
+    mutable std::vector<entry>    m_heap;           //!< Deadlines of the timers, earliest first. Entries of cancelled timers are skipped, or removed when they dominate.
+    std::map<timer_id, timer>     m_timers;         //!< The active timers.
+    timer_id                      m_next_id;
+    bool                          m_interrupted;
+
+    timer_id add(unsigned const delay, unsigned const interval, task_func const & function)
+    {
+      mutex::scoped_lock lock(m_monitor);
+      timer_id const id = m_next_id++;
+      timer& t = m_timers[id];
+      t.m_function = function;
+      t.m_interval = interval;
+      t.m_deadline = detail::monotonic_millis() + delay;
+      push(t.m_deadline, id);
+      return id;
+    }
+
+    void push(uint64_t const deadline, timer_id const id)
+    {
+      bool const earliest = m_heap.empty() || deadline < m_heap.front().m_deadline;
+      entry e = { deadline, id };
+      m_heap.push_back(e);
+      std::push_heap(m_heap.begin(), m_heap.end());
+      if(earliest)
+      {
+        m_changed_event.notify_all();
+      }
+    }
+
+    /*! Checks if an entry belongs to a timer which has been cancelled. Requires the lock. */
+    bool is_stale(entry const & e) const
+    {
+      std::map<timer_id, timer>::const_iterator it = m_timers.find(e.m_id);
+      return it == m_timers.end() || it->second.m_deadline != e.m_deadline;
+    }
+
+    /*! Removes the entries of cancelled timers from the top of the heap. Requires the lock. */
+    void skip_cancelled() const
+    {
+      while(!m_heap.empty() && is_stale(m_heap.front()))
+      {
+        std::pop_heap(m_heap.begin(), m_heap.end());
+        m_heap.pop_back();
+      }
+    }
+
+    /*! Removes the entries of cancelled timers from the whole heap once they outnumber 
+    * the active timers, so that timers cancelled before they are due do not pile up. 
+    * Requires the lock.
+    */
+    void compact()
+    {
+      if(m_heap.size() <= 2 * m_timers.size() + 16) return;
+      m_heap.erase(std::remove_if(m_heap.begin(), m_heap.end(), bind(&timer_queue::is_stale, this, _1)), m_heap.end());
+      std::make_heap(m_heap.begin(), m_heap.end());
+    }
+
+  public:
+    /*! Constructs an empty queue.
+    */
+    timer_queue()
+    : m_next_id(1)
+    , m_interrupted(false)
+    {
+    }
+
+    /*! Adds a one-shot timer.
+    * \param delay The time in milliseconds after which the timer fires.
+    * \param function The callback.
+    * \return The timer's id.
+    */
+    timer_id schedule_after(unsigned const delay, task_func const & function)
+    {
+      return add(delay, 0, function);
+    }
+
+    /*! Adds a periodic timer which fires until it is cancelled.
+    * \param interval The period in milliseconds. Must not be 0.
+    * \param function The callback.
+    * \return The timer's id.
+    */
+    timer_id schedule_every(unsigned const interval, task_func const & function)
+    {
+      return add(interval, interval, function);
+    }
+
+    /*! Cancels a timer. A callback which is being invoked is not interrupted.
+    * \param id The timer's id.
+    * \return true if the timer was active.
+    */
+    bool cancel(timer_id const id)
+    {
+      mutex::scoped_lock lock(m_monitor);
+      if(m_timers.erase(id) == 0) return false;
+      compact();
+      return true;
+    }
+
+    /*! Gets the number of active timers.
+    * \return The number of timers.
+    */
+    size_t size() const
+    {
+      mutex::scoped_lock lock(m_monitor);
+      return m_timers.size();
+    }
+
+    /*! Gets the time until the next timer is due.
+    * \param max_msecs The time returned if no timer is due earlier.
+    * \return The time in milliseconds, 0 if a timer is due.
+    */
+    unsigned next_timeout(unsigned const max_msecs) const
+    {
+      mutex::scoped_lock lock(m_monitor);
+      skip_cancelled();
+      if(m_heap.empty()) return max_msecs;
+
+      uint64_t const now = detail::monotonic_millis();
+      uint64_t const deadline = m_heap.front().m_deadline;
+      if(deadline <= now) return 0;
+      return static_cast<unsigned>((std::min<uint64_t>)(deadline - now, max_msecs));
+    }
+
+    /*! Hands the callbacks of the due timers to a dispatcher and reschedules the periodic ones.
+    * \param dispatcher Function object which is called with each due callback, e.g. to schedule it onto a pool.
+    * \return The number of fired timers.
+    */
+    template <typename Dispatcher>
+    size_t dispatch(Dispatcher dispatcher)
+    {
+      std::vector<task_func> due;
+      {
+        mutex::scoped_lock lock(m_monitor);
+        uint64_t const now = detail::monotonic_millis();
+        for(skip_cancelled(); !m_heap.empty() && m_heap.front().m_deadline <= now; skip_cancelled())
+        {
+          timer_id const id = m_heap.front().m_id;
+          std::pop_heap(m_heap.begin(), m_heap.end());
+          m_heap.pop_back();
+
+          std::map<timer_id, timer>::iterator it = m_timers.find(id);
+          timer& t = it->second;
+          due.push_back(t.m_function);
+          if(t.m_interval == 0)
+          {
+            m_timers.erase(it);
+          }
+          else
+          {
+            t.m_deadline += t.m_interval;
+            if(t.m_deadline <= now)
+            { // skip missed periods
+              t.m_deadline = now + t.m_interval;
+            }
+            push(t.m_deadline, id);
+          }
+        }
+      }
+
+      for(size_t i = 0; i < due.size(); i++)
+      {
+        dispatcher(due[i]);
+      }
+      return due.size();
+    }
+
+    /*! Invokes the callbacks of the due timers in the calling thread and reschedules the periodic ones.
+    * \return The number of fired timers.
+    */
+    size_t dispatch()
+    {
+      return dispatch(&invoke);
+    }
+
+    /*! Blocks the current thread until a timer is due, the timeout elapses or interrupt() is called.
+    * \param max_msecs The maximum time to wait in milliseconds.
+    * \return false if waiting has been interrupted.
+    */
+    bool wait(unsigned const max_msecs)
+    {
+      mutex::scoped_lock lock(m_monitor);
+      if(!m_interrupted)
+      {
+        skip_cancelled();
+        uint64_t const now = detail::monotonic_millis();
+        uint64_t const deadline = m_heap.empty() ? now + max_msecs
+          : (std::min<uint64_t>)(m_heap.front().m_deadline, now + max_msecs);
+        if(deadline > now)
+        {
+          // a relative timeout is measured on the monotonic clock, unlike a system_time
+          m_changed_event.timed_wait(lock, posix_time::milliseconds(deadline - now));
+        }
+      }
+      return !m_interrupted;
+    }
+
+    /*! Makes wait() return false now and from now on.
+    */
+    void interrupt()
+    {
+      mutex::scoped_lock lock(m_monitor);
+      m_interrupted = true;
+      m_changed_event.notify_all();
+    }
+
+  private:
+    static void invoke(task_func const & function)
+    {
+      if(function)
+      {
+        function();
+      }
+    }
+  };
+
+
+  /*! \brief Thread which fires the timers of a timer_queue onto a pool.
+  *
+  * One thread serves all timers of the queue and is blocked while no timer
+  * is due, so periodic jobs do not occupy workers of the pool between
+  * their executions. A periodic callback may run concurrently with its
+  * previous execution if that takes longer than the interval.
+  *
+  * \param Pool The pool's type.
+  */
+  template <typename Pool>
+  class timer_thread
+  : private noncopyable
+  {
+    Pool&           m_pool;
+    timer_queue     m_timers;
+    boost::thread   m_thread;
+
+    void schedule(task_func const & function)
+    {
+      m_pool.schedule(function);
+    }
+
+    void run()
+    {
+      while(m_timers.wait(1000))
+      {
+        m_timers.dispatch(bind(&timer_thread::schedule, this, _1));
+      }
+    }
+
+  public:
+    /*! Constructor. Starts the timer thread.
+    * \param pool The pool which executes the callbacks. It must exist longer than the timer thread.
+    */
+    timer_thread(Pool& pool)
+    : m_pool(pool)
+    , m_thread(bind(&timer_thread::run, this))
+    {
+    }
+
+    /*! Destructor. Stops the timer thread; pending timers do not fire any more.
+    */
+    ~timer_thread()
+    {
+      m_timers.interrupt();
+      m_thread.join();
+    }
+
+    /*! Gets the timers which are fired onto the pool.
+    * \return The timer queue.
+    */
+    timer_queue& timers()
+    {
+      return m_timers;
+    }
+  };
+
+
+} } // namespace boost::threadpool
+
+#endif // THREADPOOL_TIMER_QUEUE_HPP_INCLUDED
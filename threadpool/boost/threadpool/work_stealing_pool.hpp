@@ -0,0 +1,525 @@
+/*! \file
+* \brief Work-stealing thread pool.
+*
+* This file contains a pool variant in which every worker owns a task
+* queue. Tasks scheduled by a worker are pushed to its own queue, and
+* workers which run out of tasks steal from the others. This avoids the
+* single monitor and condition which all tasks of pool_core pass through.
+*
+* Use, modification, and distribution are  subject to the
+* Boost Software License, Version 1.0. (See accompanying  file
+* LICENSE_1_0.txt or copy at http://www.boost.org/LICENSE_1_0.txt)
+*
+* http://threadpool.sourceforge.net
+*
+*/
+
+
+#ifndef THREADPOOL_WORK_STEALING_POOL_HPP_INCLUDED
+#define THREADPOOL_WORK_STEALING_POOL_HPP_INCLUDED
+
+
+#include "task_adaptors.hpp"
+
+#include <boost/atomic.hpp>
+#include <boost/bind.hpp>
+#include <boost/smart_ptr.hpp>
+#include <boost/thread.hpp>
+#include <boost/thread/mutex.hpp>
+#include <boost/thread/condition.hpp>
+#include <boost/thread/tss.hpp>
+#include <boost/utility.hpp>
+
+#include <deque>
+#include <vector>
+
+
+namespace boost { namespace threadpool
+{
+  namespace detail
+  {
+
+  /*! \brief Core of the work-stealing pool.
+  *
+  * Each worker owns a deque which is guarded by its own mutex. The owner
+  * pushes and pops tasks at the back (LIFO, for cache locality), thieves
+  * take tasks from the front (FIFO, the oldest and typically largest
+  * pieces of work). Tasks scheduled from outside of the pool are put to a
+  * shared injection queue. Idle workers park on a condition only when no
+  * task is pending anywhere in the pool.
+  *
+  * \param Task A function object which implements the operator 'void operator() (void) const'.
+  */
+  template <typename Task>
+  class ws_pool_core
+  : private noncopyable
+  {
+  public: // Type definitions
+    typedef Task task_type;                 //!< Indicates the task's type.
+    typedef ws_pool_core<Task> pool_type;   //!< Indicates the pool core's type.
+
+  private:
+    /*! A task queue guarded by a mutex. */
+    struct task_queue
+    {
+      mutex                   m_mutex;
+      std::deque<task_type>   m_tasks;
+    };
+
+    /*! Identifies the worker which runs on the current thread. */
+    struct worker_context
+    {
+      pool_type const * m_pool;
+      size_t            m_index;
+    };
+
+    std::vector<shared_ptr<task_queue> >      m_queues;     //!< Task queues of the workers.
+    task_queue                                m_injected;   //!< Tasks scheduled from outside the pool.
+    std::vector<shared_ptr<boost::thread> >   m_threads;    //!< Worker threads.
+    thread_specific_ptr<worker_context>       m_context;    //!< The current thread's worker.
+
+    atomic<size_t>  m_pending;    //!< Number of queued tasks.
+    atomic<size_t>  m_unfinished; //!< Number of queued or executing tasks, which wait() waits for.
+    atomic<size_t>  m_active;     //!< Number of workers looking for or executing a task.
+    atomic<size_t>  m_sleepers;   //!< Number of parked workers.
+    atomic<size_t>  m_waiters;    //!< Number of threads blocked in wait().
+    atomic<bool>    m_terminate;  //!< Indicates that the workers should exit.
+
+    mutable mutex     m_idle_mutex;
+    mutable condition m_task_or_terminate_event;  //!< A task is available OR the workers should exit.
+    mutable mutex     m_wait_mutex;
+    mutable condition m_task_finished_event;      //!< A task has been finished.
+
+  public:
+    /*! Constructor. Starts the worker threads.
+    * \param worker_count The number of worker threads.
+    */
+    ws_pool_core(size_t worker_count)
+    : m_pending(0)
+    , m_unfinished(0)
+    , m_active(0)
+    , m_sleepers(0)
+    , m_waiters(0)
+    , m_terminate(false)
+    {
+      if(worker_count == 0) worker_count = 1;
+      for(size_t i = 0; i < worker_count; i++)
+      {
+        m_queues.push_back(shared_ptr<task_queue>(new task_queue));
+      }
+      for(size_t i = 0; i < worker_count; i++)
+      {
+        m_threads.push_back(shared_ptr<boost::thread>(
+          new boost::thread(bind(&ws_pool_core::run, this, i))));
+      }
+    }
+
+    /*! Gets the number of threads in the pool.
+    * \return The number of threads.
+    */
+    size_t size() const
+    {
+      return m_threads.size();
+    }
+
+    /*! Schedules a task for asynchronous execution. The task will be executed once only.
+    * When called from a worker of this pool the task is put to the worker's own queue.
+    * \param task The task function object. It should not throw execeptions.
+    * \return true, if the task could be scheduled and false otherwise.
+    */
+    bool schedule(task_type const & task)
+    {
+      if(m_terminate) return false;
+
+      // Count the task before it can be taken, so that m_pending never
+      // underflows. m_pending and m_sleepers are sequentially consistent:
+      // either a parking worker sees the task or this thread sees the worker.
+      // A task scheduled by a running task is unfinished before its parent
+      // finishes, so wait() cannot see both at zero.
+      ++m_unfinished;
+      ++m_pending;
+
+      worker_context* context = m_context.get();
+      task_queue& queue = (context && context->m_pool == this) ? *m_queues[context->m_index] : m_injected;
+      {
+        mutex::scoped_lock lock(queue.m_mutex);
+        queue.m_tasks.push_back(task);
+      }
+
+      if(m_sleepers > 0)
+      {
+        mutex::scoped_lock lock(m_idle_mutex);
+        m_task_or_terminate_event.notify_one();
+      }
+      return true;
+    }
+
+    /*! Schedules a range of tasks for asynchronous execution under one lock.
+    * \param first Iterator to the first task function object.
+    * \param last Iterator past the last task function object.
+    * \return The number of tasks which could be scheduled.
+    */
+    template <typename InputIterator>
+    size_t schedule_bulk(InputIterator first, InputIterator const last)
+    {
+      if(m_terminate) return 0;
+
+      worker_context* context = m_context.get();
+      task_queue& queue = (context && context->m_pool == this) ? *m_queues[context->m_index] : m_injected;
+      size_t scheduled = 0;
+      {
+        mutex::scoped_lock lock(queue.m_mutex);
+        for(; first != last; ++first)
+        {
+          queue.m_tasks.push_back(*first);
+          scheduled++;
+        }
+        // Counted under the queue's lock, before any of the tasks can be taken.
+        m_unfinished += scheduled;
+        m_pending += scheduled;
+      }
+
+      size_t const sleepers = m_sleepers;
+      if(sleepers > 0)
+      {
+        mutex::scoped_lock lock(m_idle_mutex);
+        for(size_t i = 0; i < scheduled && i < sleepers; i++)
+        {
+          m_task_or_terminate_event.notify_one();
+        }
+      }
+      return scheduled;
+    }
+
+    /*! Executes a pending task in the calling thread, if there is one. A worker of
+    * this pool takes its own newest task first, other threads the oldest task of
+    * the injection queue or of a worker.
+    * \return true if a task has been executed.
+    */
+    bool try_execute_one()
+    {
+      worker_context* context = m_context.get();
+      bool const own = context && context->m_pool == this;
+
+      task_type task;
+      ++m_active;
+      if(own ? pop_local(context->m_index, task) || steal(context->m_index, task)
+             : steal(m_queues.size(), task))
+      {
+        --m_pending;
+        try
+        {
+          if(task)
+          {
+            task();
+          }
+        }
+        catch(...)
+        {
+          finished(true);
+          throw;
+        }
+        finished(true);
+        return true;
+      }
+      finished(false);
+      return false;
+    }
+
+    /*! Returns the number of tasks which are currently executed.
+    * \return The number of active tasks.
+    */
+    size_t active() const
+    {
+      return m_active;
+    }
+
+    /*! Returns the number of tasks which are ready for execution.
+    * \return The number of pending tasks.
+    */
+    size_t pending() const
+    {
+      return m_pending;
+    }
+
+    /*! Indicates that there are no tasks pending.
+    * \return true if there are no tasks ready for execution.
+    */
+    bool empty() const
+    {
+      return m_pending == 0;
+    }
+
+    /*! Removes all pending tasks from the pool's queues.
+    */
+    void clear()
+    {
+      clear_queue(m_injected);
+      for(size_t i = 0; i < m_queues.size(); i++)
+      {
+        clear_queue(*m_queues[i]);
+      }
+    }
+
+    /*! The current thread of execution is blocked until the sum of all executing
+    *  and pending tasks is equal or less than a given threshold.
+    * \param task_threshold The maximum number of tasks in pool and queues.
+    */
+    void wait(size_t const task_threshold = 0) const
+    {
+      pool_type* self = const_cast<pool_type*>(this);
+      mutex::scoped_lock lock(m_wait_mutex);
+      ++self->m_waiters;
+      while(m_unfinished > task_threshold)
+      {
+        m_task_finished_event.wait(lock);
+      }
+      --self->m_waiters;
+    }
+
+    /*! Waits for all tasks and terminates the workers.
+    */
+    void shutdown()
+    {
+      wait();
+      {
+        mutex::scoped_lock lock(m_idle_mutex);
+        m_terminate = true;
+        m_task_or_terminate_event.notify_all();
+      }
+      for(size_t i = 0; i < m_threads.size(); i++)
+      {
+        m_threads[i]->join();
+      }
+    }
+
+  private:
+    void clear_queue(task_queue& queue)
+    {
+      mutex::scoped_lock lock(queue.m_mutex);
+      m_pending -= queue.m_tasks.size();
+      m_unfinished -= queue.m_tasks.size();
+      queue.m_tasks.clear();
+    }
+
+    /*! Takes the newest task of the worker's own queue. */
+    bool pop_local(size_t const index, task_type& task)
+    {
+      task_queue& queue = *m_queues[index];
+      mutex::scoped_lock lock(queue.m_mutex);
+      if(queue.m_tasks.empty()) return false;
+      task = queue.m_tasks.back();
+      queue.m_tasks.pop_back();
+      return true;
+    }
+
+    /*! Takes the oldest task of a queue. */
+    bool pop_front(task_queue& queue, task_type& task)
+    {
+      mutex::scoped_lock lock(queue.m_mutex, try_to_lock);
+      if(!lock.owns_lock() || queue.m_tasks.empty()) return false;
+      task = queue.m_tasks.front();
+      queue.m_tasks.pop_front();
+      return true;
+    }
+
+    /*! Takes a task from the injection queue or steals one from another worker.
+    * An index past the workers' queues steals from all of them. */
+    bool steal(size_t const index, task_type& task)
+    {
+      if(pop_front(m_injected, task)) return true;
+      size_t const count = m_queues.size();
+      size_t const others = index < count ? count - 1 : count;
+      for(size_t i = 1; i <= others; i++)
+      {
+        if(pop_front(*m_queues[(index + i) % count], task)) return true;
+      }
+      return false;
+    }
+
+    /*! Executes tasks until the pool is shut down. */
+    void run(size_t const index)
+    {
+      worker_context* context = new worker_context;
+      context->m_pool = this;
+      context->m_index = index;
+      m_context.reset(context);
+
+      task_type task;
+      while(true)
+      {
+        ++m_active;
+        if(pop_local(index, task) || steal(index, task))
+        {
+          --m_pending;
+          if(task)
+          {
+            task();
+          }
+          task = task_type();
+          finished(true);
+          continue;
+        }
+        finished(false);
+
+        // park until there is a task anywhere in the pool
+        mutex::scoped_lock lock(m_idle_mutex);
+        ++m_sleepers;
+        while(m_pending == 0 && !m_terminate)
+        {
+          m_task_or_terminate_event.wait(lock);
+        }
+        --m_sleepers;
+        if(m_terminate && m_pending == 0)
+        {
+          return;
+        }
+      }
+    }
+
+    /*! Decrements the number of active workers, and of unfinished tasks if the
+    * worker has executed one, and wakes up waiting threads. */
+    void finished(bool const executed)
+    {
+      if(executed) --m_unfinished;
+      --m_active;
+      if(m_waiters > 0)
+      {
+        mutex::scoped_lock lock(m_wait_mutex);
+        m_task_finished_event.notify_all();
+      }
+    }
+  };
+
+  } // namespace detail
+
+
+
+  /*! \brief Work-stealing thread pool.
+  *
+  * A pool variant with one task queue per worker. Tasks scheduled by a
+  * task running in the pool are pushed to the queue of the worker executing it,
+  * and idle workers steal tasks from the other queues. This pool suits tasks
+  * which schedule further tasks (fork-join) and high core counts, where the
+  * single monitor of thread_pool becomes the bottleneck. The tasks are executed
+  * in no particular order.
+  *
+  * The pool has reference semantics like thread_pool. When the last copy is
+  * destructed, all pending tasks are executed and the workers are terminated.
+  * The number of workers is fixed at construction.
+  *
+  * \param Task A function object which implements the operator 'void operator() (void) const'.
+  *
+  * \see thread_pool
+  */
+  template <typename Task = task_func>
+  class work_stealing_thread_pool
+  {
+    typedef detail::ws_pool_core<Task> pool_core_type;
+    shared_ptr<pool_core_type>  m_core; // pimpl idiom
+    shared_ptr<void>            m_shutdown_controller; // If the last pool holding a pointer to the core is deleted the controller shuts the pool down.
+
+  public: // Type definitions
+    typedef Task task_type;   //!< Indicates the task's type.
+
+  public:
+    /*! Constructor.
+    * \param threads The number of worker threads.
+    */
+    work_stealing_thread_pool(size_t threads = thread::hardware_concurrency())
+    : m_core(new pool_core_type(threads))
+    , m_shutdown_controller(static_cast<void*>(0), bind(&pool_core_type::shutdown, m_core))
+    {
+    }
+
+    /*! Gets the number of threads in the pool.
+    * \return The number of threads.
+    */
+    size_t size() const
+    {
+      return m_core->size();
+    }
+
+    /*! Schedules a task for asynchronous execution. The task will be executed once only.
+    * \param task The task function object. It should not throw execeptions.
+    * \return true, if the task could be scheduled and false otherwise.
+    */
+    bool schedule(task_type const & task)
+    {
+      return m_core->schedule(task);
+    }
+
+    /*! Schedules a range of tasks for asynchronous execution. The tasks are put to
+    * one queue under one lock and at most as many parked workers are woken up as there
+    * are tasks. Each task will be executed once only.
+    * \param first Iterator to the first task function object.
+    * \param last Iterator past the last task function object.
+    * \return The number of tasks which could be scheduled.
+    */
+    template <typename InputIterator>
+    size_t schedule_bulk(InputIterator first, InputIterator last)
+    {
+      return m_core->schedule_bulk(first, last);
+    }
+
+    /*! Executes a pending task in the calling thread, if there is one.
+    * \return true if a task has been executed.
+    */
+    bool try_execute_one()
+    {
+      return m_core->try_execute_one();
+    }
+
+    /*! Returns the number of tasks which are currently executed.
+    * \return The number of active tasks.
+    */
+    size_t active() const
+    {
+      return m_core->active();
+    }
+
+    /*! Returns the number of tasks which are ready for execution.
+    * \return The number of pending tasks.
+    */
+    size_t pending() const
+    {
+      return m_core->pending();
+    }
+
+    /*! Removes all pending tasks from the pool.
+    */
+    void clear()
+    {
+      m_core->clear();
+    }
+
+    /*! Indicates that there are no tasks pending.
+    * \return true if there are no tasks ready for execution.
+    */
+    bool empty() const
+    {
+      return m_core->empty();
+    }
+
+    /*! The current thread of execution is blocked until the sum of all executing
+    *  and pending tasks is equal or less than a given threshold.
+    * \param task_threshold The maximum number of tasks in pool and queues.
+    */
+    void wait(size_t task_threshold = 0) const
+    {
+      m_core->wait(task_threshold);
+    }
+  };
+
+
+  /*! \brief Work-stealing pool.
+  *
+  * The pool's tasks are task_func functors executed by workers with own task queues.
+  *
+  */
+  typedef work_stealing_thread_pool<task_func> work_stealing_pool;
+
+
+} } // namespace boost::threadpool
+
+#endif // THREADPOOL_WORK_STEALING_POOL_HPP_INCLUDED
@@ -0,0 +1,172 @@
+/*! \file
+ * \brief Fork-join benchmark.
+ *
+ * This benchmark sorts an array with std::sort, with a level by level
+ * mergesort which schedules one task per partition and waits for each level
+ * (the former mergesort example), and with parallel_sort. It also compares
+ * parallel_for with a sequential loop. The parallel versions run on fifo_pool
+ * and on work_stealing_pool.
+ *
+ * Usage: fork_join [threads] [elements]
+ *
+ * Distributed under the Boost Software License, Version 1.0. (See
+ * accompanying file LICENSE_1_0.txt or copy at
+ * http://www.boost.org/LICENSE_1_0.txt)
+ *
+ * http://threadpool.sourceforge.net
+ *
+ */
+
+#include <boost/threadpool.hpp>
+#include <boost/bind.hpp>
+#include <boost/thread.hpp>
+#include <boost/date_time/posix_time/posix_time.hpp>
+
+#include <algorithm>
+#include <cmath>
+#include <cstdio>
+#include <cstdlib>
+#include <string>
+#include <vector>
+
+using namespace boost::threadpool;
+
+
+//
+// Helpers
+std::vector<unsigned> make_data(size_t elements)
+{
+  std::vector<unsigned> data(elements);
+  unsigned x = 12345;
+  for(size_t i = 0; i < elements; i++)
+  {
+    x = x * 1103515245 + 12345;
+    data[i] = x;
+  }
+  return data;
+}
+
+void report(std::string const & name, std::string const & workload, boost::posix_time::ptime const & start, bool ok)
+{
+  boost::posix_time::time_duration elapsed = boost::posix_time::microsec_clock::universal_time() - start;
+  printf("%-20s %-16s %9.3f ms %s\n",
+         name.c_str(), workload.c_str(), elapsed.total_microseconds() / 1e3, ok ? "" : "FAILED");
+}
+
+bool is_sorted(std::vector<unsigned> const & data)
+{
+  for(size_t i = 1; i < data.size(); i++)
+  {
+    if(data[i] < data[i - 1]) return false;
+  }
+  return true;
+}
+
+
+//
+// Sorting
+void sort_range(unsigned* first, unsigned* last)
+{
+  std::sort(first, last);
+}
+
+void merge_range(unsigned* first, unsigned* mid, unsigned* last)
+{
+  std::inplace_merge(first, mid, last);
+}
+
+/*! Sorts partitions, then merges them pairwise, one level after the other. */
+template<class Pool>
+void level_sort(Pool& pool, std::vector<unsigned>& data, size_t partition_size)
+{
+  unsigned* const begin = &data[0];
+  unsigned* const end = begin + data.size();
+
+  std::vector<task_func> jobs;
+  for(unsigned* p = begin; p < end; p += partition_size)
+  {
+    jobs.push_back(boost::bind(&sort_range, p, (std::min)(p + partition_size, end)));
+  }
+  task_batch batch;
+  schedule_bulk(pool, jobs.begin(), jobs.end(), batch);
+  batch.wait();
+
+  for(size_t size = 2 * partition_size; size < 2 * data.size(); size *= 2)
+  {
+    jobs.clear();
+    for(unsigned* p = begin; p + size / 2 < end; p += size)
+    {
+      jobs.push_back(boost::bind(&merge_range, p, p + size / 2, (std::min)(p + size, end)));
+    }
+    schedule_bulk(pool, jobs.begin(), jobs.end(), batch);
+    batch.wait();   // the next level waits for the slowest merge of this one
+  }
+}
+
+template<class Pool>
+void sorting(Pool& pool, std::string const & name, std::vector<unsigned> const & input)
+{
+  size_t const partition_size = (std::max)(input.size() / (8 * pool.size()), static_cast<size_t>(2048));
+
+  std::vector<unsigned> data(input);
+  boost::posix_time::ptime start = boost::posix_time::microsec_clock::universal_time();
+  level_sort(pool, data, partition_size);
+  report(name, "level sort", start, is_sorted(data));
+
+  data = input;
+  start = boost::posix_time::microsec_clock::universal_time();
+  parallel_sort(pool, data.begin(), data.end());
+  report(name, "parallel_sort", start, is_sorted(data));
+}
+
+
+//
+// Loops
+void compute(std::vector<double>* data, size_t i)
+{
+  (*data)[i] = std::sqrt(static_cast<double>(i)) * std::sin(static_cast<double>(i));
+}
+
+template<class Pool>
+void loop(Pool& pool, std::string const & name, size_t elements)
+{
+  std::vector<double> data(elements);
+  boost::posix_time::ptime start = boost::posix_time::microsec_clock::universal_time();
+  parallel_for(pool, static_cast<size_t>(0), elements, boost::bind(&compute, &data, _1));
+  report(name, "parallel_for", start, true);
+}
+
+
+int main (int argc, char * const argv[])
+{
+  size_t threads = argc > 1 ? atoi(argv[1]) : boost::thread::hardware_concurrency();
+  size_t elements = argc > 2 ? atol(argv[2]) : 4000000;
+
+  printf("%lu threads, %lu elements\n", (unsigned long) threads, (unsigned long) elements);
+  std::vector<unsigned> const input = make_data(elements);
+  {
+    std::vector<unsigned> data(input);
+    boost::posix_time::ptime start = boost::posix_time::microsec_clock::universal_time();
+    std::sort(data.begin(), data.end());
+    report("sequential", "std::sort", start, is_sorted(data));
+
+    std::vector<double> values(elements);
+    start = boost::posix_time::microsec_clock::universal_time();
+    for(size_t i = 0; i < elements; i++)
+    {
+      compute(&values, i);
+    }
+    report("sequential", "loop", start, true);
+  }
+  {
+    fifo_pool pool(threads);
+    sorting(pool, "fifo_pool", input);
+    loop(pool, "fifo_pool", elements);
+  }
+  {
+    work_stealing_pool pool(threads);
+    sorting(pool, "work_stealing_pool", input);
+    loop(pool, "work_stealing_pool", elements);
+  }
+  return 0;
+}
@@ -0,0 +1,111 @@
+/*! \file
+ * \brief Scheduling benchmark.
+ *
+ * This benchmark compares the throughput of fifo_pool, which funnels all
+ * tasks through one monitor and one fifo_scheduler, with work_stealing_pool.
+ * Tasks are either scheduled from the main thread (flat) or by tasks
+ * running in the pool (nested fan-out).
+ *
+ * Usage: scheduling [threads] [tasks]
+ *
+ * Distributed under the Boost Software License, Version 1.0. (See
+ * accompanying file LICENSE_1_0.txt or copy at
+ * http://www.boost.org/LICENSE_1_0.txt)
+ *
+ * http://threadpool.sourceforge.net
+ *
+ */
+
+#include <boost/threadpool.hpp>
+#include <boost/atomic.hpp>
+#include <boost/bind.hpp>
+#include <boost/thread.hpp>
+#include <boost/date_time/posix_time/posix_time.hpp>
+
+#include <cstdio>
+#include <cstdlib>
+#include <string>
+
+using namespace boost::threadpool;
+
+
+//
+// Helpers
+boost::atomic<unsigned long> executed(0);
+
+void work()
+{
+  // a few hundred nanoseconds of computation
+  volatile unsigned long x = 0;
+  for(int i = 0; i < 100; i++)
+  {
+    x += i;
+  }
+  executed.fetch_add(1, boost::memory_order_relaxed);
+}
+
+template<class Pool>
+void spawn(Pool* pool, unsigned int depth)
+{
+  if(depth == 0)
+  {
+    work();
+    return;
+  }
+  pool->schedule(boost::bind(&spawn<Pool>, pool, depth - 1));
+  pool->schedule(boost::bind(&spawn<Pool>, pool, depth - 1));
+}
+
+void report(std::string const & name, std::string const & workload, unsigned long tasks, boost::posix_time::time_duration const & elapsed)
+{
+  double secs = elapsed.total_microseconds() / 1e6;
+  printf("%-20s %-8s %10lu tasks %9.3f s %12.0f tasks/s\n",
+         name.c_str(), workload.c_str(), tasks, secs, tasks / secs);
+}
+
+template<class Pool>
+void flat(Pool& pool, std::string const & name, unsigned long tasks)
+{
+  executed = 0;
+  boost::posix_time::ptime start = boost::posix_time::microsec_clock::universal_time();
+  for(unsigned long i = 0; i < tasks; i++)
+  {
+    pool.schedule(&work);
+  }
+  pool.wait();
+  report(name, "flat", executed, boost::posix_time::microsec_clock::universal_time() - start);
+}
+
+template<class Pool>
+void nested(Pool& pool, std::string const & name, unsigned long tasks)
+{
+  unsigned int depth = 0;
+  while((2ul << depth) <= tasks) depth++;
+
+  executed = 0;
+  boost::posix_time::ptime start = boost::posix_time::microsec_clock::universal_time();
+  pool.schedule(boost::bind(&spawn<Pool>, &pool, depth));
+  pool.wait();
+  // leaves plus the tasks which spawned them
+  report(name, "nested", 2 * executed - 1, boost::posix_time::microsec_clock::universal_time() - start);
+}
+
+
+int main (int argc, char * const argv[])
+{
+  size_t threads = argc > 1 ? atoi(argv[1]) : boost::thread::hardware_concurrency();
+  unsigned long tasks = argc > 2 ? atol(argv[2]) : 1000000;
+
+  printf("%lu threads\n", (unsigned long) threads);
+  {
+    fifo_pool pool(threads);
+    flat(pool, "fifo_pool", tasks);
+    nested(pool, "fifo_pool", tasks);
+  }
+  {
+    work_stealing_pool pool(threads);
+    flat(pool, "work_stealing_pool", tasks);
+    nested(pool, "work_stealing_pool", tasks);
+  }
+  return 0;
+}
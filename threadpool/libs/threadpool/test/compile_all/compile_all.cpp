@@ -18,6 +18,7 @@
 
 #include <iostream>
 #include <sstream>
+#include <vector>
 #include <boost/thread/mutex.hpp>
 #include <boost/bind.hpp>
 
@@ -131,11 +132,125 @@ void prio_pool_test()
 }
 
 
+void edf_pool_test()
+{
+    edf_pool tp(2);
+    tp.enable_stats();
+    schedule(tp, deadline_task_func(1000, &task_1));
+    schedule(tp, deadline_task_func(10, &task_2, &task_3));
+    tp.wait();
+    uint64_t expired = tp.stats().expired;
+    (void) expired;
+}
+
+
+void inplace_pool_test()
+{
+    inplace_pool tp(2);
+    tp.schedule(&task_1);
+    schedule(tp, boost::bind(task_with_parameter, 5));
+    inplace_task task(&task_2);
+    tp.schedule(boost::move(task));
+    tp.wait();
+}
+
+
+void bulk_test()
+{
+    fifo_pool tp(2);
+    std::vector<task_func> tasks(10, &task_1);
+    tp.schedule_bulk(tasks.begin(), tasks.end());
+
+    task_batch batch;
+    schedule_bulk(tp, tasks.begin(), tasks.end(), batch);
+    batch.wait();
+
+    work_stealing_pool ws(2);
+    schedule_bulk(ws, tasks.begin(), tasks.end(), batch);
+    batch.wait();
+}
+
+
+void timer_test()
+{
+    fifo_pool tp(2);
+    timer_thread<fifo_pool> timer(tp);
+    timer.timers().schedule_after(10, &task_1);
+    timer_queue::timer_id id = timer.timers().schedule_every(5, &task_2);
+    boost::this_thread::sleep(boost::posix_time::milliseconds(20));
+    timer.timers().cancel(id);
+
+    timer_queue timers;
+    timers.schedule_after(0, &task_3);
+    timers.dispatch();
+}
+
+
+void affinity_test()
+{
+    fifo_pool tp(2, cpu_affinity(std::vector<int>(1, 0)));
+    tp.set_worker_init(cpu_affinity(std::vector<int>(1, 0), true));
+    tp.size_controller().resize(3);
+    tp.set_idle_spin(0);
+    tp.schedule(&task_1);
+    tp.wait();
+    bind_current_thread(std::vector<int>());
+    current_cpu();
+}
+
+
+void stats_test()
+{
+    fifo_pool tp(2);
+    tp.enable_stats();
+    tp.schedule(&task_1);
+    tp.try_execute_one();
+    tp.wait();
+    pool_stats stats = tp.stats();
+    stats.queue_wait.percentile(0.99);
+    stats.execution.mean();
+    stats.throughput();
+    stats.utilization();
+    tp.enable_stats(false);
+}
+
+
+void square(std::vector<int>* v, int i)
+{
+  (*v)[i] *= (*v)[i];
+}
+
+void fork_join_test()
+{
+    fifo_pool tp(2);
+    std::vector<int> v(100, 3);
+    parallel_for(tp, 0, 100, boost::bind(&square, &v, _1));
+    parallel_invoke(tp, &task_1, &task_2, &task_3);
+    parallel_sort(tp, v.begin(), v.end());
+    tp.try_execute_one();
+
+    work_stealing_pool ws(2);
+    parallel_for(ws, 0, 100, boost::bind(&square, &v, _1), 10);
+    parallel_sort(ws, v.begin(), v.end(), std::greater<int>(), 16);
+}
+
+
+int continuation(future<int> f)
+{
+  return f.get() + 1;
+}
+
 void future_test()
 {
     fifo_pool tp(5);
     future<int> fut = schedule(tp, &task_4);
     int res = fut();
+
+    std::vector<future<int> > futs;
+    futs.push_back(fut.then(tp, &continuation));
+    futs.push_back(schedule(tp, &task_4));
+    when_all(futs.begin(), futs.end()).wait();
+    when_any(futs.begin(), futs.end()).wait();
 }
 
 
@@ -144,6 +259,13 @@ int main (int , char * const [])
   fifo_pool_test();
   lifo_pool_test();
   prio_pool_test();
+  edf_pool_test();
+  inplace_pool_test();
+  bulk_test();
   future_test();
+  timer_test();
+  affinity_test();
+  fork_join_test();
+  stats_test();
   return 0;
 }